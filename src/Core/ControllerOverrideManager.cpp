@@ -1,6 +1,7 @@
 #include "ControllerOverrideManager.h"
 
 #include "dllmain.h"
+#include "InputLatencyMonitor.h"
 #include "logger.h"
 #include "Settings.h"
 #include "Core/utils.h"
@@ -36,7 +37,8 @@
 #include <algorithm>
 #include <cctype>
 #include <cwctype>
-#include <numeric>
+#include <emmintrin.h>
+#include <intrin.h>
 #include <hidsdi.h>
 #include <sstream>
 #include <cstring>
@@ -199,25 +201,6 @@ namespace
             return unique;
     }
 
-    enum class InputAction
-    {
-            Up,
-            Down,
-            Left,
-            Right,
-            A,
-            B,
-            C,
-            D,
-            Taunt,
-            Special,
-            Fn1,
-            Fn2,
-            Start,
-            Select,
-            ResetPositions,
-    };
-
     const std::vector<MenuAction> kMenuActions =
     {
             MenuAction::Up,
@@ -373,115 +356,23 @@ namespace
             return false;
     }
 
-    void MergeInputState(const InputState& src, InputState& dst)
-    {
-            dst.up |= src.up;
-            dst.down |= src.down;
-            dst.left |= src.left;
-            dst.right |= src.right;
-
-            dst.A |= src.A;
-            dst.B |= src.B;
-            dst.C |= src.C;
-            dst.D |= src.D;
-            dst.taunt |= src.taunt;
-            dst.special |= src.special;
-            dst.fn1 |= src.fn1;
-            dst.fn2 |= src.fn2;
-            dst.start |= src.start;
-            dst.select |= src.select;
-            dst.resetPositions |= src.resetPositions;
-    }
-
-    bool IsVirtualKeyPressed(const std::array<BYTE, 256>& keyState, uint32_t vk)
+    // Turns a 256-bit key bitmap back into what GetKeyboardState fills, 0x80 for the pressed keys.
+    // Every 16 keys are one SSE2 register: the two bitmap bytes spread over 8 lanes each, then
+    // compared against the bit each lane stands for.
+    void ExpandKeyBits(const uint32_t (&keyBits)[8], BYTE* keyStateOut)
     {
-            if (vk >= keyState.size())
-                    return false;
-
-            return (keyState[vk] & 0x80) != 0;
-    }
+            const __m128i laneBits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+            const __m128i pressed = _mm_set1_epi8(static_cast<char>(0x80));
 
-    bool IsAnyBoundKeyPressed(const std::array<BYTE, 256>& keyState, const std::vector<uint32_t>& bindings)
-    {
-            for (uint32_t key : bindings)
+            for (int i = 0; i < 16; ++i)
             {
-                    if (IsVirtualKeyPressed(keyState, key))
-                    {
-                            return true;
-                    }
-            }
-
-            return false;
-    }
-
-    void ApplyActionsToState(const std::vector<InputAction>& actions, InputState& state)
-    {
-            for (InputAction action : actions)
-            {
-                    switch (action)
-                    {
-                    case InputAction::Up: state.up = true; break;
-                    case InputAction::Down: state.down = true; break;
-                    case InputAction::Left: state.left = true; break;
-                    case InputAction::Right: state.right = true; break;
-                    case InputAction::A: state.A = true; break;
-                    case InputAction::B: state.B = true; break;
-                    case InputAction::C: state.C = true; break;
-                    case InputAction::D: state.D = true; break;
-                    case InputAction::Taunt: state.taunt = true; break;
-                    case InputAction::Special: state.special = true; break;
-                    case InputAction::Fn1: state.fn1 = true; break;
-                    case InputAction::Fn2: state.fn2 = true; break;
-                    case InputAction::Start: state.start = true; break;
-                    case InputAction::Select: state.select = true; break;
-                    case InputAction::ResetPositions: state.resetPositions = true; break;
-                    default: break;
-                    }
-            }
-    }
-
-    std::vector<InputAction> MenuActionToInputActions(MenuAction action)
-    {
-            switch (action)
-            {
-            case MenuAction::Up: return { InputAction::Up };
-            case MenuAction::Down: return { InputAction::Down };
-            case MenuAction::Left: return { InputAction::Left };
-            case MenuAction::Right: return { InputAction::Right };
-            case MenuAction::PlayerInfo: return { InputAction::A };
-            case MenuAction::FriendFilter: return { InputAction::B };
-            case MenuAction::ReturnAction: return { InputAction::C };
-            case MenuAction::Confirm: return { InputAction::D };
-            case MenuAction::ChangeCategory: return { InputAction::Taunt };
-            case MenuAction::ReplayControls: return { InputAction::Special };
-            case MenuAction::ChangeCategory2: return { InputAction::Fn1 };
-            case MenuAction::ReplayControls2: return { InputAction::Fn2 };
-            default: return {};
-            }
-    }
-
-    std::vector<InputAction> BattleActionToInputActions(BattleAction action)
-    {
-            switch (action)
-            {
-            case BattleAction::Up: return { InputAction::Up };
-            case BattleAction::Down: return { InputAction::Down };
-            case BattleAction::Left: return { InputAction::Left };
-            case BattleAction::Right: return { InputAction::Right };
-            case BattleAction::A: return { InputAction::A };
-            case BattleAction::B: return { InputAction::B };
-            case BattleAction::C: return { InputAction::C };
-            case BattleAction::D: return { InputAction::D };
-            case BattleAction::Taunt: return { InputAction::Taunt };
-            case BattleAction::Special: return { InputAction::Special };
-            case BattleAction::MacroAB: return { InputAction::A, InputAction::B };
-            case BattleAction::MacroBC: return { InputAction::B, InputAction::C };
-            case BattleAction::MacroABC: return { InputAction::A, InputAction::B, InputAction::C };
-            case BattleAction::MacroABCD: return { InputAction::A, InputAction::B, InputAction::C, InputAction::D };
-            case BattleAction::MacroFn1: return { InputAction::Fn1 };
-            case BattleAction::MacroFn2: return { InputAction::Fn2 };
-            case BattleAction::MacroResetPositions: return { InputAction::ResetPositions };
-            default: return {};
+                    const uint32_t keys = (keyBits[i >> 1] >> ((i & 1) * 16)) & 0xFFFF;
+                    __m128i lanes = _mm_cvtsi32_si128(static_cast<int>(keys));
+                    lanes = _mm_unpacklo_epi8(lanes, lanes);
+                    lanes = _mm_unpacklo_epi16(lanes, lanes);
+                    lanes = _mm_unpacklo_epi32(lanes, lanes);
+                    lanes = _mm_cmpeq_epi8(_mm_and_si128(lanes, laneBits), laneBits);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(keyStateOut + i * 16), _mm_and_si128(lanes, pressed));
             }
     }
 
@@ -510,30 +401,6 @@ namespace
             return changed;
     }
 
-    InputState ApplyBattleMapping(const std::array<BYTE, 256>& keyState, KeyboardMapping mapping)
-    {
-            EnsureAllActionsPresent(mapping);
-            InputState state{};
-
-            for (BattleAction action : kBattleActions)
-            {
-                    const auto& bindings = mapping.battleBindings[action];
-                    if (bindings.empty())
-                    {
-                            continue;
-                    }
-
-                    if (!IsAnyBoundKeyPressed(keyState, bindings))
-                    {
-                            continue;
-                    }
-
-                    ApplyActionsToState(BattleActionToInputActions(action), state);
-            }
-
-            return state;
-    }
-
     uint8_t EncodeDirections(const InputState& state)
     {
             const bool up = state.up;
@@ -610,30 +477,6 @@ namespace
             return out;
     }
 
-    InputState ApplyMenuMapping(const std::array<BYTE, 256>& keyState, KeyboardMapping mapping)
-    {
-            EnsureAllActionsPresent(mapping);
-            InputState state{};
-
-            for (MenuAction action : kMenuActions)
-            {
-                    const auto& bindings = mapping.menuBindings[action];
-                    if (bindings.empty())
-                    {
-                            continue;
-                    }
-
-                    if (!IsAnyBoundKeyPressed(keyState, bindings))
-                    {
-                            continue;
-                    }
-
-                    ApplyActionsToState(MenuActionToInputActions(action), state);
-            }
-
-            return state;
-    }
-
     std::string SerializeKeyboardMapping(const KeyboardMapping& mapping)
     {
             KeyboardMapping normalized = mapping;
@@ -1225,18 +1068,6 @@ namespace
                 return std::wstring(executableName);
         }
 
-        size_t HashDevices(const std::vector<ControllerDeviceInfo>& devices)
-        {
-                return std::accumulate(devices.begin(), devices.end(), static_cast<size_t>(0), [](size_t acc, const ControllerDeviceInfo& info) {
-                        acc ^= std::hash<std::string>{}(info.name) + 0x9e3779b97f4a7c15ULL + (acc << 6) + (acc >> 2);
-                        acc ^= info.isKeyboard ? 0xfeedfaceULL : 0; // differentiate keyboard entries
-                        acc ^= info.isWinmmDevice ? 0x1a2b3c4dULL : 0;
-                        acc ^= static_cast<size_t>(info.winmmId) << 32;
-                        acc ^= std::hash<unsigned long>{}(info.guid.Data1);
-                        return acc;
-                });
-        }
-
         size_t CountIgnoreDeviceEntries(const std::wstring& value)
         {
                 size_t entries = 0;
@@ -1571,11 +1402,6 @@ std::string ControllerOverrideManager::VirtualKeyToLabel(uint32_t virtualKey)
         return fallback.str();
 }
 
-extern "C" void HandleControllerWndProcMessage(UINT msg, WPARAM wParam, LPARAM lParam)
-{
-        ControllerOverrideManager::GetInstance().HandleWindowMessage(msg, wParam, lParam);
-}
-
 ControllerOverrideManager& ControllerOverrideManager::GetInstance()
 {
         static ControllerOverrideManager instance;
@@ -1586,6 +1412,13 @@ ControllerOverrideManager::ControllerOverrideManager()
 {
         m_playerSelections[0] = GUID_NULL;
         m_playerSelections[1] = GUID_NULL;
+        for (auto& slot : m_keyboardSlots)
+        {
+                for (auto& word : slot.keyBits)
+                {
+                        word.store(0, std::memory_order_relaxed);
+                }
+        }
         m_autoRefreshEnabled = Settings::settingsIni.autoUpdateControllers;
         m_multipleKeyboardOverrideEnabled = false;
         m_p1KeyboardDeviceIds = DeduplicateList(SplitList(Settings::settingsIni.primaryKeyboardDeviceId));
@@ -1601,6 +1434,34 @@ ControllerOverrideManager::ControllerOverrideManager()
         SetControllerPosSwap(Settings::settingsIni.swapControllerPos);
 }
 
+ControllerOverrideManager::~ControllerOverrideManager()
+{
+        // Static destruction runs in DllMain, the thread was already joined on WM_DESTROY if the game closed normally
+        Shutdown(false);
+}
+
+void ControllerOverrideManager::Shutdown(bool wait)
+{
+        {
+                std::lock_guard<std::mutex> lock(m_enumerationMutex);
+                m_enumerationStopRequested = true;
+        }
+        m_enumerationCondition.notify_one();
+        if (!m_enumerationThread.joinable())
+        {
+                return;
+        }
+        // The thread uses the manager's members until it returns, an enumeration in progress finishes first
+        if (wait)
+        {
+                m_enumerationThread.join();
+        }
+        else
+        {
+                m_enumerationThread.detach();
+        }
+}
+
 void ControllerOverrideManager::SetOverrideEnabled(bool enabled)
 {
         if (!Settings::settingsIni.enableInDevelopmentFeatures)
@@ -1945,7 +1806,8 @@ void ControllerOverrideManager::IgnoreKeyboard(const KeyboardDeviceInfo& info)
                 }
         }
 
-        RefreshKeyboardDevices();
+        // Only the preferences changed, no need to enumerate again
+        ApplyKeyboardDevices(m_allKeyboardDevices);
         EnsureP1KeyboardsValid();
 }
 
@@ -1964,7 +1826,8 @@ void ControllerOverrideManager::UnignoreKeyboard(const std::string& canonicalId)
                 PersistKeyboardIgnores();
         }
 
-        RefreshKeyboardDevices();
+        // Only the preferences changed, no need to enumerate again
+        ApplyKeyboardDevices(m_allKeyboardDevices);
         EnsureP1KeyboardsValid();
 }
 
@@ -1991,7 +1854,8 @@ void ControllerOverrideManager::RenameKeyboard(const KeyboardDeviceInfo& info, c
                 PersistKeyboardRenames();
         }
 
-        RefreshKeyboardDevices();
+        // Only the preferences changed, no need to enumerate again
+        ApplyKeyboardDevices(m_allKeyboardDevices);
         EnsureP1KeyboardsValid();
 }
 
@@ -2069,6 +1933,7 @@ KeyboardMapping ControllerOverrideManager::GetKeyboardMapping(const KeyboardDevi
         {
             PersistKeyboardMappingsLocked();
         }
+        RebuildKeyboardBindingsLocked();
     }
 
     return GetKeyboardMappingLocked(GetKeyboardMappingKey(info));
@@ -2150,21 +2015,71 @@ std::vector<KeyboardDeviceInfo> ControllerOverrideManager::GetIgnoredKeyboardSna
 bool ControllerOverrideManager::RefreshDevices()
 {
         LOG(1, "ControllerOverrideManager::RefreshDevices - begin (override=%d)\n", m_overrideEnabled ? 1 : 0);
-        const size_t previousHash = m_lastDeviceHash;
-        CollectDevices();
+        std::vector<ControllerDeviceInfo> devices;
+        bool steamInputLikely = false;
+        CollectDevices(devices, steamInputLikely);
+        return ApplyDeviceList(std::move(devices), steamInputLikely).Any();
+}
+
+ControllerDeviceDiff ControllerOverrideManager::ApplyDeviceList(std::vector<ControllerDeviceInfo> devices, bool steamInputLikely)
+{
+        const ControllerDeviceDiff diff = DiffDevices(m_devices, devices);
+        m_devices.swap(devices);
+        m_steamInputLikely = steamInputLikely;
         EnsureSelectionsValid();
         m_lastRefresh = GetTickCount64();
-        m_lastDeviceHash = HashDevices(m_devices);
-        const bool devicesChanged = (m_lastDeviceHash != previousHash);
-        LOG(1, "ControllerOverrideManager::RefreshDevices - end (devices=%zu, hash=%zu changed=%d)\n", m_devices.size(), m_lastDeviceHash, devicesChanged ? 1 : 0);
-        return devicesChanged;
+        LOG(1, "ControllerOverrideManager::ApplyDeviceList - devices=%zu added=%zu removed=%zu reordered=%d\n",
+                m_devices.size(), diff.added, diff.removed, diff.reordered ? 1 : 0);
+        return diff;
+}
+
+ControllerDeviceDiff ControllerOverrideManager::DiffDevices(const std::vector<ControllerDeviceInfo>& before, const std::vector<ControllerDeviceInfo>& after)
+{
+        auto contains = [](const std::vector<ControllerDeviceInfo>& devices, const GUID& guid) {
+                return std::any_of(devices.begin(), devices.end(), [&](const ControllerDeviceInfo& info) {
+                        return IsEqualGUID(info.guid, guid);
+                });
+        };
+
+        ControllerDeviceDiff diff;
+        std::vector<GUID> kept;
+        for (const auto& info : after)
+        {
+                if (contains(before, info.guid))
+                {
+                        kept.push_back(info.guid);
+                }
+                else
+                {
+                        ++diff.added;
+                }
+        }
+
+        // The devices both lists have, in the same order, otherwise the game's pad slots move
+        size_t keptIndex = 0;
+        for (const auto& info : before)
+        {
+                if (!contains(after, info.guid))
+                {
+                        ++diff.removed;
+                }
+                else if (keptIndex < kept.size() && !IsEqualGUID(kept[keptIndex++], info.guid))
+                {
+                        diff.reordered = true;
+                }
+        }
+
+        return diff;
 }
 
 bool ControllerOverrideManager::RefreshKeyboardDevices()
 {
-        LOG(1, "ControllerOverrideManager::RefreshKeyboardDevices - begin\n");
+        return ApplyKeyboardDevices(EnumerateKeyboardDevices());
+}
 
-        std::vector<KeyboardDeviceInfo> devices = EnumerateKeyboardDevices();
+bool ControllerOverrideManager::ApplyKeyboardDevices(std::vector<KeyboardDeviceInfo> devices)
+{
+        LOG(1, "ControllerOverrideManager::ApplyKeyboardDevices - begin\n");
 
         ApplyKeyboardPreferences(devices);
 
@@ -2189,24 +2104,29 @@ bool ControllerOverrideManager::RefreshKeyboardDevices()
 
                 m_keyboardDevices.swap(filtered);
 
-                for (auto it = m_keyboardStates.begin(); it != m_keyboardStates.end();)
+                for (int slot = 0; slot < static_cast<int>(KEYBOARD_STATE_SLOTS); ++slot)
                 {
+                        HANDLE deviceHandle = m_keyboardSlots[slot].deviceHandle.load(std::memory_order_acquire);
+                        if (!deviceHandle)
+                        {
+                                continue;
+                        }
+
                         auto exists = std::any_of(m_keyboardDevices.begin(), m_keyboardDevices.end(), [&](const KeyboardDeviceInfo& info) {
-                                return info.deviceHandle == it->first;
+                                return info.deviceHandle == deviceHandle;
                         });
 
                         if (!exists)
                         {
-                                it = m_keyboardStates.erase(it);
-                        }
-                        else
-                        {
-                                ++it;
+                                ReleaseKeyboardSlot(slot);
                         }
                 }
+
+                UpdateP1KeyboardSlotMaskLocked();
+                RebuildKeyboardBindingsLocked();
         }
 
-        LOG(1, "ControllerOverrideManager::RefreshKeyboardDevices - end count=%zu->%zu\n", previousCount, m_keyboardDevices.size());
+        LOG(1, "ControllerOverrideManager::ApplyKeyboardDevices - end count=%zu->%zu\n", previousCount, m_keyboardDevices.size());
 
         EnsureP1KeyboardsValid();
 
@@ -2233,34 +2153,19 @@ void ControllerOverrideManager::ApplyKeyboardPreferences(std::vector<KeyboardDev
 
 void ControllerOverrideManager::RefreshDevicesAndReinitializeGame()
 {
-    LOG(1, "ControllerOverrideManager::RefreshDevicesAndReinitializeGame - begin\n");
-    
-    //If controllers are swapped before we reinitialize, then make sure to swap them again at the end.
-    bool controllerPosSwap = m_ControllerPosSwap;
-    if (controllerPosSwap) {
-        SetControllerPosSwap(false);
-    }
-
-    RefreshDevices();
-    RefreshKeyboardDevices();
-    EnsureP1KeyboardsValid();
-    ReinitializeGameInputs();
-
-    if (controllerPosSwap) {
-        SetControllerPosSwap(true);
-    }
+    LOG(1, "ControllerOverrideManager::RefreshDevicesAndReinitializeGame - requested\n");
 
-    LOG(1, "ControllerOverrideManager::RefreshDevicesAndReinitializeGame - end\n");
+    // Enumerated in the background like any device change, but the game reinitializes even if nothing changed
+    RequestDeviceEnumeration(true);
 }
 
 void ControllerOverrideManager::TickAutoRefresh()
 {
-        if (!m_deviceChangeQueued.load())
+        if (!m_deviceSnapshotReady.load())
         {
                 return;
         }
 
-        m_deviceChangeQueued = false;
         ProcessPendingDeviceChange();
 }
 
@@ -2372,16 +2277,103 @@ void ControllerOverrideManager::ReinitializeGameInputs()
         LOG(1, "ControllerOverrideManager::ReinitializeGameInputs - end\n");
 }
 
+void ControllerOverrideManager::RequestDeviceEnumeration(bool forceReinitialize)
+{
+        {
+                std::lock_guard<std::mutex> lock(m_enumerationMutex);
+                // Nothing is started again once Shutdown has run
+                if (m_enumerationStopRequested)
+                {
+                        return;
+                }
+                m_enumerationRequested = true;
+                m_forceReinitializeRequested = m_forceReinitializeRequested || forceReinitialize;
+                if (!m_enumerationThread.joinable())
+                {
+                        m_enumerationThread = std::thread(&ControllerOverrideManager::EnumerationLoop, this);
+                }
+        }
+        m_enumerationCondition.notify_one();
+}
+
+// DirectInput, WinMM and the raw keyboards can take a while to list with a lot of HID devices plugged in,
+// so they're listed here and the game thread only applies the result
+void ControllerOverrideManager::EnumerationLoop()
+{
+        for (;;)
+        {
+                bool forceReinitialize = false;
+                {
+                        std::unique_lock<std::mutex> lock(m_enumerationMutex);
+                        m_enumerationCondition.wait(lock, [this] { return m_enumerationRequested || m_enumerationStopRequested; });
+                        if (m_enumerationStopRequested)
+                        {
+                                return;
+                        }
+
+                        // A plug in sends several WM_DEVICECHANGE, the ones that came in meanwhile share this enumeration
+                        m_enumerationRequested = false;
+                        forceReinitialize = m_forceReinitializeRequested;
+                        m_forceReinitializeRequested = false;
+                }
+
+                auto snapshot = std::make_shared<DeviceSnapshot>();
+                CollectDevices(snapshot->devices, snapshot->steamInputLikely);
+                snapshot->keyboards = EnumerateKeyboardDevices();
+                snapshot->forceReinitialize = forceReinitialize;
+
+                {
+                        std::lock_guard<std::mutex> lock(m_enumerationMutex);
+                        // Replaces a snapshot the game thread hasn't got to yet, without losing its forced reinitialize
+                        if (m_pendingSnapshot && m_pendingSnapshot->forceReinitialize)
+                        {
+                                snapshot->forceReinitialize = true;
+                        }
+                        m_pendingSnapshot = std::move(snapshot);
+                }
+                m_deviceSnapshotReady = true;
+        }
+}
+
 void ControllerOverrideManager::ProcessPendingDeviceChange()
 {
-        LOG(1, "ControllerOverrideManager::ProcessPendingDeviceChange - begin (autoRefresh=%d)\n", m_autoRefreshEnabled ? 1 : 0);
+        std::shared_ptr<const DeviceSnapshot> snapshot;
+        {
+                std::lock_guard<std::mutex> lock(m_enumerationMutex);
+                snapshot.swap(m_pendingSnapshot);
+                m_deviceSnapshotReady = false;
+        }
+
+        if (!snapshot)
+        {
+                return;
+        }
 
-        m_deviceChangeQueued = false;
+        LOG(1, "ControllerOverrideManager::ProcessPendingDeviceChange - begin (autoRefresh=%d force=%d)\n", m_autoRefreshEnabled ? 1 : 0, snapshot->forceReinitialize ? 1 : 0);
 
-        const bool devicesChanged = RefreshDevices();
-        if (!devicesChanged)
+        if (snapshot->forceReinitialize)
         {
-                LOG(1, "ControllerOverrideManager::ProcessPendingDeviceChange - device hash unchanged, skipping reinitialize\n");
+                //If controllers are swapped before we reinitialize, then make sure to swap them again at the end.
+                bool controllerPosSwap = m_ControllerPosSwap;
+                if (controllerPosSwap) {
+                        SetControllerPosSwap(false);
+                }
+
+                ApplyDeviceList(snapshot->devices, snapshot->steamInputLikely);
+                ApplyKeyboardDevices(snapshot->keyboards);
+                ReinitializeGameInputs();
+
+                if (controllerPosSwap) {
+                        SetControllerPosSwap(true);
+                }
+                return;
+        }
+
+        const ControllerDeviceDiff diff = ApplyDeviceList(snapshot->devices, snapshot->steamInputLikely);
+        ApplyKeyboardDevices(snapshot->keyboards);
+        if (!diff.Any())
+        {
+                LOG(1, "ControllerOverrideManager::ProcessPendingDeviceChange - controllers unchanged, skipping reinitialize\n");
                 return;
         }
 
@@ -2408,25 +2400,20 @@ void ControllerOverrideManager::ProcessRawInput(HRAWINPUT rawInput)
                 return;
         }
 
-        UINT size = 0;
-        if (GetRawInputData(rawInput, RID_INPUT, nullptr, &size, sizeof(RAWINPUTHEADER)) != 0 || size == 0)
-        {
-                return;
-        }
-
-        std::vector<BYTE> buffer(size);
-        if (GetRawInputData(rawInput, RID_INPUT, buffer.data(), &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1) || size == 0)
+        // A keyboard message always fits in a RAWINPUT, anything bigger isn't one we want
+        RAWINPUT data;
+        UINT size = sizeof(data);
+        if (GetRawInputData(rawInput, RID_INPUT, &data, &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1) || size == 0)
         {
                 return;
         }
 
-        RAWINPUT* data = reinterpret_cast<RAWINPUT*>(buffer.data());
-        if (!data || data->header.dwType != RIM_TYPEKEYBOARD)
+        if (data.header.dwType != RIM_TYPEKEYBOARD)
         {
                 return;
         }
 
-        const RAWKEYBOARD& kb = data->data.keyboard;
+        const RAWKEYBOARD& kb = data.data.keyboard;
         USHORT virtualKey = kb.VKey;
         if (virtualKey == 0 || virtualKey >= 256)
         {
@@ -2434,22 +2421,32 @@ void ControllerOverrideManager::ProcessRawInput(HRAWINPUT rawInput)
         }
 
         const bool isBreak = (kb.Flags & RI_KEY_BREAK) != 0;
-        const BYTE newState = isBreak ? 0x00 : 0x80;
-        HANDLE deviceHandle = data->header.hDevice;
-
+        const int slot = AcquireKeyboardSlot(data.header.hDevice);
+        if (slot < 0)
         {
-                std::lock_guard<std::mutex> lock(m_keyboardMutex);
-                auto& state = m_keyboardStates[deviceHandle];
-                state[virtualKey] = newState;
+                return;
+        }
 
-                UpdateP2KeyboardOverrideLocked();
+        std::atomic<uint32_t>& word = m_keyboardSlots[slot].keyBits[virtualKey >> 5];
+        const uint32_t keyBit = 1u << (virtualKey & 31);
+        if (isBreak)
+        {
+                word.fetch_and(~keyBit, std::memory_order_release);
+        }
+        else if (!(word.fetch_or(keyBit, std::memory_order_release) & keyBit))
+        {
+                // Held keys repeat the make code, only the first one is a press
+                const bool p1 = (m_p1KeyboardSlotMask.load(std::memory_order_acquire) >> slot) & 1;
+                InputLatencyMonitor::GetInstance().OnKeyPressed(InputLatencySource_RawInput, p1 ? 0 : 1, static_cast<uint8_t>(virtualKey));
         }
+
+        ResolveP2KeyboardOverride();
 }
 
 void ControllerOverrideManager::HandleRawInputDeviceChange(HANDLE deviceHandle, bool arrived)
 {
         LOG(1, "ControllerOverrideManager::HandleRawInputDeviceChange - handle=%p arrived=%d\n", deviceHandle, arrived ? 1 : 0);
-        RefreshKeyboardDevices();
+        RequestDeviceEnumeration(false);
 }
 
 void ControllerOverrideManager::EnsureRawKeyboardRegistration()
@@ -2489,12 +2486,13 @@ bool ControllerOverrideManager::GetFilteredKeyboardState(BYTE* keyStateOut)
                 return false;
         }
 
+        InputLatencyMonitor::GetInstance().OnKeyboardPolled();
+
         if (!m_multipleKeyboardOverrideEnabled)
         {
                 return ::GetKeyboardState(keyStateOut) == TRUE;
         }
 
-        std::lock_guard<std::mutex> lock(m_keyboardMutex);
         // While the keyboard mapping popup is open, we don't want any keyboard input
         // to drive the game at all. The popup reads raw snapshots directly, so it
         // still works, but here we return a "neutral" keyboard state to the game.
@@ -2504,31 +2502,28 @@ bool ControllerOverrideManager::GetFilteredKeyboardState(BYTE* keyStateOut)
             return true;
         }
 
-        UpdateP2KeyboardOverrideLocked();
-
-
-        if (m_p1KeyboardHandles.empty())
-        {
-                ZeroMemory(keyStateOut, 256);
-                return true;
-        }
-
-        ZeroMemory(keyStateOut, 256);
+        ResolveP2KeyboardOverride();
 
-        for (HANDLE handle : m_p1KeyboardHandles)
+        __m128i merged[2] = { _mm_setzero_si128(), _mm_setzero_si128() };
+        const uint32_t p1Slots = m_p1KeyboardSlotMask.load(std::memory_order_acquire);
+        for (int slot = 0; slot < static_cast<int>(KEYBOARD_STATE_SLOTS); ++slot)
         {
-                auto it = m_keyboardStates.find(handle);
-                if (it == m_keyboardStates.end())
+                if (!(p1Slots & (1u << slot)))
                 {
                         continue;
                 }
 
-                for (size_t i = 0; i < 256; ++i)
-                {
-                        keyStateOut[i] |= it->second[i];
-                }
+                alignas(16) uint32_t keyBits[8];
+                ReadKeyboardSlot(slot, keyBits);
+                merged[0] = _mm_or_si128(merged[0], _mm_load_si128(reinterpret_cast<const __m128i*>(keyBits)));
+                merged[1] = _mm_or_si128(merged[1], _mm_load_si128(reinterpret_cast<const __m128i*>(keyBits + 4)));
         }
 
+        alignas(16) uint32_t mergedBits[8];
+        _mm_store_si128(reinterpret_cast<__m128i*>(mergedBits), merged[0]);
+        _mm_store_si128(reinterpret_cast<__m128i*>(mergedBits + 4), merged[1]);
+        ExpandKeyBits(mergedBits, keyStateOut);
+
         return true;
 }
 
@@ -2543,13 +2538,15 @@ bool ControllerOverrideManager::GetKeyboardStateSnapshot(HANDLE deviceHandle, st
 
         SeedKeyboardStateForHandle(deviceHandle);
 
-        auto it = m_keyboardStates.find(deviceHandle);
-        if (it == m_keyboardStates.end())
+        const int slot = FindKeyboardSlot(deviceHandle);
+        if (slot < 0)
         {
                 return false;
         }
 
-        outState = it->second;
+        uint32_t keyBits[8];
+        ReadKeyboardSlot(slot, keyBits);
+        ExpandKeyBits(keyBits, outState.data());
         return true;
 }
 
@@ -2560,6 +2557,13 @@ void ControllerOverrideManager::HandleWindowMessage(UINT msg, WPARAM wParam, LPA
                 EnsureRawKeyboardRegistration();
         }
 
+        // Without the separation the game reads the one keyboard state, so the press can't be tied to a side
+        if ((msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN) && !m_multipleKeyboardOverrideEnabled && !(lParam & (1 << 30)) && wParam < 256)
+        {
+                InputLatencyMonitor::GetInstance().OnKeyPressed(InputLatencySource_WindowMessage, -1, static_cast<uint8_t>(wParam));
+                return;
+        }
+
         if (msg == WM_INPUT)
         {
                 if (m_multipleKeyboardOverrideEnabled)
@@ -2588,9 +2592,7 @@ void ControllerOverrideManager::HandleWindowMessage(UINT msg, WPARAM wParam, LPA
         case DBT_DEVICEREMOVECOMPLETE:
         case DBT_DEVNODES_CHANGED:
                 LOG(1, "ControllerOverrideManager::HandleWindowMessage - WM_DEVICECHANGE wParam=0x%08lX lParam=0x%08lX\n", wParam, lParam);
-                m_deviceChangeQueued = true;
-                ProcessPendingDeviceChange();
-                RefreshKeyboardDevices();
+                RequestDeviceEnumeration(false);
                 break;
         default:
                 break;
@@ -2600,10 +2602,48 @@ void ControllerOverrideManager::HandleWindowMessage(UINT msg, WPARAM wParam, LPA
 void ControllerOverrideManager::UpdateP2KeyboardOverride()
 {
         std::lock_guard<std::mutex> lock(m_keyboardMutex);
-        UpdateP2KeyboardOverrideLocked();
+        RebuildKeyboardBindingsLocked();
+        ResolveP2KeyboardOverride();
 }
 
-void ControllerOverrideManager::UpdateP2KeyboardOverrideLocked()
+void ControllerOverrideManager::RebuildKeyboardBindingsLocked()
+{
+        const uint32_t version = m_keyboardBindingsVersion.load(std::memory_order_relaxed);
+        KeyboardBindingTables& tables = m_keyboardBindings[(version + 1) & 1];
+
+        // Same fallbacks as GetKeyboardMappingLocked, without saving a mapping for every keyboard plugged in
+        const KeyboardMapping defaultMapping = KeyboardMapping::CreateDefault();
+        const KeyboardMapping& fallbackMapping = m_keyboardMappings.empty() ? defaultMapping : m_keyboardMappings.begin()->second;
+
+        tables.deviceCount = 0;
+        for (const auto& info : m_allKeyboardDevices)
+        {
+                if (tables.deviceCount == KEYBOARD_STATE_SLOTS)
+                {
+                        LOG(1, "ControllerOverrideManager::RebuildKeyboardBindingsLocked - more than %zu keyboards, the rest use the default mapping\n", KEYBOARD_STATE_SLOTS);
+                        break;
+                }
+
+                KeyboardBindingTable& table = tables.devices[tables.deviceCount++];
+                table.deviceHandle = info.deviceHandle;
+                table.ignored = info.ignored;
+                if (info.ignored)
+                {
+                        continue;
+                }
+
+                auto it = m_keyboardMappings.find(GetKeyboardMappingKey(info));
+                CompileKeyboardMapping(it != m_keyboardMappings.end() ? it->second : fallbackMapping, table);
+        }
+
+        CompileKeyboardMapping(defaultMapping, tables.defaults);
+
+        m_keyboardBindingsVersion.store(version + 1, std::memory_order_release);
+}
+
+// Lock-free, it runs on every raw key message and game poll. Two threads resolving at the same time
+// both publish the latest key state, so the words they store agree.
+void ControllerOverrideManager::ResolveP2KeyboardOverride()
 {
         if (!m_multipleKeyboardOverrideEnabled)
         {
@@ -2629,34 +2669,56 @@ void ControllerOverrideManager::UpdateP2KeyboardOverrideLocked()
             return;
         }
 
-        InputState aggregatedBattle{};
-        InputState aggregatedMenu{};
-
-        for (const auto& kvp : m_keyboardStates)
+        uint16_t battleActions = 0;
+        uint16_t menuActions = 0;
+        const uint32_t p1Slots = m_p1KeyboardSlotMask.load(std::memory_order_acquire);
+        for (;;)
         {
-                if (IsP1KeyboardHandleLocked(kvp.first))
+                const uint32_t version = m_keyboardBindingsVersion.load(std::memory_order_acquire);
+                const KeyboardBindingTables& tables = m_keyboardBindings[version & 1];
+
+                battleActions = 0;
+                menuActions = 0;
+                for (int slot = 0; slot < static_cast<int>(KEYBOARD_STATE_SLOTS); ++slot)
                 {
-                        continue;
-                }
+                        HANDLE deviceHandle = m_keyboardSlots[slot].deviceHandle.load(std::memory_order_acquire);
+                        if (!deviceHandle || (p1Slots & (1u << slot)))
+                        {
+                                continue;
+                        }
 
-                auto infoIt = std::find_if(m_allKeyboardDevices.begin(), m_allKeyboardDevices.end(), [&](const KeyboardDeviceInfo& info) {
-                        return info.deviceHandle == kvp.first;
-                });
+                        const KeyboardBindingTable* table = &tables.defaults;
+                        for (size_t i = 0; i < tables.deviceCount; ++i)
+                        {
+                                if (tables.devices[i].deviceHandle == deviceHandle)
+                                {
+                                        table = &tables.devices[i];
+                                        break;
+                                }
+                        }
 
-                if (infoIt != m_allKeyboardDevices.end() && infoIt->ignored)
-                {
-                        continue;
+                        if (table->ignored)
+                        {
+                                continue;
+                        }
+
+                        uint32_t keyBits[8];
+                        ReadKeyboardSlot(slot, keyBits);
+                        ResolveKeyBindings(keyBits, *table, battleActions, menuActions);
                 }
 
-                const std::string mappingKey = (infoIt != m_allKeyboardDevices.end()) ? GetKeyboardMappingKey(*infoIt) : std::string{};
-                const auto mapping = GetKeyboardMappingLocked(mappingKey);
-                const InputState mappedBattle = ApplyBattleMapping(kvp.second, mapping);
-                const InputState mappedMenu = ApplyMenuMapping(kvp.second, mapping);
-                MergeInputState(mappedBattle, aggregatedBattle);
-                MergeInputState(mappedMenu, aggregatedMenu);
+                // Still the same version, the rebuild hasn't started writing over these tables
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_keyboardBindingsVersion.load(std::memory_order_relaxed) == version)
+                {
+                        break;
+                }
         }
 
-        OverrideBattleInput(1, aggregatedBattle, 1);
+        const InputState aggregatedBattle = ActionMaskToState(battleActions);
+        const InputState aggregatedMenu = ActionMaskToState(menuActions);
+
+        OverrideBattleInput(1, aggregatedBattle, 1, BattleInputSource_KeyboardOverride);
 
         SystemInputBytes charBytes = BuildSystemInputBytes(aggregatedBattle);
         uint32_t charWord = PackSystemInputWord(charBytes);
@@ -2681,20 +2743,120 @@ void ControllerOverrideManager::SeedKeyboardStateForHandle(HANDLE deviceHandle)
                 return;
         }
 
-        if (m_keyboardStates.find(deviceHandle) != m_keyboardStates.end())
+        if (FindKeyboardSlot(deviceHandle) >= 0)
+        {
+                return;
+        }
+
+        const int slot = AcquireKeyboardSlot(deviceHandle);
+        if (slot < 0)
         {
+                LOG(1, "ControllerOverrideManager::SeedKeyboardStateForHandle - no free keyboard slot for handle=%p\n", deviceHandle);
                 return;
         }
 
         BYTE seedState[256] = {};
-        if (::GetKeyboardState(seedState))
+        if (!::GetKeyboardState(seedState))
         {
-                std::array<BYTE, 256> snapshot{};
-                memcpy(snapshot.data(), seedState, 256);
-                m_keyboardStates[deviceHandle] = snapshot;
+                return;
+        }
+
+        for (int word = 0; word < 8; ++word)
+        {
+                uint32_t keyBits = 0;
+                for (int bit = 0; bit < 32; ++bit)
+                {
+                        if (seedState[word * 32 + bit] & 0x80)
+                        {
+                                keyBits |= 1u << bit;
+                        }
+                }
+                m_keyboardSlots[slot].keyBits[word].fetch_or(keyBits, std::memory_order_release);
         }
 }
 
+int ControllerOverrideManager::FindKeyboardSlot(HANDLE deviceHandle) const
+{
+        for (int slot = 0; slot < static_cast<int>(KEYBOARD_STATE_SLOTS); ++slot)
+        {
+                if (m_keyboardSlots[slot].deviceHandle.load(std::memory_order_acquire) == deviceHandle)
+                {
+                        return slot;
+                }
+        }
+
+        return -1;
+}
+
+int ControllerOverrideManager::AcquireKeyboardSlot(HANDLE deviceHandle)
+{
+        if (!deviceHandle)
+        {
+                return -1;
+        }
+
+        int slot = FindKeyboardSlot(deviceHandle);
+        if (slot >= 0)
+        {
+                return slot;
+        }
+
+        for (slot = 0; slot < static_cast<int>(KEYBOARD_STATE_SLOTS); ++slot)
+        {
+                HANDLE expected = nullptr;
+                if (m_keyboardSlots[slot].deviceHandle.compare_exchange_strong(expected, deviceHandle, std::memory_order_acq_rel))
+                {
+                        break;
+                }
+        }
+
+        if (slot == static_cast<int>(KEYBOARD_STATE_SLOTS))
+        {
+                return -1;
+        }
+
+        // Claimed by the message thread and the UI at the same time, the lowest slot wins
+        const int existing = FindKeyboardSlot(deviceHandle);
+        if (existing != slot)
+        {
+                ReleaseKeyboardSlot(slot);
+        }
+
+        return existing;
+}
+
+void ControllerOverrideManager::ReleaseKeyboardSlot(int slot)
+{
+        for (auto& word : m_keyboardSlots[slot].keyBits)
+        {
+                word.store(0, std::memory_order_relaxed);
+        }
+        m_keyboardSlots[slot].deviceHandle.store(nullptr, std::memory_order_release);
+}
+
+void ControllerOverrideManager::ReadKeyboardSlot(int slot, uint32_t (&keyBits)[8]) const
+{
+        for (int word = 0; word < 8; ++word)
+        {
+                keyBits[word] = m_keyboardSlots[slot].keyBits[word].load(std::memory_order_acquire);
+        }
+}
+
+void ControllerOverrideManager::UpdateP1KeyboardSlotMaskLocked()
+{
+        uint32_t p1Slots = 0;
+        for (HANDLE handle : m_p1KeyboardHandles)
+        {
+                const int slot = FindKeyboardSlot(handle);
+                if (slot >= 0)
+                {
+                        p1Slots |= 1u << slot;
+                }
+        }
+
+        m_p1KeyboardSlotMask.store(p1Slots, std::memory_order_release);
+}
+
 void ControllerOverrideManager::UpdateP1KeyboardSelectionLocked(const std::vector<HANDLE>& deviceHandles)
 {
         std::vector<HANDLE> filtered;
@@ -2776,12 +2938,15 @@ void ControllerOverrideManager::UpdateP1KeyboardSelectionLocked(const std::vecto
                 m_p1KeyboardHandleSet.insert(handle);
         }
 
+        UpdateP1KeyboardSlotMaskLocked();
+
         m_p1KeyboardDeviceIds = DeduplicateList(resolvedIds);
 
         Settings::settingsIni.primaryKeyboardDeviceId = SerializeList(m_p1KeyboardDeviceIds);
         Settings::changeSetting("PrimaryKeyboardDeviceId", Settings::settingsIni.primaryKeyboardDeviceId);
 
-        UpdateP2KeyboardOverrideLocked();
+        RebuildKeyboardBindingsLocked();
+        ResolveP2KeyboardOverride();
 
         LOG(1, "ControllerOverrideManager::UpdateP1KeyboardSelectionLocked - selected keyboards=%zu available=%zu all=%zu\n",
                 m_p1KeyboardHandles.size(), m_keyboardDevices.size(), m_allKeyboardDevices.size());
@@ -3003,7 +3168,7 @@ void ControllerOverrideManager::EnsureP1KeyboardsValid()
 }
 
 
-bool ControllerOverrideManager::CollectDevices()
+bool ControllerOverrideManager::CollectDevices(std::vector<ControllerDeviceInfo>& outDevices, bool& outSteamInputLikely)
 {
         LOG(1, "ControllerOverrideManager::CollectDevices - begin\n");
         auto envInfo = GetSteamInputEnvInfo();
@@ -3037,20 +3202,21 @@ bool ControllerOverrideManager::CollectDevices()
             devices.push_back(diDev);
         }
 
-        m_devices.swap(devices);
+        outDevices.swap(devices);
 
-        LOG(1, "ControllerOverrideManager::CollectDevices - envLikely=%d steamInputLikely=%d diSuccess=%d diCount=%zu winmmCount=%zu total=%zu\n",
-                envLikely ? 1 : 0, m_steamInputLikely ? 1 : 0, diSuccess ? 1 : 0, directInputDevices.size(), winmmDevices.size(), m_devices.size());
+        // steamInputLikely is decided further down, the [SteamInputDetect] final line logs it
+        LOG(1, "ControllerOverrideManager::CollectDevices - envLikely=%d diSuccess=%d diCount=%zu winmmCount=%zu total=%zu\n",
+                envLikely ? 1 : 0, diSuccess ? 1 : 0, directInputDevices.size(), winmmDevices.size(), outDevices.size());
 
-        for (size_t i = 0; i < m_devices.size(); ++i)
+        for (size_t i = 0; i < outDevices.size(); ++i)
         {
-                const auto& device = m_devices[i];
+                const auto& device = outDevices[i];
                 LOG(1, "  Device[%zu]: name='%s' guid=%s keyboard=%d winmm=%d winmmId=%u\n", i, device.name.c_str(), GuidToString(device.guid).c_str(),
                         device.isKeyboard ? 1 : 0, device.isWinmmDevice ? 1 : 0, device.winmmId);
         }
 
         size_t diGamepadCount = 0;
-        for (const auto& device : m_devices)
+        for (const auto& device : outDevices)
         {
                 if (device.isKeyboard)
                         continue;
@@ -3068,7 +3234,7 @@ bool ControllerOverrideManager::CollectDevices()
                         continue;
 
                 bool matched = false;
-                for (const auto& device : m_devices)
+                for (const auto& device : outDevices)
                 {
                         if (device.isKeyboard || !device.hasVendorProductIds)
                                 continue;
@@ -3094,10 +3260,10 @@ bool ControllerOverrideManager::CollectDevices()
         // Consider Steam Input active only when (a) the SDL ignore list length matches the large Steam Input profile and
         // (b) at least one gamepad remains visible to DirectInput. Module presence and filtering hints are logged for
         // diagnostics but no longer drive the decision to avoid false positives when SteamInput DLLs are loaded for other reasons.
-        m_steamInputLikely = envLikely && anyListedGamepad;
+        outSteamInputLikely = envLikely && anyListedGamepad;
 
         LOG(1, "[SteamInputDetect] final steamInputLikely=%d (envLikely=%d moduleLoaded=%d rawSuggestsFiltering=%d winmmSuggestsFiltering=%d rawMissing=%d rawCount=%zu envIgnoreEntries=%zu envLen=%lu)\n",
-                m_steamInputLikely ? 1 : 0,
+                outSteamInputLikely ? 1 : 0,
                 envLikely ? 1 : 0,
                 steamModuleLoaded ? 1 : 0,
                 rawSuggestsFiltering ? 1 : 0,
@@ -8,55 +8,15 @@
 #include <mutex>
 #include <atomic>
 #include <array>
+#include <condition_variable>
 #include <map>
+#include <memory>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <cstdint>
 
-enum class MenuAction
-{
-        Up,
-        Down,
-        Left,
-        Right,
-        PlayerInfo,
-        FriendFilter,
-        ReturnAction,
-        Confirm,
-        ChangeCategory,
-        ReplayControls,
-        ChangeCategory2,
-        ReplayControls2,
-};
-
-enum class BattleAction
-{
-        Up,
-        Down,
-        Left,
-        Right,
-        A,
-        B,
-        C,
-        D,
-        Taunt,
-        Special,
-        MacroAB,
-        MacroBC,
-        MacroABC,
-        MacroABCD,
-        MacroFn1,
-        MacroFn2,
-        MacroResetPositions,
-};
-
-struct KeyboardMapping
-{
-        std::map<MenuAction, std::vector<uint32_t>> menuBindings;
-        std::map<BattleAction, std::vector<uint32_t>> battleBindings;
-
-        static KeyboardMapping CreateDefault();
-};
+#include "KeyboardBindings.h"
 
 struct ControllerDeviceInfo
 {
@@ -81,6 +41,26 @@ struct KeyboardDeviceInfo
         bool connected = true;
 };
 
+// What one device enumeration found. Built on the enumeration thread and not changed after,
+// the game thread applies it at the start of a frame.
+struct DeviceSnapshot
+{
+        std::vector<ControllerDeviceInfo> devices;
+        std::vector<KeyboardDeviceInfo> keyboards;
+        bool steamInputLikely = false;
+        bool forceReinitialize = false;
+};
+
+// How the controller list changed, the game only reinitializes its pads when something did
+struct ControllerDeviceDiff
+{
+        size_t added = 0;
+        size_t removed = 0;
+        bool reordered = false;
+
+        bool Any() const { return added != 0 || removed != 0 || reordered; }
+};
+
 std::string GuidToString(const GUID& guid);
 
 // Represents the 4 system-controller bytes (+30..+33) before packing.
@@ -92,6 +72,26 @@ struct SystemInputBytes
         uint8_t system = 0;    // +33
 };
 
+// Raw keyboards tracked at once, each gets one KeyboardStateSlot for as long as it's connected.
+const size_t KEYBOARD_STATE_SLOTS = 16;
+
+// Pressed state of the 256 virtual keys of one raw keyboard, one bit per key.
+// A WM_INPUT message changes a single key, so it's one atomic OR/AND on the word
+// holding it, the game's keyboard poll reads the words without locking.
+struct KeyboardStateSlot
+{
+        std::atomic<HANDLE> deviceHandle{ nullptr };
+        std::atomic<uint32_t> keyBits[8];
+};
+
+struct KeyboardBindingTables
+{
+        KeyboardBindingTable devices[KEYBOARD_STATE_SLOTS];
+        size_t deviceCount = 0;
+        // For the keyboards that send input before they're enumerated
+        KeyboardBindingTable defaults;
+};
+
 enum class SystemControllerSlot
 {
         MenuP1,
@@ -108,6 +108,10 @@ class ControllerOverrideManager
 public:
         static ControllerOverrideManager& GetInstance();
 
+        // Stops the device enumeration thread before the mod unloads. Only waits for it if wait is set,
+        // DllMain holds the loader lock and joining a thread there can deadlock.
+        void Shutdown(bool wait = true);
+
         void SetOverrideEnabled(bool enabled);
         bool IsOverrideEnabled() const;
 
@@ -187,14 +191,18 @@ public:
 
 private:
         ControllerOverrideManager();
+        ~ControllerOverrideManager();
 
         template <typename T>
         void ApplyOrderingImpl(std::vector<T>& devices) const;
 
         void EnsureSelectionsValid();
         void EnsureP1KeyboardsValid();
-        bool CollectDevices();
+        bool CollectDevices(std::vector<ControllerDeviceInfo>& outDevices, bool& outSteamInputLikely);
+        ControllerDeviceDiff ApplyDeviceList(std::vector<ControllerDeviceInfo> devices, bool steamInputLikely);
+        static ControllerDeviceDiff DiffDevices(const std::vector<ControllerDeviceInfo>& before, const std::vector<ControllerDeviceInfo>& after);
         bool RefreshKeyboardDevices();
+        bool ApplyKeyboardDevices(std::vector<KeyboardDeviceInfo> devices);
         void ApplyKeyboardPreferences(std::vector<KeyboardDeviceInfo>& devices);
         void PersistKeyboardIgnores();
         void PersistKeyboardRenames();
@@ -213,13 +221,21 @@ private:
         void SendDeviceChangeBroadcast() const;
         void ReinitializeGameInputs();
         void ProcessPendingDeviceChange();
+        void RequestDeviceEnumeration(bool forceReinitialize);
+        void EnumerationLoop();
 
         void ProcessRawInput(HRAWINPUT rawInput);
         void HandleRawInputDeviceChange(HANDLE deviceHandle, bool arrived);
         void EnsureRawKeyboardRegistration();
         void UpdateP2KeyboardOverride();
-        void UpdateP2KeyboardOverrideLocked();
+        void RebuildKeyboardBindingsLocked();
+        void ResolveP2KeyboardOverride();
         void SeedKeyboardStateForHandle(HANDLE deviceHandle);
+        int FindKeyboardSlot(HANDLE deviceHandle) const;
+        int AcquireKeyboardSlot(HANDLE deviceHandle);
+        void ReleaseKeyboardSlot(int slot);
+        void ReadKeyboardSlot(int slot, uint32_t (&keyBits)[8]) const;
+        void UpdateP1KeyboardSlotMaskLocked();
         void UpdateP1KeyboardSelectionLocked(const std::vector<HANDLE>& deviceHandles);
         bool IsP1KeyboardHandleLocked(HANDLE deviceHandle) const;
 
@@ -230,16 +246,21 @@ private:
         bool m_ControllerPosSwap = false;
         bool m_multipleKeyboardOverrideEnabled = false;
         ULONGLONG m_lastRefresh = 0;
-        size_t m_lastDeviceHash = 0;
         bool m_steamInputLikely = false;
-        std::atomic<bool> m_deviceChangeQueued{ false };
+        std::atomic<bool> m_deviceSnapshotReady{ false };
         std::atomic<bool> m_mappingPopupActive{ false };
 
         std::vector<IDirectInputDevice8A*> m_trackedDevicesA;
         std::vector<IDirectInputDevice8W*> m_trackedDevicesW;
         std::vector<KeyboardDeviceInfo> m_allKeyboardDevices;
         std::vector<KeyboardDeviceInfo> m_keyboardDevices;
-        std::unordered_map<HANDLE, std::array<BYTE, 256>> m_keyboardStates;
+        KeyboardStateSlot m_keyboardSlots[KEYBOARD_STATE_SLOTS];
+        // Bit per m_keyboardSlots index of the P1 keyboards, what GetFilteredKeyboardState merges.
+        std::atomic<uint32_t> m_p1KeyboardSlotMask{ 0 };
+        // Double buffered, m_keyboardBindingsVersion & 1 is the one the input path reads and the
+        // rebuild writes the other. A reader that sees the version move while reading retries.
+        KeyboardBindingTables m_keyboardBindings[2];
+        std::atomic<uint32_t> m_keyboardBindingsVersion{ 0 };
         std::vector<HANDLE> m_p1KeyboardHandles;
         std::unordered_set<HANDLE> m_p1KeyboardHandleSet;
         std::vector<std::string> m_p1KeyboardDeviceIds;
@@ -251,6 +272,15 @@ private:
         mutable std::mutex m_deviceMutex;
         mutable std::mutex m_keyboardMutex;
 
+        // Device enumeration thread, started by the first device change
+        std::thread m_enumerationThread;
+        std::mutex m_enumerationMutex;
+        std::condition_variable m_enumerationCondition;
+        bool m_enumerationRequested = false;
+        bool m_forceReinitializeRequested = false;
+        bool m_enumerationStopRequested = false;
+        std::shared_ptr<const DeviceSnapshot> m_pendingSnapshot;
+
         // Desired packed input words seen by the system controllers, for P2.
         std::atomic<uint32_t> m_p2MenuSystemInputWord{ 0 };
         std::atomic<uint32_t> m_p2CharSystemInputWord{ 0 };
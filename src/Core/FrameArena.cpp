@@ -0,0 +1,35 @@
+#include "FrameArena.h"
+
+FrameArena::FrameArena(size_t capacity)
+	: m_block(new char[capacity]), m_capacity(capacity)
+{
+}
+
+FrameArena::~FrameArena()
+{
+	delete[] m_block;
+}
+
+void FrameArena::Reset()
+{
+	m_used = 0;
+	m_failedCount = 0;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	uintptr_t base = (uintptr_t)m_block;
+	uintptr_t start = (base + m_used + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	if (start - base > m_capacity || size > m_capacity - (start - base))
+	{
+		m_failedCount++;
+		return nullptr;
+	}
+
+	m_used = start - base + size;
+	if (m_used > m_peak)
+	{
+		m_peak = m_used;
+	}
+	return (void*)start;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Bump allocator for scratch memory that only lives for one rendered frame. The block is allocated once, Reset gives all of it
+// back at the start of the next frame, so the windows using it don't touch the heap while drawing. Render thread only.
+class FrameArena
+{
+public:
+	explicit FrameArena(size_t capacity);
+	~FrameArena();
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void Reset();
+	// Returns nullptr when the block is full, callers draw less instead of allocating
+	void* Allocate(size_t size, size_t alignment = 16);
+
+	// Uninitialized, T has to be trivial
+	template <typename T>
+	T* AllocateArray(size_t count)
+	{
+		return static_cast<T*>(Allocate(count * sizeof(T), alignof(T) > 16 ? alignof(T) : 16));
+	}
+
+	size_t GetCapacity() const { return m_capacity; }
+	size_t GetUsed() const { return m_used; }
+	size_t GetPeak() const { return m_peak; } //highest usage of any frame, to size the block
+	unsigned int GetFailedCount() const { return m_failedCount; } //allocations that didn't fit this frame
+
+private:
+	char* m_block;
+	size_t m_capacity;
+	size_t m_used = 0;
+	size_t m_peak = 0;
+	unsigned int m_failedCount = 0;
+};
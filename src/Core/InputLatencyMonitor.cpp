@@ -0,0 +1,392 @@
+#include "InputLatencyMonitor.h"
+
+#include "logger.h"
+#include "Settings.h"
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#define INPUT_LATENCY_FOLDER_PATH "BBCF_IM\\latency"
+
+namespace
+{
+	const double PENDING_TIMEOUT_MS = 200.0;
+	const uint16_t PACKED_DIRECTION_MASK = 0x000F;
+	const uint16_t PACKED_DIRECTION_NEUTRAL = 5;
+
+	const char* const sourceNames[InputLatencySource_Count] = { "rawinput", "wndmsg" };
+
+	int64_t Now()
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return counter.QuadPart;
+	}
+
+	// A release doesn't mean a press got through, only a new button or a direction away from neutral does
+	bool IsNewPress(uint16_t previous, uint16_t current)
+	{
+		const uint16_t direction = current & PACKED_DIRECTION_MASK;
+		const uint16_t newButtons = (current & ~PACKED_DIRECTION_MASK) & ~(previous & ~PACKED_DIRECTION_MASK);
+		return newButtons != 0 || (direction != (previous & PACKED_DIRECTION_MASK) && direction != PACKED_DIRECTION_NEUTRAL);
+	}
+
+	double Percentile(const uint32_t* histogram, uint32_t total, double fraction)
+	{
+		if (!total)
+		{
+			return 0.0;
+		}
+		const uint32_t rank = (uint32_t)(total * fraction + 0.999999);
+		uint32_t seen = 0;
+		for (int i = 0; i < INPUT_LATENCY_BUCKETS; i++)
+		{
+			seen += histogram[i];
+			if (seen >= rank)
+			{
+				return (i + 1) * INPUT_LATENCY_BUCKET_MS;
+			}
+		}
+		return INPUT_LATENCY_BUCKETS * INPUT_LATENCY_BUCKET_MS;
+	}
+}
+
+InputLatencyMonitor& InputLatencyMonitor::GetInstance()
+{
+	static InputLatencyMonitor instance;
+	return instance;
+}
+
+InputLatencyMonitor::InputLatencyMonitor()
+	: m_enabled(false)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	m_frequency = frequency.QuadPart;
+	for (uint32_t i = 0; i < PRESS_RING_SIZE; i++)
+	{
+		m_pressPolled[i].store(0, std::memory_order_relaxed);
+	}
+	Reset();
+}
+
+void InputLatencyMonitor::SetEnabled(bool enabled)
+{
+	m_clearRequested.store(true, std::memory_order_release);
+	m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void InputLatencyMonitor::Reset()
+{
+	m_clearRequested.store(true, std::memory_order_release);
+	for (int source = 0; source < InputLatencySource_Count; source++)
+	{
+		for (int i = 0; i < INPUT_LATENCY_BUCKETS; i++)
+		{
+			m_histogram[source][i].store(0, std::memory_order_relaxed);
+		}
+		m_expired[source].store(0, std::memory_order_relaxed);
+		m_maxTicks[source].store(0, std::memory_order_relaxed);
+	}
+	m_eventsCleared.store(m_eventsWritten.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void InputLatencyMonitor::OnKeyPressed(InputLatencySource source, int player, uint8_t virtualKey)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	const int64_t pressed = Now();
+	const uint32_t sequence = m_pressesWritten.fetch_add(1, std::memory_order_acq_rel);
+	PressSlot& slot = m_presses[sequence & (PRESS_RING_SIZE - 1)];
+
+	// Same as the battle input queue, the hook sees the marker or the new sequence once the press is complete
+	slot.sequence.store(UINT32_MAX, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.press.pressed = pressed;
+	slot.press.sequence = sequence;
+	slot.press.source = source;
+	slot.press.player = (int8_t)player;
+	slot.press.virtualKey = virtualKey;
+	slot.press.vsync = Settings::settingsIni.vsync;
+	slot.sequence.store(sequence, std::memory_order_release);
+}
+
+void InputLatencyMonitor::OnKeyboardPolled()
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	// Stamps the presses that came in since the last poll, this poll is the first one that could see them
+	const uint32_t written = m_pressesWritten.load(std::memory_order_acquire);
+	uint32_t polled = m_pressesPolled.load(std::memory_order_relaxed);
+	if (polled == written)
+	{
+		return;
+	}
+	if (written - polled > PRESS_RING_SIZE)
+	{
+		polled = written - PRESS_RING_SIZE;
+	}
+
+	const int64_t now = Now();
+	for (; polled != written; polled++)
+	{
+		m_pressPolled[polled & (PRESS_RING_SIZE - 1)].store(now, std::memory_order_relaxed);
+	}
+	m_pressesPolled.store(written, std::memory_order_release);
+}
+
+void InputLatencyMonitor::OnBattleInputWritten(uint32_t player, uint16_t packedInput)
+{
+	if (!IsEnabled() || player > 1)
+	{
+		return;
+	}
+
+	const int64_t now = Now();
+	TakePresses(now);
+
+	const bool pressed = m_hasLastPacked[player] && IsNewPress(m_lastPacked[player], packedInput);
+	m_lastPacked[player] = packedInput;
+	m_hasLastPacked[player] = true;
+	if (!pressed)
+	{
+		return;
+	}
+
+	// Everything pressed for this side since the last change is in this write, if it counts for the battle at all
+	int kept = 0;
+	for (int i = 0; i < m_pendingCount; i++)
+	{
+		const PendingPress& press = m_pending[i];
+		if (press.player < 0 || press.player == (int)player)
+		{
+			Record(press, now);
+		}
+		else
+		{
+			m_pending[kept++] = press;
+		}
+	}
+	m_pendingCount = kept;
+}
+
+void InputLatencyMonitor::TakePresses(int64_t now)
+{
+	if (m_clearRequested.exchange(false, std::memory_order_acq_rel))
+	{
+		m_pendingCount = 0;
+		m_hasLastPacked[0] = m_hasLastPacked[1] = false;
+		m_pressesRead = m_pressesWritten.load(std::memory_order_acquire);
+	}
+
+	// Drops the ones that waited too long
+	int kept = 0;
+	for (int i = 0; i < m_pendingCount; i++)
+	{
+		if (TicksToMs(now - m_pending[i].pressed) > PENDING_TIMEOUT_MS)
+		{
+			m_expired[m_pending[i].source].fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			m_pending[kept++] = m_pending[i];
+		}
+	}
+	m_pendingCount = kept;
+
+	const uint32_t written = m_pressesWritten.load(std::memory_order_acquire);
+	if (written - m_pressesRead > PRESS_RING_SIZE)
+	{
+		// Out of battle nothing takes the presses, the ones the window wrote over never had a battle input to reach
+		m_pressesRead = written - PRESS_RING_SIZE;
+	}
+
+	while (m_pressesRead != written)
+	{
+		const PressSlot& slot = m_presses[m_pressesRead & (PRESS_RING_SIZE - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != m_pressesRead)
+		{
+			// Still being written, the next write takes it
+			break;
+		}
+		const PendingPress press = slot.press;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != m_pressesRead)
+		{
+			break;
+		}
+		m_pressesRead++;
+
+		if (TicksToMs(now - press.pressed) > PENDING_TIMEOUT_MS)
+		{
+			m_expired[press.source].fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+		if (m_pendingCount == MAX_PENDING)
+		{
+			m_expired[m_pending[0].source].fetch_add(1, std::memory_order_relaxed);
+			memmove(m_pending, m_pending + 1, (MAX_PENDING - 1) * sizeof(PendingPress));
+			m_pendingCount--;
+		}
+		m_pending[m_pendingCount++] = press;
+	}
+}
+
+void InputLatencyMonitor::Record(const PendingPress& press, int64_t consumed)
+{
+	const int64_t ticks = consumed - press.pressed;
+	int bucket = (int)(TicksToMs(ticks) / INPUT_LATENCY_BUCKET_MS);
+	if (bucket >= INPUT_LATENCY_BUCKETS)
+	{
+		bucket = INPUT_LATENCY_BUCKETS - 1;
+	}
+	m_histogram[press.source][bucket < 0 ? 0 : bucket].fetch_add(1, std::memory_order_relaxed);
+	if (ticks > m_maxTicks[press.source].load(std::memory_order_relaxed))
+	{
+		m_maxTicks[press.source].store(ticks, std::memory_order_relaxed);
+	}
+
+	// The poll stamp of this press, unless the keyboard wasn't read since it or the ring went past it
+	int64_t polled = 0;
+	const uint32_t pollsWritten = m_pressesPolled.load(std::memory_order_acquire);
+	if ((int32_t)(pollsWritten - press.sequence) > 0 && pollsWritten - press.sequence <= PRESS_RING_SIZE)
+	{
+		polled = m_pressPolled[press.sequence & (PRESS_RING_SIZE - 1)].load(std::memory_order_relaxed);
+		if (polled < press.pressed)
+		{
+			polled = 0;
+		}
+	}
+
+	const uint32_t sequence = m_eventsWritten.load(std::memory_order_relaxed);
+	EventSlot& slot = m_events[sequence & (INPUT_LATENCY_EVENTS - 1)];
+	slot.sequence.store(UINT32_MAX, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.event.pressed = press.pressed;
+	slot.event.polled = polled;
+	slot.event.consumed = consumed;
+	slot.event.source = press.source;
+	slot.event.player = press.player;
+	slot.event.virtualKey = press.virtualKey;
+	slot.event.vsync = press.vsync;
+	slot.sequence.store(sequence, std::memory_order_release);
+	m_eventsWritten.store(sequence + 1, std::memory_order_release);
+}
+
+InputLatencyStats InputLatencyMonitor::GetStats(InputLatencySource source) const
+{
+	uint32_t histogram[INPUT_LATENCY_BUCKETS];
+	InputLatencyStats stats = {};
+	for (int i = 0; i < INPUT_LATENCY_BUCKETS; i++)
+	{
+		histogram[i] = m_histogram[source][i].load(std::memory_order_relaxed);
+		stats.matched += histogram[i];
+	}
+	stats.expired = m_expired[source].load(std::memory_order_relaxed);
+	stats.max = TicksToMs(m_maxTicks[source].load(std::memory_order_relaxed));
+	// The buckets only give an upper bound
+	stats.p50 = (std::min)(Percentile(histogram, stats.matched, 0.50), stats.max);
+	stats.p95 = (std::min)(Percentile(histogram, stats.matched, 0.95), stats.max);
+	stats.p99 = (std::min)(Percentile(histogram, stats.matched, 0.99), stats.max);
+	return stats;
+}
+
+int InputLatencyMonitor::GetHistogram(float* out, int count) const
+{
+	int used = 0;
+	for (int i = 0; i < count && i < INPUT_LATENCY_BUCKETS; i++)
+	{
+		uint32_t total = 0;
+		for (int source = 0; source < InputLatencySource_Count; source++)
+		{
+			total += m_histogram[source][i].load(std::memory_order_relaxed);
+		}
+		out[i] = (float)total;
+		if (total)
+		{
+			used = i + 1;
+		}
+	}
+	return used;
+}
+
+size_t InputLatencyMonitor::GetEventCount() const
+{
+	const uint32_t written = m_eventsWritten.load(std::memory_order_acquire);
+	const uint32_t kept = written - m_eventsCleared.load(std::memory_order_acquire);
+	return (std::min)(kept, INPUT_LATENCY_EVENTS);
+}
+
+void InputLatencyMonitor::GetEvents(std::vector<InputLatencyEvent>& out) const
+{
+	out.clear();
+	const uint32_t written = m_eventsWritten.load(std::memory_order_acquire);
+	uint32_t sequence = m_eventsCleared.load(std::memory_order_acquire);
+	if (written - sequence > INPUT_LATENCY_EVENTS)
+	{
+		sequence = written - INPUT_LATENCY_EVENTS;
+	}
+	out.reserve(written - sequence);
+
+	for (; sequence != written; sequence++)
+	{
+		const EventSlot& slot = m_events[sequence & (INPUT_LATENCY_EVENTS - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != sequence)
+		{
+			continue;
+		}
+		const InputLatencyEvent event = slot.event;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		// Written over by the hook while it was copied
+		if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+		{
+			out.push_back(event);
+		}
+	}
+}
+
+std::string InputLatencyMonitor::ExportCsv() const
+{
+	std::vector<InputLatencyEvent> events;
+	GetEvents(events);
+
+	CreateDirectoryA(INPUT_LATENCY_FOLDER_PATH, NULL);
+	char fileName[64];
+	time_t now = time(nullptr);
+	strftime(fileName, sizeof(fileName), "input_latency_%Y%m%d_%H%M%S.csv", localtime(&now));
+	const std::string path = std::string(INPUT_LATENCY_FOLDER_PATH) + "\\" + fileName;
+
+	FILE* file = fopen(path.c_str(), "w");
+	if (!file)
+	{
+		LOG(2, "InputLatencyMonitor::ExportCsv couldn't create %s\n", path.c_str());
+		return std::string();
+	}
+
+	fprintf(file, "index,source,player,virtual_key,vsync,pressed_ms,press_to_poll_ms,press_to_consume_ms\n");
+	const int64_t origin = events.empty() ? 0 : events.front().pressed;
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		const InputLatencyEvent& event = events[i];
+		fprintf(file, "%u,%s,%d,%u,%d,%.3f,", (unsigned)i, sourceNames[event.source], event.player,
+			event.virtualKey, event.vsync ? 1 : 0, TicksToMs(event.pressed - origin));
+		if (event.polled)
+		{
+			fprintf(file, "%.3f", TicksToMs(event.polled - event.pressed));
+		}
+		fprintf(file, ",%.3f\n", TicksToMs(event.consumed - event.pressed));
+	}
+	fclose(file);
+	LOG(2, "InputLatencyMonitor::ExportCsv %u events to %s\n", (unsigned)events.size(), path.c_str());
+	return path;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum InputLatencySource : uint8_t
+{
+	InputLatencySource_RawInput,      //keyboard separation on, WM_INPUT
+	InputLatencySource_WindowMessage, //keyboard separation off, WM_KEYDOWN
+	InputLatencySource_Count
+};
+
+const int INPUT_LATENCY_BUCKETS = 400;
+const double INPUT_LATENCY_BUCKET_MS = 0.25; //the last bucket also holds everything slower
+const uint32_t INPUT_LATENCY_EVENTS = 16384; //kept for the export, power of two
+
+// One key press matched to the first battle input write that changed after it, QPC ticks
+struct InputLatencyEvent
+{
+	int64_t pressed;
+	int64_t polled; //first GetKeyboardState of the game after the press, 0 if it never read the keyboard
+	int64_t consumed;
+	uint8_t source;
+	int8_t player; //-1 when the press can't be tied to a side
+	uint8_t virtualKey;
+	bool vsync;
+};
+
+struct InputLatencyStats
+{
+	uint32_t matched;
+	uint32_t expired; //presses that no battle input write picked up in time
+	double p50;
+	double p95;
+	double p99;
+	double max;
+};
+
+// Measures how long a key press takes to reach the battle input the game reads. Presses are stamped with QPC when the
+// window gets them, the first change of that side's battle input after it consumes them. Only does anything while it's
+// enabled, the input paths check one atomic otherwise.
+// Nothing here locks or allocates: the presses go through a fixed ring to the battle input hook, which matches them and
+// writes the results into another fixed ring, the last INPUT_LATENCY_EVENTS of them are kept.
+class InputLatencyMonitor
+{
+public:
+	static InputLatencyMonitor& GetInstance();
+
+	void SetEnabled(bool enabled);
+	bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+	void Reset();
+
+	void OnKeyPressed(InputLatencySource source, int player, uint8_t virtualKey);
+	void OnKeyboardPolled();
+	void OnBattleInputWritten(uint32_t player, uint16_t packedInput);
+
+	InputLatencyStats GetStats(InputLatencySource source) const;
+	// Counts per INPUT_LATENCY_BUCKET_MS of every source, returns the number of buckets up to the slowest press
+	int GetHistogram(float* out, int count) const;
+	size_t GetEventCount() const;
+	double TicksToMs(int64_t ticks) const { return ticks * 1000.0 / m_frequency; }
+
+	// Copies the events kept since the last reset, oldest first
+	void GetEvents(std::vector<InputLatencyEvent>& out) const;
+	// Writes the events kept since the last reset to BBCF_IM/latency, returns the path or an empty string
+	std::string ExportCsv() const;
+
+private:
+	InputLatencyMonitor();
+
+	struct PendingPress
+	{
+		int64_t pressed;
+		uint32_t sequence; //in the press ring, finds its poll time
+		uint8_t source;
+		int8_t player;
+		uint8_t virtualKey;
+		bool vsync;
+	};
+
+	struct PressSlot
+	{
+		std::atomic<uint32_t> sequence{ UINT32_MAX }; //UINT32_MAX while it's written
+		PendingPress press;
+	};
+
+	struct EventSlot
+	{
+		std::atomic<uint32_t> sequence{ UINT32_MAX };
+		InputLatencyEvent event;
+	};
+
+	// Battle input hook only
+	void TakePresses(int64_t now);
+	void Record(const PendingPress& press, int64_t consumed);
+
+	static const uint32_t PRESS_RING_SIZE = 64; //power of two
+	static const int MAX_PENDING = 32;
+
+	std::atomic<bool> m_enabled;
+	int64_t m_frequency;
+
+	// Written by the window message thread, read by the battle input hook
+	PressSlot m_presses[PRESS_RING_SIZE];
+	std::atomic<uint32_t> m_pressesWritten{ 0 };
+	// Written by the keyboard poll, the first poll after each press
+	std::atomic<int64_t> m_pressPolled[PRESS_RING_SIZE];
+	std::atomic<uint32_t> m_pressesPolled{ 0 };
+
+	// Battle input hook only
+	uint32_t m_pressesRead = 0;
+	PendingPress m_pending[MAX_PENDING];
+	int m_pendingCount = 0;
+	uint16_t m_lastPacked[2];
+	bool m_hasLastPacked[2];
+	std::atomic<bool> m_clearRequested{ false }; //drops the presses the hook holds, set by Reset and SetEnabled
+
+	// Written by the battle input hook, read by the UI. Reset zeroes them from the UI thread, a press recorded meanwhile
+	// can survive it, which only matters for that one press.
+	std::atomic<uint32_t> m_histogram[InputLatencySource_Count][INPUT_LATENCY_BUCKETS];
+	std::atomic<uint32_t> m_expired[InputLatencySource_Count];
+	std::atomic<int64_t> m_maxTicks[InputLatencySource_Count];
+	EventSlot m_events[INPUT_LATENCY_EVENTS];
+	std::atomic<uint32_t> m_eventsWritten{ 0 };
+	std::atomic<uint32_t> m_eventsCleared{ 0 }; //m_eventsWritten at the last reset
+};
@@ -0,0 +1,159 @@
+#include "KeyboardBindings.h"
+
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+        int LowestSetBit(uint32_t value)
+        {
+#ifdef _MSC_VER
+                unsigned long bit;
+                _BitScanForward(&bit, value);
+                return static_cast<int>(bit);
+#else
+                return __builtin_ctz(value);
+#endif
+        }
+
+        void ApplyActionToState(InputAction action, InputState& state)
+        {
+                switch (action)
+                {
+                case InputAction::Up: state.up = true; break;
+                case InputAction::Down: state.down = true; break;
+                case InputAction::Left: state.left = true; break;
+                case InputAction::Right: state.right = true; break;
+                case InputAction::A: state.A = true; break;
+                case InputAction::B: state.B = true; break;
+                case InputAction::C: state.C = true; break;
+                case InputAction::D: state.D = true; break;
+                case InputAction::Taunt: state.taunt = true; break;
+                case InputAction::Special: state.special = true; break;
+                case InputAction::Fn1: state.fn1 = true; break;
+                case InputAction::Fn2: state.fn2 = true; break;
+                case InputAction::Start: state.start = true; break;
+                case InputAction::Select: state.select = true; break;
+                case InputAction::ResetPositions: state.resetPositions = true; break;
+                default: break;
+                }
+        }
+}
+
+// The compiled binding tables keep InputActions as one bit each, bit n is InputAction n
+uint16_t InputActionsToMask(const std::vector<InputAction>& actions)
+{
+        uint16_t mask = 0;
+        for (InputAction action : actions)
+        {
+                mask |= static_cast<uint16_t>(1u << static_cast<int>(action));
+        }
+        return mask;
+}
+
+InputState ActionMaskToState(uint16_t actions)
+{
+        InputState state{};
+        for (int action = 0; (actions >> action) != 0; ++action)
+        {
+                if ((actions >> action) & 1)
+                {
+                        ApplyActionToState(static_cast<InputAction>(action), state);
+                }
+        }
+        return state;
+}
+
+std::vector<InputAction> MenuActionToInputActions(MenuAction action)
+{
+        switch (action)
+        {
+        case MenuAction::Up: return { InputAction::Up };
+        case MenuAction::Down: return { InputAction::Down };
+        case MenuAction::Left: return { InputAction::Left };
+        case MenuAction::Right: return { InputAction::Right };
+        case MenuAction::PlayerInfo: return { InputAction::A };
+        case MenuAction::FriendFilter: return { InputAction::B };
+        case MenuAction::ReturnAction: return { InputAction::C };
+        case MenuAction::Confirm: return { InputAction::D };
+        case MenuAction::ChangeCategory: return { InputAction::Taunt };
+        case MenuAction::ReplayControls: return { InputAction::Special };
+        case MenuAction::ChangeCategory2: return { InputAction::Fn1 };
+        case MenuAction::ReplayControls2: return { InputAction::Fn2 };
+        default: return {};
+        }
+}
+
+std::vector<InputAction> BattleActionToInputActions(BattleAction action)
+{
+        switch (action)
+        {
+        case BattleAction::Up: return { InputAction::Up };
+        case BattleAction::Down: return { InputAction::Down };
+        case BattleAction::Left: return { InputAction::Left };
+        case BattleAction::Right: return { InputAction::Right };
+        case BattleAction::A: return { InputAction::A };
+        case BattleAction::B: return { InputAction::B };
+        case BattleAction::C: return { InputAction::C };
+        case BattleAction::D: return { InputAction::D };
+        case BattleAction::Taunt: return { InputAction::Taunt };
+        case BattleAction::Special: return { InputAction::Special };
+        case BattleAction::MacroAB: return { InputAction::A, InputAction::B };
+        case BattleAction::MacroBC: return { InputAction::B, InputAction::C };
+        case BattleAction::MacroABC: return { InputAction::A, InputAction::B, InputAction::C };
+        case BattleAction::MacroABCD: return { InputAction::A, InputAction::B, InputAction::C, InputAction::D };
+        case BattleAction::MacroFn1: return { InputAction::Fn1 };
+        case BattleAction::MacroFn2: return { InputAction::Fn2 };
+        case BattleAction::MacroResetPositions: return { InputAction::ResetPositions };
+        default: return {};
+        }
+}
+
+void CompileKeyboardMapping(const KeyboardMapping& mapping, KeyboardBindingTable& table)
+{
+        memset(table.battle, 0, sizeof(table.battle));
+        memset(table.menu, 0, sizeof(table.menu));
+
+        for (const auto& kvp : mapping.battleBindings)
+        {
+                const uint16_t actions = InputActionsToMask(BattleActionToInputActions(kvp.first));
+                for (uint32_t vk : kvp.second)
+                {
+                        if (vk < 256)
+                        {
+                                table.battle[vk] |= actions;
+                        }
+                }
+        }
+
+        for (const auto& kvp : mapping.menuBindings)
+        {
+                const uint16_t actions = InputActionsToMask(MenuActionToInputActions(kvp.first));
+                for (uint32_t vk : kvp.second)
+                {
+                        if (vk < 256)
+                        {
+                                table.menu[vk] |= actions;
+                        }
+                }
+        }
+}
+
+// One lookup per pressed key of the keyboard
+void ResolveKeyBindings(const uint32_t (&keyBits)[8], const KeyboardBindingTable& table, uint16_t& battleActions, uint16_t& menuActions)
+{
+        for (int word = 0; word < 8; ++word)
+        {
+                uint32_t keys = keyBits[word];
+                while (keys != 0)
+                {
+                        const int vk = word * 32 + LowestSetBit(keys);
+                        battleActions |= table.battle[vk];
+                        menuActions |= table.menu[vk];
+                        keys &= keys - 1;
+                }
+        }
+}
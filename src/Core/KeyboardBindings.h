@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Hooks/hooks_battle_input.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// The keyboard bindings of the ControllerOverrideManager and the tables they compile to.
+// Nothing here needs Windows, tools/keyboard_bench builds it on its own.
+
+enum class MenuAction
+{
+        Up,
+        Down,
+        Left,
+        Right,
+        PlayerInfo,
+        FriendFilter,
+        ReturnAction,
+        Confirm,
+        ChangeCategory,
+        ReplayControls,
+        ChangeCategory2,
+        ReplayControls2,
+};
+
+enum class BattleAction
+{
+        Up,
+        Down,
+        Left,
+        Right,
+        A,
+        B,
+        C,
+        D,
+        Taunt,
+        Special,
+        MacroAB,
+        MacroBC,
+        MacroABC,
+        MacroABCD,
+        MacroFn1,
+        MacroFn2,
+        MacroResetPositions,
+};
+
+struct KeyboardMapping
+{
+        std::map<MenuAction, std::vector<uint32_t>> menuBindings;
+        std::map<BattleAction, std::vector<uint32_t>> battleBindings;
+
+        static KeyboardMapping CreateDefault();
+};
+
+// What the bindings press once resolved, InputAction n is bit n of the compiled tables
+enum class InputAction
+{
+        Up,
+        Down,
+        Left,
+        Right,
+        A,
+        B,
+        C,
+        D,
+        Taunt,
+        Special,
+        Fn1,
+        Fn2,
+        Start,
+        Select,
+        ResetPositions,
+};
+
+// A KeyboardMapping compiled for one keyboard: the InputAction bits each virtual key sets,
+// so resolving a keyboard is one lookup per pressed key instead of walking its bindings.
+struct KeyboardBindingTable
+{
+        void* deviceHandle = nullptr; // raw input HANDLE of the keyboard
+        bool ignored = false;
+        uint16_t battle[256] = {};
+        uint16_t menu[256] = {};
+};
+
+std::vector<InputAction> MenuActionToInputActions(MenuAction action);
+std::vector<InputAction> BattleActionToInputActions(BattleAction action);
+
+uint16_t InputActionsToMask(const std::vector<InputAction>& actions);
+InputState ActionMaskToState(uint16_t actions);
+
+// Every key bound to an action gets the action's InputAction bits, macros already expanded
+void CompileKeyboardMapping(const KeyboardMapping& mapping, KeyboardBindingTable& table);
+
+// ORs the InputAction bits of every pressed key of keyBits (one bit per virtual key) into battleActions and menuActions
+void ResolveKeyBindings(const uint32_t (&keyBits)[8], const KeyboardBindingTable& table, uint16_t& battleActions, uint16_t& menuActions);
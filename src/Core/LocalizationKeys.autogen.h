@@ -650,6 +650,78 @@ struct LocalizationKeysAccessor
 
         // To force enable these hooks, set ForceEnableControllerSettingHooks to 1 at your own risk.
         inline const char* To_force_enable_these_hooks_set_ForceEnableControllerSettingHooks_to_1_at_your_own_risk() const { return Get("To force enable these hooks, set ForceEnableControllerSettingHooks to 1 at your own risk."); }
+
+        // FrameHistory depth label
+        inline const char* FrameHistory_depth_label() const { return Get("FrameHistory depth label"); }
+
+        // FrameHistory log start
+        inline const char* FrameHistory_log_start() const { return Get("FrameHistory log start"); }
+
+        // FrameHistory log stop
+        inline const char* FrameHistory_log_stop() const { return Get("FrameHistory log stop"); }
+
+        // FrameHistory log help
+        inline const char* FrameHistory_log_help() const { return Get("FrameHistory log help"); }
+
+        // FrameHistory log size
+        inline const char* FrameHistory_log_size() const { return Get("FrameHistory log size"); }
+
+        // FrameHistory log create error
+        inline const char* FrameHistory_log_create_error() const { return Get("FrameHistory log create error"); }
+
+        // FrameHistory refresh logs
+        inline const char* FrameHistory_refresh_logs() const { return Get("FrameHistory refresh logs"); }
+
+        // FrameHistory review log
+        inline const char* FrameHistory_review_log() const { return Get("FrameHistory review log"); }
+
+        // FrameHistory log load error
+        inline const char* FrameHistory_log_load_error() const { return Get("FrameHistory log load error"); }
+
+        // FrameHistory log frame label
+        inline const char* FrameHistory_log_frame_label() const { return Get("FrameHistory log frame label"); }
+
+        // FrameHistory log game frames
+        inline const char* FrameHistory_log_game_frames() const { return Get("FrameHistory log game frames"); }
+
+        // FrameHistory back to live
+        inline const char* FrameHistory_back_to_live() const { return Get("FrameHistory back to live"); }
+
+        // FrameHistory hit label
+        inline const char* FrameHistory_hit_label() const { return Get("FrameHistory hit label"); }
+
+        // FrameHistory miss gap
+        inline const char* FrameHistory_miss_gap() const { return Get("FrameHistory miss gap"); }
+
+        // Draw hit prediction
+        inline const char* Draw_hit_prediction() const { return Get("Draw hit prediction"); }
+
+        // Hit prediction help
+        inline const char* Hit_prediction_help() const { return Get("Hit prediction help"); }
+
+        // Draw hitbox trail
+        inline const char* Draw_hitbox_trail() const { return Get("Draw hitbox trail"); }
+
+        // Hitbox trail help
+        inline const char* Hitbox_trail_help() const { return Get("Hitbox trail help"); }
+
+        // Trail frames
+        inline const char* Trail_frames() const { return Get("Trail frames"); }
+
+        // Record trace
+        inline const char* Record_trace() const { return Get("Record trace"); }
+
+        // Stop trace
+        inline const char* Stop_trace() const { return Get("Stop trace"); }
+
+        // Trace create error
+        inline const char* Trace_create_error() const { return Get("Trace create error"); }
+
+        // Trace help
+        inline const char* Trace_help() const { return Get("Trace help"); }
+
+        // Trace size
+        inline const char* Trace_size() const { return Get("Trace size"); }
 };
 
 
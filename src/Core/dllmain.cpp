@@ -81,6 +81,8 @@ void BBCF_IM_Shutdown()
         LOG(1, "BBCF_IM_Shutdown\n");
 
         WindowManager::GetInstance().Shutdown();
+        // Under the loader lock, the thread was joined on WM_DESTROY unless the game went away without closing its window
+        ControllerOverrideManager::GetInstance().Shutdown(false);
         CleanupInterfaces();
         closeLogger();
 }
@@ -202,6 +204,16 @@ DWORD WINAPI BBCF_IM_Start(HMODULE hModule)
 
 	g_interfaces.pPaletteManager = new PaletteManager();
 	ForceLog("[Init] PaletteManager constructed.\n");
+
+	g_interfaces.pFrameDataDB = new FrameDataDB();
+	if (g_interfaces.pFrameDataDB->Open(FRAME_DATA_DB_PATH))
+	{
+		ForceLog("[Init] Frame data database mapped, %u characters.\n", g_interfaces.pFrameDataDB->GetCharacterCount());
+	}
+	else
+	{
+		LOG(2, "BBCF_IM_Start: %s missing or outdated; frame data database disabled.\n", FRAME_DATA_DB_PATH);
+	}
 }
 	catch (const std::exception& ex)
 	{
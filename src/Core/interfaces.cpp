@@ -83,6 +83,7 @@ void CleanupInterfaces()
 	SAFE_DELETE(g_interfaces.pOnlinePaletteManager);
 	SAFE_DELETE(g_interfaces.pOnlineGameModeManager);
 	SAFE_DELETE(g_interfaces.pGameModeManager);
+	SAFE_DELETE(g_interfaces.pFrameDataDB);
 
 	SAFE_DELETE(g_interfaces.pD3D9ExWrapper);
 
@@ -6,6 +6,7 @@
 #include "Game/Player.h"
 #include "Game/Room/Room.h"
 #include "Game/ReplayRewind/ReplayRewind.h"
+#include "Game/Scr/FrameDataDB.h"
 
 #include "Network/NetworkManager.h"
 #include "Network/OnlineGameModeManager.h"
@@ -45,6 +46,8 @@ struct interfaces_t
 	ReplayUploadManager* pReplayUploadManager;
 	ReplayRewind* pReplayRewindManager;
 
+	FrameDataDB* pFrameDataDB;
+
 	Player player1;
 	Player player2;
 };
@@ -92,6 +95,7 @@ struct gameVals_t
 
 	int* pEntityList;
 	int entityCount;
+	unsigned int entityListGeneration; //bumped by the hooks whenever the game allocates or frees the entity list
 
 
 	Room* pRoom;
@@ -117,6 +121,7 @@ struct modValues_t {
 	float frame_history_width;
 	float frame_history_height;
 	float frame_history_spacing;
+	int frame_history_depth;
 };
 //temporary placeholders until wrappers are created / final addresses updated
 struct temps_t
@@ -0,0 +1,193 @@
+#include "EntityTracker.h"
+
+#include "Core/interfaces.h"
+
+#include <algorithm>
+#include <cstring>
+
+EntityTracker& EntityTracker::GetInstance()
+{
+	static EntityTracker instance;
+	return instance;
+}
+
+EntityTracker::EntityTracker()
+{
+	m_live.reserve(ENTITY_TRACKER_MAX_SLOTS);
+	m_spawned.reserve(ENTITY_TRACKER_MAX_SLOTS);
+	m_frameEvents.reserve(ENTITY_TRACKER_MAX_SLOTS * 2);
+}
+
+void EntityTracker::Update(unsigned int frame)
+{
+	m_frameEvents.clear();
+
+	const int* list = g_gameVals.pEntityList;
+	if (g_gameVals.entityListGeneration != m_generation || list != m_list)
+	{
+		// The old list may already be freed, only forget what was in it
+		Clear(frame);
+		m_generation = g_gameVals.entityListGeneration;
+		m_list = list;
+		m_hasLastFrame = false;
+	}
+	if (!list || !g_gameVals.pFrameCount)
+	{
+		return;
+	}
+	if (m_hasLastFrame && frame == m_lastFrame)
+	{
+		return;
+	}
+	m_hasLastFrame = true;
+	m_lastFrame = frame;
+
+	Diff(frame);
+}
+
+bool EntityTracker::IsLive(int slot) const
+{
+	if (slot < 0 || slot >= ENTITY_TRACKER_MAX_SLOTS)
+	{
+		return false;
+	}
+	return (m_liveBits[slot >> 5] >> (slot & 31)) & 1;
+}
+
+unsigned int EntityTracker::CountAnchored() const
+{
+	unsigned int count = 0;
+	for (uint16_t slot : m_live)
+	{
+		if (m_slots[slot].data->unknown_status2 == 2)
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+int EntityTracker::Subscribe(Listener listener)
+{
+	const int id = m_nextListenerId++;
+	m_listeners.push_back({ id, std::move(listener) });
+	return id;
+}
+
+void EntityTracker::Unsubscribe(int id)
+{
+	m_listeners.erase(std::remove_if(m_listeners.begin(), m_listeners.end(),
+		[id](const Subscription& subscription) { return subscription.id == id; }), m_listeners.end());
+}
+
+void EntityTracker::Clear(unsigned int frame)
+{
+	for (uint16_t slot : m_live)
+	{
+		Emit(EntityEventType::Despawn, m_slots[slot], frame, false);
+	}
+	memset(m_liveBits, 0, sizeof(m_liveBits));
+	m_live.clear();
+}
+
+void EntityTracker::Diff(unsigned int frame)
+{
+	const int* list = m_list;
+	const CharData* players[2] = { (const CharData*)list[0], (const CharData*)list[1] };
+	const int slotCount = std::min(g_gameVals.entityCount, ENTITY_TRACKER_MAX_SLOTS);
+	bool changed = false;
+	m_spawned.clear();
+
+	for (int i = 0; i < slotCount; i++)
+	{
+		const CharData* pEntity = (const CharData*)list[i];
+		const bool active = pEntity && pEntity->unknownStatus1 != 0;
+		const bool wasLive = IsLive(i);
+		TrackedEntity& entity = m_slots[i];
+
+		if (wasLive && (!active || entity.data != pEntity))
+		{
+			Emit(EntityEventType::Despawn, entity, frame, true);
+			m_liveBits[i >> 5] &= ~(1u << (i & 31));
+			changed = true;
+		}
+		if (active && (!wasLive || entity.data != pEntity))
+		{
+			entity.data = pEntity;
+			entity.slot = (uint16_t)i;
+			entity.spawn_frame = frame;
+			m_liveBits[i >> 5] |= 1u << (i & 31);
+			m_spawned.push_back((uint16_t)i);
+			changed = true;
+		}
+	}
+
+	if (!changed)
+	{
+		return;
+	}
+	RebuildLive();
+
+	// Owners are resolved after the pass so an entity can point at one spawned in a later slot on the same frame
+	for (uint16_t slot : m_spawned)
+	{
+		TrackedEntity& entity = m_slots[slot];
+		ResolveOwner(entity, players);
+		Emit(EntityEventType::Spawn, entity, frame, true);
+	}
+}
+
+void EntityTracker::RebuildLive()
+{
+	m_live.clear();
+	for (int word = 0; word < (int)(sizeof(m_liveBits) / sizeof(m_liveBits[0])); word++)
+	{
+		uint32_t bits = m_liveBits[word];
+		for (int bit = 0; bits; bit++, bits >>= 1)
+		{
+			if (bits & 1)
+			{
+				m_live.push_back((uint16_t)(word * 32 + bit));
+			}
+		}
+	}
+}
+
+void EntityTracker::ResolveOwner(TrackedEntity& entity, const CharData* players[2]) const
+{
+	const CharData* owner = entity.data->ownerEntity;
+	entity.owner_slot = -1;
+	for (uint16_t slot : m_live)
+	{
+		if (m_slots[slot].data == owner)
+		{
+			entity.owner_slot = (int16_t)slot;
+			break;
+		}
+	}
+
+	if (entity.slot < 2)
+	{
+		entity.side = (int8_t)entity.slot;
+	}
+	else
+	{
+		entity.side = owner == players[0] ? 0 : owner == players[1] ? 1 : -1;
+	}
+}
+
+void EntityTracker::Emit(EntityEventType type, const TrackedEntity& entity, unsigned int frame, bool keepData)
+{
+	EntityEvent event;
+	event.type = type;
+	event.slot = entity.slot;
+	event.side = entity.side;
+	event.frame = frame;
+	event.data = keepData ? entity.data : nullptr;
+	m_frameEvents.push_back(event);
+
+	for (auto& subscription : m_listeners)
+	{
+		subscription.listener(event);
+	}
+}
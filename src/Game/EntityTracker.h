@@ -0,0 +1,94 @@
+#pragma once
+#include "CharData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+constexpr int ENTITY_TRACKER_MAX_SLOTS = 252; //size of the game's entity list
+
+enum class EntityEventType : uint8_t
+{
+	Spawn,
+	Despawn,
+};
+
+struct EntityEvent
+{
+	EntityEventType type;
+	uint16_t slot; //index in g_gameVals.pEntityList
+	int8_t side; //player owning the entity, -1 if neither
+	unsigned int frame; //game frame the change was seen on
+	const CharData* data; //nullptr on the despawns sent when the game frees the entity list
+};
+
+struct TrackedEntity
+{
+	const CharData* data;
+	uint16_t slot;
+	int8_t side; //player owning the entity, -1 if neither
+	int16_t owner_slot; //slot of ownerEntity, -1 if it isn't a live entity
+	unsigned int spawn_frame;
+};
+
+/*Keeps the set of live entities so code looking at objects doesn't scan the whole entity list on its own.
+The entity list is preallocated by the game and its slots are reused, an entity is live while unknownStatus1 != 0.
+The GetEntityListAddr/GetEntityListDeleteAddr hooks bump g_gameVals.entityListGeneration when the game allocates or frees
+the list, the tracker then drops everything it knew without touching the old list. Spawns and despawns inside a list are
+found by comparing each slot once per game frame against the live bitset, and only that one pass reads the list.*/
+class EntityTracker
+{
+public:
+	typedef std::function<void(const EntityEvent&)> Listener;
+
+	static EntityTracker& GetInstance();
+
+	// Called on every FrameSnapshotCache capture, only diffs the list when the game frame or the list changed
+	void Update(unsigned int frame);
+
+	// Live entities in slot order, characters included
+	size_t GetLiveCount() const { return m_live.size(); }
+	const TrackedEntity& GetLive(size_t index) const { return m_slots[m_live[index]]; }
+	bool IsLive(int slot) const;
+	// nullptr if the slot isn't live
+	const TrackedEntity* Find(int slot) const { return IsLive(slot) ? &m_slots[slot] : nullptr; }
+	// Live entities with unknown_status2 == 2, the ones anchored to the character that spawned them
+	unsigned int CountAnchored() const;
+
+	// Spawns and despawns seen by the last Update
+	const std::vector<EntityEvent>& GetFrameEvents() const { return m_frameEvents; }
+	unsigned int GetListGeneration() const { return m_generation; }
+
+	// Listeners are called from Update, on the game thread, returns the id to unsubscribe with
+	int Subscribe(Listener listener);
+	void Unsubscribe(int id);
+
+private:
+	EntityTracker();
+
+	void Clear(unsigned int frame);
+	void Diff(unsigned int frame);
+	void RebuildLive();
+	void ResolveOwner(TrackedEntity& entity, const CharData* players[2]) const;
+	void Emit(EntityEventType type, const TrackedEntity& entity, unsigned int frame, bool keepData);
+
+	TrackedEntity m_slots[ENTITY_TRACKER_MAX_SLOTS];
+	uint32_t m_liveBits[(ENTITY_TRACKER_MAX_SLOTS + 31) / 32] = {};
+	std::vector<uint16_t> m_live;
+	std::vector<uint16_t> m_spawned; //scratch for the owner links of this frame's spawns
+	std::vector<EntityEvent> m_frameEvents;
+
+	struct Subscription
+	{
+		int id;
+		Listener listener;
+	};
+	std::vector<Subscription> m_listeners;
+	int m_nextListenerId = 1;
+
+	unsigned int m_generation = 0;
+	const int* m_list = nullptr;
+	bool m_hasLastFrame = false;
+	unsigned int m_lastFrame = 0;
+};
@@ -0,0 +1,148 @@
+#include "FrameSnapshot.h"
+
+#include "EntityTracker.h"
+#include "Core/interfaces.h"
+#include "Core/utils.h"
+
+#include <cstring>
+
+#define ASPECT_RATIO_MODE_OFFSET 0x65A5E4
+
+const EntitySnapshot* FrameSnapshot::FindEntity(int slot) const
+{
+	for (uint16_t i = 0; i < entity_count; i++)
+	{
+		if (entities[i].slot == slot)
+		{
+			return &entities[i];
+		}
+	}
+	return nullptr;
+}
+
+FrameSnapshotCache& FrameSnapshotCache::GetInstance()
+{
+	static FrameSnapshotCache instance;
+	return instance;
+}
+
+void FrameSnapshotCache::Capture()
+{
+	FrameSnapshot& snapshot = m_snapshot;
+	const bool hadFrame = snapshot.has_frame;
+	const unsigned int previousFrame = snapshot.frame;
+
+	snapshot.sequence++;
+	snapshot.has_frame = g_gameVals.pFrameCount != nullptr;
+	snapshot.frame = snapshot.has_frame ? *g_gameVals.pFrameCount : 0;
+	snapshot.frame_changed = snapshot.has_frame && (!hadFrame || snapshot.frame != previousFrame);
+	snapshot.game_state = g_gameVals.pGameState ? *g_gameVals.pGameState : 0;
+	snapshot.game_mode = g_gameVals.pGameMode ? *g_gameVals.pGameMode : 0;
+	snapshot.match_state = g_gameVals.pMatchState ? *g_gameVals.pMatchState : 0;
+	snapshot.match_timer = g_gameVals.pMatchTimer ? *g_gameVals.pMatchTimer : 0;
+	snapshot.match_rounds = g_gameVals.pMatchRounds ? *g_gameVals.pMatchRounds : 0;
+
+	CapturePlayer(0, g_interfaces.player1.IsCharDataNullPtr() ? nullptr : g_interfaces.player1.GetData());
+	CapturePlayer(1, g_interfaces.player2.IsCharDataNullPtr() ? nullptr : g_interfaces.player2.GetData());
+
+	snapshot.camera.valid = g_gameVals.viewMatrix && g_gameVals.projMatrix;
+	if (snapshot.camera.valid)
+	{
+		snapshot.camera.view = *g_gameVals.viewMatrix;
+		snapshot.camera.proj = *g_gameVals.projMatrix;
+	}
+	snapshot.camera.letterboxed = *(GetBbcfBaseAdress() + ASPECT_RATIO_MODE_OFFSET) == 1;
+
+	EntityTracker::GetInstance().Update(snapshot.frame);
+	CaptureEntities();
+}
+
+void FrameSnapshotCache::CapturePlayer(int index, const CharData* charObj)
+{
+	PlayerSnapshot& player = m_snapshot.players[index];
+	if (!charObj)
+	{
+		player = PlayerSnapshot();
+		return;
+	}
+	player.valid = true;
+	player.data = charObj;
+	player.char_index = charObj->charIndex;
+	memcpy(player.char_abbr, charObj->char_abbr, sizeof(player.char_abbr));
+	player.hp = charObj->currentHP;
+	player.max_hp = charObj->maxHP;
+	player.heat = charObj->heatMeter;
+	player.heat_gain_cooldown = charObj->heatGainCooldown;
+	player.barrier = charObj->barrier;
+	player.overdrive = charObj->overdriveMeter;
+	player.hitstun = charObj->hitstun;
+	player.blockstun = charObj->blockstun;
+	player.hit_count = charObj->hitCount;
+	player.state_changed_count = charObj->stateChangedCount;
+	player.combo_time = charObj->comboTime;
+	player.combo_proration = charObj->comboProration;
+	player.starter_rating = charObj->starterRating;
+	player.facing_left = charObj->facingLeft != 0;
+	memcpy(player.current_action, charObj->currentAction, sizeof(player.current_action));
+	player.current_action[sizeof(player.current_action) - 1] = 0;
+}
+
+void FrameSnapshotCache::CaptureEntities()
+{
+	m_snapshot.entity_count = 0;
+	if (!g_gameVals.pEntityList)
+	{
+		return;
+	}
+
+	const CharData* players[2] = { (const CharData*)g_gameVals.pEntityList[0], (const CharData*)g_gameVals.pEntityList[1] };
+	for (int i = 0; i < 2; i++)
+	{
+		if (players[i])
+		{
+			CaptureEntity(i, players[i], players);
+		}
+	}
+
+	// Only the live objects, in slot order like the list itself
+	const EntityTracker& tracker = EntityTracker::GetInstance();
+	for (size_t i = 0; i < tracker.GetLiveCount(); i++)
+	{
+		const TrackedEntity& tracked = tracker.GetLive(i);
+		const bool isEntityActive = tracked.data->unknownStatus1 == 1 && tracked.data->pJonbEntryBegin;
+		if (tracked.slot < 2 || !isEntityActive)
+		{
+			continue;
+		}
+		CaptureEntity(tracked.slot, tracked.data, players);
+	}
+}
+
+void FrameSnapshotCache::CaptureEntity(int slot, const CharData* pEntity, const CharData* players[2])
+{
+	const bool isCharacter = slot < 2;
+	EntitySnapshot& entity = m_snapshot.entities[m_snapshot.entity_count++];
+	entity.data = pEntity;
+	entity.slot = (uint16_t)slot;
+	entity.side = pEntity->ownerEntity == players[0] ? 0 : pEntity->ownerEntity == players[1] ? 1 : -1;
+	entity.flags = 0;
+	if (isCharacter)
+	{
+		entity.flags |= FrameSnapshotEntityFlags_Character;
+	}
+	if (pEntity->facingLeft)
+	{
+		entity.flags |= FrameSnapshotEntityFlags_FacingLeft;
+	}
+	const uint32_t stateFlags = pEntity->bitflags_for_curr_state_properties_or_smth & 0xF00;
+	if (stateFlags == 0x400 || stateFlags == 0x200)
+	{
+		entity.flags |= FrameSnapshotEntityFlags_HitboxesDisabled;
+	}
+	entity.pos_x = pEntity->position_x_dupe - pEntity->offsetX_1 + pEntity->offsetX_2;
+	entity.pos_y = pEntity->position_y_dupe + pEntity->offsetY_2;
+	entity.scale_x = pEntity->scaleX;
+	entity.scale_y = pEntity->scaleY;
+	entity.rotation = pEntity->rotationDegrees;
+	entity.boxes = JonbReader::getJonbEntries(pEntity);
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "CharData.h"
+#include "Jonb/JonbReader.h"
+
+#include <d3dx9.h>
+#include <cstdint>
+
+// Bump when a field changes meaning, code keeping snapshots around (traces, history) can tell them apart
+constexpr uint16_t FRAME_SNAPSHOT_VERSION = 1;
+constexpr int FRAME_SNAPSHOT_MAX_ENTITIES = 252; //size of the game's entity list
+
+enum FrameSnapshotEntityFlags_ : uint8_t
+{
+	FrameSnapshotEntityFlags_Character = 0x1,
+	FrameSnapshotEntityFlags_FacingLeft = 0x2,
+	FrameSnapshotEntityFlags_HitboxesDisabled = 0x4, //multihit/NoAttackDuringSprite(ID 2002) or AttackOff(ID 23027)
+};
+
+struct PlayerSnapshot
+{
+	bool valid = false;
+	const CharData* data = nullptr; //for fields not copied here, only valid during the frame it was captured in
+	int32_t char_index = 0;
+	char char_abbr[4] = {};
+	int32_t hp = 0;
+	int32_t max_hp = 0;
+	int32_t heat = 0;
+	int32_t heat_gain_cooldown = 0;
+	int32_t barrier = 0;
+	int32_t overdrive = 0;
+	int32_t hitstun = 0;
+	int32_t blockstun = 0;
+	int32_t hit_count = 0; //hits taken in the current combo
+	int32_t state_changed_count = 0; //incremented by the game on every action change
+	int32_t combo_time = 0;
+	int32_t combo_proration = 0;
+	int32_t starter_rating = 0;
+	bool facing_left = false;
+	char current_action[32] = {};
+};
+
+// The entities the hitbox overlay draws: both characters and every active object
+struct EntitySnapshot
+{
+	const CharData* data; //only valid during the frame it was captured in
+	uint16_t slot; //index in g_gameVals.pEntityList
+	int8_t side; //player owning the entity, -1 if neither
+	uint8_t flags; //FrameSnapshotEntityFlags_
+	int32_t pos_x, pos_y; //game units, same origin as the hitbox overlay
+	int32_t scale_x, scale_y; //1000 is 100%
+	int32_t rotation; //1/1000 degrees
+	JonbEntrySpan boxes;
+};
+
+struct CameraSnapshot
+{
+	bool valid = false;
+	D3DXMATRIX view;
+	D3DXMATRIX proj;
+	bool letterboxed = false; //the game keeps 5:3 with black bars instead of stretching
+};
+
+/*Everything the overlay windows read from game memory, copied once per rendered frame so the windows don't chase the
+same pointers each on their own and all of them see the same frame. Fields are left at their defaults when the game
+doesn't have them, check the valid flags instead of the game pointers.*/
+struct FrameSnapshot
+{
+	uint16_t version = FRAME_SNAPSHOT_VERSION;
+	uint32_t sequence = 0; //incremented on every capture
+	bool has_frame = false;
+	unsigned int frame = 0; //*g_gameVals.pFrameCount
+	bool frame_changed = false; //frame differs from the previous capture
+	int game_state = 0;
+	int game_mode = 0;
+	int match_state = 0;
+	int match_timer = 0;
+	int match_rounds = 0;
+	PlayerSnapshot players[2];
+	CameraSnapshot camera;
+	uint16_t entity_count = 0;
+	EntitySnapshot entities[FRAME_SNAPSHOT_MAX_ENTITIES];
+
+	bool HasPlayers() const { return players[0].valid && players[1].valid; }
+	// nullptr if the entity in that slot isn't drawn this frame
+	const EntitySnapshot* FindEntity(int slot) const;
+};
+
+class FrameSnapshotCache
+{
+public:
+	static FrameSnapshotCache& GetInstance();
+
+	// Called once per rendered frame by the WindowManager before any window is drawn, and once per game frame by the battle input hook
+	void Capture();
+	const FrameSnapshot& Get() const { return m_snapshot; }
+
+private:
+	FrameSnapshotCache() = default;
+	void CapturePlayer(int index, const CharData* charObj);
+	void CaptureEntities();
+	void CaptureEntity(int slot, const CharData* pEntity, const CharData* players[2]);
+
+	FrameSnapshot m_snapshot;
+};
@@ -0,0 +1,205 @@
+#include "GameEventBus.h"
+
+#include "EntityTracker.h"
+#include "gamestates.h"
+
+#include <cstring>
+
+namespace
+{
+	constexpr uint32_t GAME_EVENT_RING_MASK = GAME_EVENT_RING_SIZE - 1;
+	static_assert((GAME_EVENT_RING_SIZE & GAME_EVENT_RING_MASK) == 0, "GAME_EVENT_RING_SIZE must be a power of two");
+
+	void copy_action(char (&dst)[GAME_EVENT_ACTION_LENGTH], const char* src)
+	{
+		strncpy(dst, src, GAME_EVENT_ACTION_LENGTH - 1);
+		dst[GAME_EVENT_ACTION_LENGTH - 1] = 0;
+	}
+}
+
+GameEventBus& GameEventBus::GetInstance()
+{
+	static GameEventBus instance;
+	return instance;
+}
+
+GameEventBus::GameEventBus()
+{
+	for (auto& count : m_countByType)
+	{
+		count.store(0, std::memory_order_relaxed);
+	}
+}
+
+void GameEventBus::Update(const FrameSnapshot& snapshot)
+{
+	// The tracker's events are only there until the next capture
+	for (const EntityEvent& entityEvent : EntityTracker::GetInstance().GetFrameEvents())
+	{
+		GameEvent event = MakeEvent(entityEvent.type == EntityEventType::Spawn ? GameEventType_EntitySpawn : GameEventType_EntityDespawn,
+			entityEvent.frame, entityEvent.side);
+		event.slot = entityEvent.slot;
+		Publish(event);
+	}
+
+	if (!snapshot.frame_changed)
+	{
+		return;
+	}
+
+	if (m_hasLastFrame && snapshot.frame < m_lastFrame)
+	{
+		Publish(MakeEvent(GameEventType_FrameReset, snapshot.frame, -1));
+	}
+	DetectMatchEvents(snapshot);
+	DetectPlayerEvents(snapshot, 0);
+	DetectPlayerEvents(snapshot, 1);
+
+	m_hasLastFrame = true;
+	m_lastFrame = snapshot.frame;
+	m_lastMatchState = snapshot.match_state;
+	m_lastPlayers[0] = snapshot.players[0];
+	m_lastPlayers[1] = snapshot.players[1];
+
+	m_lastFrameVolume.store(m_frameVolume, std::memory_order_relaxed);
+	if (m_frameVolume > m_peakFrameVolume.load(std::memory_order_relaxed))
+	{
+		m_peakFrameVolume.store(m_frameVolume, std::memory_order_relaxed);
+	}
+	m_frameVolume = 0;
+}
+
+void GameEventBus::Publish(GameEvent event)
+{
+	const uint32_t sequence = m_published.load(std::memory_order_relaxed);
+	Slot& slot = m_ring[sequence & GAME_EVENT_RING_MASK];
+
+	// Readers copying this slot see the marker, or the new sequence once the event is complete
+	slot.sequence.store(UINT32_MAX, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	event.sequence = sequence;
+	slot.event = event;
+	slot.sequence.store(sequence, std::memory_order_release);
+	m_published.store(sequence + 1, std::memory_order_release);
+
+	m_frameVolume++;
+	if (event.type < GameEventType_Count)
+	{
+		m_countByType[event.type].fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+bool GameEventBus::Poll(GameEventCursor& cursor, GameEvent& out)
+{
+	const uint32_t published = m_published.load(std::memory_order_acquire);
+	if (!cursor.attached)
+	{
+		cursor.next = published;
+		cursor.attached = true;
+	}
+
+	while (cursor.next != published)
+	{
+		if (published - cursor.next > GAME_EVENT_RING_SIZE)
+		{
+			const uint32_t lost = published - cursor.next - GAME_EVENT_RING_SIZE;
+			cursor.dropped += lost;
+			m_dropped.fetch_add(lost, std::memory_order_relaxed);
+			cursor.next = published - GAME_EVENT_RING_SIZE;
+		}
+
+		const uint32_t sequence = cursor.next++;
+		const Slot& slot = m_ring[sequence & GAME_EVENT_RING_MASK];
+		if (slot.sequence.load(std::memory_order_acquire) == sequence)
+		{
+			out = slot.event;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+			{
+				return true;
+			}
+		}
+		// Overwritten while we got to it
+		cursor.dropped++;
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+	return false;
+}
+
+GameEventStats GameEventBus::GetStats() const
+{
+	GameEventStats stats;
+	stats.published = m_published.load(std::memory_order_relaxed);
+	stats.dropped = m_dropped.load(std::memory_order_relaxed);
+	stats.lastFrameVolume = m_lastFrameVolume.load(std::memory_order_relaxed);
+	stats.peakFrameVolume = m_peakFrameVolume.load(std::memory_order_relaxed);
+	for (int i = 0; i < GameEventType_Count; i++)
+	{
+		stats.countByType[i] = m_countByType[i].load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+void GameEventBus::DetectPlayerEvents(const FrameSnapshot& snapshot, int side)
+{
+	const PlayerSnapshot& player = snapshot.players[side];
+	const PlayerSnapshot& previous = m_lastPlayers[side];
+	const PlayerSnapshot& opponent = snapshot.players[side ^ 1];
+	// Nothing to compare against on the first frame of a character
+	if (!player.valid || !previous.valid || player.data != previous.data)
+	{
+		return;
+	}
+
+	if (player.state_changed_count != previous.state_changed_count)
+	{
+		GameEvent event = MakeEvent(GameEventType_ActionChanged, snapshot.frame, side);
+		event.value = player.state_changed_count;
+		copy_action(event.action, player.current_action);
+		Publish(event);
+	}
+	if (player.hit_count > previous.hit_count)
+	{
+		GameEvent event = MakeEvent(GameEventType_Hit, snapshot.frame, side);
+		event.value = player.hit_count;
+		copy_action(event.action, opponent.valid ? opponent.current_action : "");
+		Publish(event);
+	}
+	if (player.blockstun > previous.blockstun)
+	{
+		GameEvent event = MakeEvent(GameEventType_Block, snapshot.frame, side);
+		event.value = player.blockstun;
+		copy_action(event.action, opponent.valid ? opponent.current_action : "");
+		Publish(event);
+	}
+}
+
+void GameEventBus::DetectMatchEvents(const FrameSnapshot& snapshot)
+{
+	if (!m_hasLastFrame || snapshot.match_state == m_lastMatchState)
+	{
+		return;
+	}
+
+	if (snapshot.match_state == MatchState_Fight)
+	{
+		GameEvent event = MakeEvent(GameEventType_RoundStart, snapshot.frame, -1);
+		event.value = snapshot.match_rounds;
+		Publish(event);
+	}
+	else if (m_lastMatchState == MatchState_Fight)
+	{
+		GameEvent event = MakeEvent(GameEventType_RoundEnd, snapshot.frame, -1);
+		event.value = snapshot.match_rounds;
+		Publish(event);
+	}
+}
+
+GameEvent GameEventBus::MakeEvent(GameEventType type, unsigned int frame, int side) const
+{
+	GameEvent event = {};
+	event.type = type;
+	event.frame = frame;
+	event.side = (int8_t)side;
+	return event;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "FrameSnapshot.h"
+
+#include <atomic>
+#include <cstdint>
+
+constexpr uint32_t GAME_EVENT_RING_SIZE = 1024; //power of two, ~10 seconds of a busy match
+constexpr uint32_t GAME_EVENT_ACTION_LENGTH = 32;
+
+enum GameEventType : uint8_t
+{
+	GameEventType_ActionChanged, //side changed action, action is the new one
+	GameEventType_Hit, //side got hit, value is the hit count of the combo, action is the attacker's
+	GameEventType_Block, //side blocked, value is the blockstun, action is the attacker's
+	GameEventType_RoundStart, //value is the round number
+	GameEventType_RoundEnd, //value is the round number
+	GameEventType_FrameReset, //the frame counter went back, training reset or a new round
+	GameEventType_MatchInit,
+	GameEventType_MatchEnd,
+	GameEventType_EntitySpawn, //slot is the entity's, side its owner
+	GameEventType_EntityDespawn,
+	GameEventType_Count
+};
+
+struct GameEvent
+{
+	uint32_t sequence; //position in the bus, set by Publish
+	unsigned int frame;
+	uint8_t type; //GameEventType
+	int8_t side; //player the event is about, -1 if none
+	uint16_t slot; //entity list index for the entity events
+	int32_t value;
+	char action[GAME_EVENT_ACTION_LENGTH];
+};
+
+// Each reader keeps its own, a new cursor starts at the next event published
+struct GameEventCursor
+{
+	uint32_t next = 0;
+	uint32_t dropped = 0; //events overwritten before this cursor read them
+	bool attached = false;
+};
+
+struct GameEventStats
+{
+	uint32_t published;
+	uint32_t dropped; //summed over every cursor
+	uint32_t lastFrameVolume; //events published on the last game frame
+	uint32_t peakFrameVolume;
+	uint32_t countByType[GameEventType_Count];
+};
+
+/*Hits, blocks, action changes, round and match transitions detected once per game frame and published to a fixed ring.
+Update and Publish must only be called from the game's thread (the render, battle input and MatchState hooks), every
+other reader polls with its own cursor and never blocks the writer. A reader falling GAME_EVENT_RING_SIZE events
+behind loses the oldest ones, they are counted as dropped on its cursor and in the stats.*/
+class GameEventBus
+{
+public:
+	static GameEventBus& GetInstance();
+
+	// Called after each FrameSnapshot capture, from the battle input hook on every game frame and from Render outside
+	// of battles. Detects the events when the game frame changed since the previous capture.
+	void Update(const FrameSnapshot& snapshot);
+	void Publish(GameEvent event);
+
+	// Returns false when the cursor caught up, safe from any thread
+	bool Poll(GameEventCursor& cursor, GameEvent& out);
+	GameEventStats GetStats() const;
+
+private:
+	GameEventBus();
+
+	void DetectPlayerEvents(const FrameSnapshot& snapshot, int side);
+	void DetectMatchEvents(const FrameSnapshot& snapshot);
+	GameEvent MakeEvent(GameEventType type, unsigned int frame, int side) const;
+
+	struct Slot
+	{
+		std::atomic<uint32_t> sequence{ UINT32_MAX }; //sequence of the event in it, UINT32_MAX while it's written
+		GameEvent event;
+	};
+	Slot m_ring[GAME_EVENT_RING_SIZE];
+	std::atomic<uint32_t> m_published{ 0 };
+	std::atomic<uint32_t> m_dropped{ 0 };
+
+	// writer only
+	uint32_t m_frameVolume = 0;
+	std::atomic<uint32_t> m_lastFrameVolume{ 0 };
+	std::atomic<uint32_t> m_peakFrameVolume{ 0 };
+	std::atomic<uint32_t> m_countByType[GameEventType_Count];
+
+	bool m_hasLastFrame = false;
+	unsigned int m_lastFrame = 0;
+	int m_lastMatchState = 0;
+	PlayerSnapshot m_lastPlayers[2];
+};
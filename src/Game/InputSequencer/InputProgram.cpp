@@ -0,0 +1,313 @@
+#include "InputProgram.h"
+
+#include <cstdio>
+
+namespace
+{
+	// Longest run of instructions that don't take a frame starting at index, -1 if they can loop
+	int ChainLength(const std::vector<InputInstruction>& code, size_t index, std::vector<int>& memo, std::vector<uint8_t>& visiting)
+	{
+		if (memo[index] >= 0)
+		{
+			return memo[index];
+		}
+		if (visiting[index])
+		{
+			return -1;
+		}
+
+		const InputInstruction& instruction = code[index];
+		size_t next[2];
+		int nextCount = 0;
+		switch (instruction.op)
+		{
+		case InputOp_Wait:
+			if (instruction.condition != InputCondition_Never)
+			{
+				next[nextCount++] = index + 1;
+			}
+			break;
+		case InputOp_Loop:
+		case InputOp_Branch:
+			next[nextCount++] = instruction.target;
+			next[nextCount++] = index + 1;
+			break;
+		case InputOp_Jump:
+			next[nextCount++] = instruction.target;
+			break;
+		default: //Hold takes the frame, End stops
+			break;
+		}
+
+		visiting[index] = 1;
+		int longest = 0;
+		for (int i = 0; i < nextCount; i++)
+		{
+			const int length = ChainLength(code, next[i], memo, visiting);
+			if (length < 0)
+			{
+				return -1;
+			}
+			if (length > longest)
+			{
+				longest = length;
+			}
+		}
+		visiting[index] = 0;
+		memo[index] = longest + 1;
+		return memo[index];
+	}
+}
+
+int InputProgramBuilder::NewLabel()
+{
+	m_labels.push_back(-1);
+	return (int)m_labels.size() - 1;
+}
+
+int InputProgramBuilder::Bind(int label)
+{
+	if (label >= 0 && label < (int)m_labels.size())
+	{
+		m_labels[label] = (int)m_code.size();
+	}
+	return label;
+}
+
+InputProgramBuilder& InputProgramBuilder::Hold(uint16_t packed, uint32_t frames)
+{
+	return Add(InputOp_Hold, packed, frames, 0, -1, InputCondition_Never);
+}
+
+InputProgramBuilder& InputProgramBuilder::WaitFor(InputCondition condition, uint16_t packed, uint32_t timeout, int16_t arg)
+{
+	return Add(InputOp_Wait, packed, timeout, arg, -1, condition);
+}
+
+InputProgramBuilder& InputProgramBuilder::Loop(int label, uint32_t times)
+{
+	return Add(InputOp_Loop, 0, times, 0, label, InputCondition_Never);
+}
+
+InputProgramBuilder& InputProgramBuilder::Branch(int label, int percent)
+{
+	return Add(InputOp_Branch, 0, 0, (int16_t)percent, label, InputCondition_Never);
+}
+
+InputProgramBuilder& InputProgramBuilder::Jump(int label)
+{
+	return Add(InputOp_Jump, 0, 0, 0, label, InputCondition_Never);
+}
+
+InputProgramBuilder& InputProgramBuilder::End()
+{
+	return Add(InputOp_End, 0, 0, 0, -1, InputCondition_Never);
+}
+
+InputProgramBuilder& InputProgramBuilder::Add(InputOp op, uint16_t packed, uint32_t count, int16_t arg, int label, InputCondition condition)
+{
+	InputInstruction instruction = {};
+	instruction.op = op;
+	instruction.condition = condition;
+	instruction.packed = packed;
+	instruction.arg = arg;
+	instruction.count = count;
+	m_code.push_back(instruction);
+	m_labelOf.push_back(label);
+	return *this;
+}
+
+bool InputProgramBuilder::Build(InputProgram& out, std::string& error) const
+{
+	char buffer[128];
+	out.code = m_code;
+	out.loopCount = 0;
+	out.maxChain = 0;
+
+	// Falling off the end stops the program, labels bound after the last instruction point at this End
+	if (out.code.empty() || (out.code.back().op != InputOp_End && out.code.back().op != InputOp_Jump))
+	{
+		InputInstruction end = {};
+		end.op = InputOp_End;
+		out.code.push_back(end);
+	}
+	if (out.code.size() > UINT16_MAX)
+	{
+		error = "too many instructions";
+		return false;
+	}
+
+	for (size_t i = 0; i < m_code.size(); i++)
+	{
+		InputInstruction& instruction = out.code[i];
+		const int label = m_labelOf[i];
+		if (instruction.op == InputOp_Loop || instruction.op == InputOp_Branch || instruction.op == InputOp_Jump)
+		{
+			if (label < 0 || label >= (int)m_labels.size() || m_labels[label] < 0 || m_labels[label] >= (int)out.code.size())
+			{
+				snprintf(buffer, sizeof(buffer), "instruction %u jumps to an unbound label", (unsigned)i);
+				error = buffer;
+				return false;
+			}
+			instruction.target = (uint16_t)m_labels[label];
+		}
+
+		if (instruction.op == InputOp_Hold && instruction.count == 0)
+		{
+			snprintf(buffer, sizeof(buffer), "instruction %u holds for 0 frames", (unsigned)i);
+			error = buffer;
+			return false;
+		}
+		if (instruction.op == InputOp_Branch && (instruction.arg < 0 || instruction.arg > 100))
+		{
+			snprintf(buffer, sizeof(buffer), "instruction %u branches %d%% of the time", (unsigned)i, instruction.arg);
+			error = buffer;
+			return false;
+		}
+		if (instruction.op == InputOp_Loop)
+		{
+			if (out.loopCount == INPUT_PROGRAM_MAX_LOOPS)
+			{
+				error = "too many loops";
+				return false;
+			}
+			instruction.arg = (int16_t)out.loopCount++;
+		}
+	}
+
+	std::vector<int> memo(out.code.size(), -1);
+	std::vector<uint8_t> visiting(out.code.size(), 0);
+	for (size_t i = 0; i < out.code.size(); i++)
+	{
+		const int length = ChainLength(out.code, i, memo, visiting);
+		if (length < 0)
+		{
+			snprintf(buffer, sizeof(buffer), "instruction %u is in a loop without a Hold", (unsigned)i);
+			error = buffer;
+			return false;
+		}
+		if (length > out.maxChain)
+		{
+			out.maxChain = length;
+		}
+	}
+	if (out.maxChain > INPUT_PROGRAM_MAX_CHAIN)
+	{
+		error = "too many instructions without a Hold in a row";
+		return false;
+	}
+	return true;
+}
+
+void InputProgramRunner::Start(const InputProgram* program, uint32_t seed)
+{
+	m_program = program;
+	m_state = program && !program->code.empty() ? InputRunState_Running : InputRunState_Idle;
+	m_pc = 0;
+	m_held = 0;
+	m_frame = 0;
+	m_random = seed ? seed : 1;
+	for (uint32_t& loop : m_loops)
+	{
+		loop = 0;
+	}
+}
+
+void InputProgramRunner::Stop()
+{
+	m_program = nullptr;
+	m_state = InputRunState_Idle;
+}
+
+bool InputProgramRunner::Advance(const InputSequencerContext& context, uint16_t& packedOut)
+{
+	if (m_state != InputRunState_Running)
+	{
+		return false;
+	}
+
+	const InputInstruction* code = m_program->code.data();
+	// Build made sure a frame gets to a Hold, a waiting Wait or End within maxChain instructions
+	for (int step = 0; step < m_program->maxChain; step++)
+	{
+		const InputInstruction& instruction = code[m_pc];
+		switch (instruction.op)
+		{
+		case InputOp_Hold:
+			packedOut = instruction.packed;
+			if (++m_held >= instruction.count)
+			{
+				m_held = 0;
+				m_pc++;
+			}
+			m_frame++;
+			return true;
+		case InputOp_Wait:
+			if (IsMet(instruction, context))
+			{
+				m_held = 0;
+				m_pc++;
+				break;
+			}
+			packedOut = instruction.packed;
+			if (instruction.count && ++m_held >= instruction.count)
+			{
+				m_held = 0;
+				m_pc++;
+			}
+			m_frame++;
+			return true;
+		case InputOp_Loop:
+			if (instruction.count == 0 || ++m_loops[instruction.arg] < instruction.count)
+			{
+				m_pc = instruction.target;
+			}
+			else
+			{
+				m_loops[instruction.arg] = 0;
+				m_pc++;
+			}
+			break;
+		case InputOp_Branch:
+			m_pc = Random() % 100 < (uint32_t)instruction.arg ? instruction.target : m_pc + 1;
+			break;
+		case InputOp_Jump:
+			m_pc = instruction.target;
+			break;
+		default:
+			m_state = InputRunState_Finished;
+			return false;
+		}
+	}
+
+	m_state = InputRunState_Finished;
+	return false;
+}
+
+bool InputProgramRunner::IsMet(const InputInstruction& instruction, const InputSequencerContext& context) const
+{
+	switch (instruction.condition)
+	{
+	case InputCondition_OpponentBlockstun:
+		return context.opponentBlockstun > 0;
+	case InputCondition_OpponentHitstun:
+		return context.opponentHitstun > 0;
+	case InputCondition_OpponentFree:
+		return context.opponentBlockstun <= 0 && context.opponentHitstun <= 0;
+	case InputCondition_AdvantageAtLeast:
+		return context.frameAdvantage >= instruction.arg;
+	case InputCondition_AdvantageAtMost:
+		return context.frameAdvantage <= instruction.arg;
+	default:
+		return false;
+	}
+}
+
+uint32_t InputProgramRunner::Random()
+{
+	// xorshift32, the seed makes a run repeatable
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 17;
+	m_random ^= m_random << 5;
+	return m_random;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr int INPUT_PROGRAM_MAX_LOOPS = 16; //loop counters a program can use
+constexpr int INPUT_PROGRAM_MAX_CHAIN = 32; //instructions that don't take a frame, run back to back on one frame
+
+enum InputOp : uint8_t
+{
+	InputOp_Hold,   //write packed for count frames
+	InputOp_Wait,   //write packed until the condition holds, or for count frames if count isn't 0
+	InputOp_Loop,   //back to target until the body ran count times, 0 loops forever
+	InputOp_Branch, //to target arg percent of the time, to the next instruction otherwise
+	InputOp_Jump,
+	InputOp_End
+};
+
+enum InputCondition : uint8_t
+{
+	InputCondition_Never, //a Wait that only times out
+	InputCondition_OpponentBlockstun,
+	InputCondition_OpponentHitstun,
+	InputCondition_OpponentFree, //neither in blockstun nor hitstun
+	InputCondition_AdvantageAtLeast, //frame advantage of the player running the program >= arg
+	InputCondition_AdvantageAtMost
+};
+
+struct InputInstruction
+{
+	uint8_t op; //InputOp
+	uint8_t condition; //InputCondition, Wait only
+	uint16_t packed; //battle input, see InputState::ToPackedValue
+	int16_t arg; //Wait: condition value, Branch: percent, Loop: its counter, set by Build
+	uint16_t target; //instruction index for Loop, Branch and Jump
+	uint32_t count;
+};
+
+// What the conditions look at, read by the hook from the game once per frame
+struct InputSequencerContext
+{
+	int32_t opponentBlockstun = 0;
+	int32_t opponentHitstun = 0;
+	int32_t frameAdvantage = 0;
+};
+
+// Flat and validated, every loop goes through a Hold so a frame never runs more than maxChain instructions
+struct InputProgram
+{
+	std::vector<InputInstruction> code;
+	int loopCount = 0;
+	int maxChain = 0;
+};
+
+/*Builds a program, labels are bound to the next instruction added. Build resolves them and rejects programs
+that could spin without taking a frame.
+	InputProgramBuilder b;
+	int again = b.Bind(b.NewLabel());
+	b.Hold(2, 3).Hold(5 + 32, 1).WaitFor(InputCondition_OpponentFree, 5, 60).Loop(again, 4);*/
+class InputProgramBuilder
+{
+public:
+	int NewLabel();
+	int Bind(int label);
+
+	InputProgramBuilder& Hold(uint16_t packed, uint32_t frames);
+	InputProgramBuilder& WaitFor(InputCondition condition, uint16_t packed, uint32_t timeout = 0, int16_t arg = 0);
+	InputProgramBuilder& Loop(int label, uint32_t times);
+	InputProgramBuilder& Branch(int label, int percent);
+	InputProgramBuilder& Jump(int label);
+	InputProgramBuilder& End();
+
+	bool Build(InputProgram& out, std::string& error) const;
+
+private:
+	InputProgramBuilder& Add(InputOp op, uint16_t packed, uint32_t count, int16_t arg, int label, InputCondition condition);
+
+	std::vector<InputInstruction> m_code;
+	std::vector<int> m_labelOf; //label of each instruction's target, -1 for none
+	std::vector<int> m_labels; //instruction index of each label, -1 while unbound
+};
+
+enum InputRunState : uint8_t
+{
+	InputRunState_Idle,
+	InputRunState_Running,
+	InputRunState_Finished
+};
+
+// Runs one program, Advance is one game frame. Doesn't own the program.
+class InputProgramRunner
+{
+public:
+	void Start(const InputProgram* program, uint32_t seed);
+	void Stop();
+
+	// False once the program ended, packedOut is untouched then
+	bool Advance(const InputSequencerContext& context, uint16_t& packedOut);
+
+	InputRunState GetState() const { return m_state; }
+	uint16_t GetPc() const { return m_pc; }
+	uint32_t GetFrame() const { return m_frame; } //frames since Start
+
+private:
+	bool IsMet(const InputInstruction& instruction, const InputSequencerContext& context) const;
+	uint32_t Random();
+
+	const InputProgram* m_program = nullptr;
+	InputRunState m_state = InputRunState_Idle;
+	uint16_t m_pc = 0;
+	uint32_t m_held = 0; //frames spent on the current instruction
+	uint32_t m_frame = 0;
+	uint32_t m_random = 1;
+	uint32_t m_loops[INPUT_PROGRAM_MAX_LOOPS] = {};
+};
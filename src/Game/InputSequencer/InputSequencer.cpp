@@ -0,0 +1,127 @@
+#include "InputSequencer.h"
+
+#include "Core/interfaces.h"
+#include "Overlay/Window/FrameAdvantage/FrameAdvantage.h"
+
+#include <chrono>
+
+InputSequencer& InputSequencer::GetInstance()
+{
+	static InputSequencer instance;
+	return instance;
+}
+
+void InputSequencer::Start(uint32_t player, std::unique_ptr<InputProgram> program, uint32_t seed)
+{
+	if (player > 1 || !program)
+	{
+		return;
+	}
+	if (!seed)
+	{
+		seed = (uint32_t)std::chrono::steady_clock::now().time_since_epoch().count() | 1;
+	}
+
+	Channel& channel = m_channels[player];
+	std::lock_guard<std::mutex> lock(channel.mutex);
+	channel.staged = std::move(program);
+	channel.stagedSeed = seed;
+	channel.stopRequested.store(false, std::memory_order_relaxed);
+	channel.startRequested.store(true, std::memory_order_release);
+}
+
+void InputSequencer::Stop(uint32_t player)
+{
+	if (player > 1)
+	{
+		return;
+	}
+
+	Channel& channel = m_channels[player];
+	std::lock_guard<std::mutex> lock(channel.mutex);
+	channel.startRequested.store(false, std::memory_order_relaxed);
+	channel.stopRequested.store(true, std::memory_order_release);
+}
+
+bool InputSequencer::Tick(uint32_t player, uint16_t& packedOut)
+{
+	if (player > 1)
+	{
+		return false;
+	}
+
+	Channel& channel = m_channels[player];
+	if (channel.stopRequested.exchange(false, std::memory_order_acquire))
+	{
+		channel.runner.Stop();
+		channel.state.store(InputRunState_Idle, std::memory_order_relaxed);
+	}
+	if (channel.startRequested.load(std::memory_order_acquire) && channel.mutex.try_lock())
+	{
+		// The old program goes back to staged, Start frees it off the game thread
+		channel.running.swap(channel.staged);
+		channel.runner.Start(channel.running.get(), channel.stagedSeed);
+		channel.hasLastFrame = false;
+		channel.startRequested.store(false, std::memory_order_relaxed);
+		channel.mutex.unlock();
+	}
+
+	if (channel.runner.GetState() != InputRunState_Running)
+	{
+		return false;
+	}
+
+	// The writer can run more than once on a game frame, the program only moves when the frame does
+	if (g_gameVals.pFrameCount)
+	{
+		const unsigned int frame = *g_gameVals.pFrameCount;
+		if (channel.hasLastFrame && frame == channel.lastFrame)
+		{
+			packedOut = channel.lastPacked;
+			return true;
+		}
+		channel.hasLastFrame = true;
+		channel.lastFrame = frame;
+	}
+
+	InputSequencerContext context;
+	CaptureContext(player, context);
+	const bool wrote = channel.runner.Advance(context, channel.lastPacked);
+	channel.state.store(channel.runner.GetState(), std::memory_order_relaxed);
+	channel.pc.store(channel.runner.GetPc(), std::memory_order_relaxed);
+	channel.frame.store(channel.runner.GetFrame(), std::memory_order_relaxed);
+	if (wrote)
+	{
+		packedOut = channel.lastPacked;
+	}
+	return wrote;
+}
+
+InputRunState InputSequencer::GetState(uint32_t player) const
+{
+	return player > 1 ? InputRunState_Idle : (InputRunState)m_channels[player].state.load(std::memory_order_relaxed);
+}
+
+uint16_t InputSequencer::GetPc(uint32_t player) const
+{
+	return player > 1 ? 0 : m_channels[player].pc.load(std::memory_order_relaxed);
+}
+
+uint32_t InputSequencer::GetFrame(uint32_t player) const
+{
+	return player > 1 ? 0 : m_channels[player].frame.load(std::memory_order_relaxed);
+}
+
+void InputSequencer::CaptureContext(uint32_t player, InputSequencerContext& context) const
+{
+	const Player& opponent = player == 0 ? g_interfaces.player2 : g_interfaces.player1;
+	if (!opponent.IsCharDataNullPtr())
+	{
+		const CharData* data = opponent.GetData();
+		context.opponentBlockstun = data->blockstun;
+		context.opponentHitstun = data->hitstun;
+	}
+	// From P1's side, the battle input hook updates it at the start of every game frame
+	const int advantage = playersInteraction.frameAdvantageToDisplay;
+	context.frameAdvantage = player == 0 ? advantage : -advantage;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "InputProgram.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/*Plays compiled InputPrograms into the battle input hook, one per player. Tick runs in the hook on the game thread
+and does a bounded amount of work per game frame. Start and Stop can be called from any thread: the program is
+handed over under a lock the hook only ever try_locks, so a busy lock only delays the start by a frame and the hook
+never waits or frees memory.*/
+class InputSequencer
+{
+public:
+	static InputSequencer& GetInstance();
+
+	// Takes over the player's battle input from the next game frame, seed 0 picks one from the clock
+	void Start(uint32_t player, std::unique_ptr<InputProgram> program, uint32_t seed = 0);
+	void Stop(uint32_t player);
+
+	// Called from the battle input hook, false when no program writes the player's input
+	bool Tick(uint32_t player, uint16_t& packedOut);
+
+	InputRunState GetState(uint32_t player) const;
+	uint16_t GetPc(uint32_t player) const;
+	uint32_t GetFrame(uint32_t player) const;
+
+private:
+	InputSequencer() = default;
+
+	void CaptureContext(uint32_t player, InputSequencerContext& context) const;
+
+	struct Channel
+	{
+		// Hook only
+		InputProgramRunner runner;
+		std::unique_ptr<InputProgram> running;
+		bool hasLastFrame = false;
+		unsigned int lastFrame = 0;
+		uint16_t lastPacked = 0;
+
+		// Start and Stop hand over through these
+		std::mutex mutex;
+		std::unique_ptr<InputProgram> staged; //the next program, or the one the hook let go of
+		uint32_t stagedSeed = 0;
+		std::atomic<bool> startRequested{ false };
+		std::atomic<bool> stopRequested{ false };
+
+		// For the windows
+		std::atomic<uint8_t> state{ InputRunState_Idle };
+		std::atomic<uint16_t> pc{ 0 };
+		std::atomic<uint32_t> frame{ 0 };
+	};
+
+	Channel m_channels[2];
+};
@@ -0,0 +1,197 @@
+#include "JonbBoxDB.h"
+#include "JonbDBReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	uint32_t hash_name(const char* name, size_t length)
+	{
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= (unsigned char)name[i];
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	uint16_t read_u16(const char* addr)
+	{
+		uint16_t value;
+		memcpy(&value, addr, 2);
+		return value;
+	}
+}
+
+void JonbBoxDB::Clear()
+{
+	m_names.clear();
+	m_nameHashes.clear();
+	m_ranges.clear();
+	m_slots.clear();
+	m_type.clear();
+	m_offsetX.clear();
+	m_offsetY.clear();
+	m_width.clear();
+	m_height.clear();
+}
+
+size_t JonbBoxDB::AddFpac(char* fpac, bool is_jubei, const char* end)
+{
+	std::vector<JonbFpacEntry> entries = JonbDBReader::read_fpac_index(fpac, is_jubei, end);
+	size_t added = 0;
+	for (auto& entry : entries)
+	{
+		JonbBoxRange range;
+		if (!DecodeJonb(entry.jonb, end, range))
+		{
+			continue;
+		}
+		uint32_t sprite = Intern(entry.name, std::min<size_t>(entry.name_length, JONB_NAME_SIZE - 1));
+		m_ranges[sprite] = range;
+		added++;
+	}
+	return added;
+}
+
+// Appends the boxes of one JONB to the arrays
+bool JonbBoxDB::DecodeJonb(const char* jonb, const char* end, JonbBoxRange& range)
+{
+	if ((end && end - jonb < 6) || memcmp(jonb, "JONB", 4) != 0)
+	{
+		return false;
+	}
+	const char* counts = jonb + 6 + read_u16(jonb + 4) * JONB_NAME_SIZE;
+	if (end && counts + JONB_COUNTS_SIZE > end)
+	{
+		return false;
+	}
+	uint16_t chunk_count = read_u16(counts + JONB_CHUNK_COUNT_OFFSET);
+	uint8_t hurtbox_count = (uint8_t)counts[JONB_HURTBOX_COUNT_OFFSET];
+	uint8_t hitbox_count = (uint8_t)counts[JONB_HITBOX_COUNT_OFFSET];
+	const char* boxes = counts + JONB_COUNTS_SIZE + chunk_count * JONB_CHUNK_SIZE;
+	size_t box_count = hurtbox_count + hitbox_count;
+	if (end && boxes + box_count * JONB_BOX_SIZE > end)
+	{
+		return false;
+	}
+
+	range.begin = (uint32_t)m_type.size();
+	range.hitbox_begin = range.begin + hurtbox_count;
+	range.end = range.begin + (uint32_t)box_count;
+	size_t new_size = m_type.size() + box_count;
+	m_type.reserve(new_size);
+	m_offsetX.reserve(new_size);
+	m_offsetY.reserve(new_size);
+	m_width.reserve(new_size);
+	m_height.reserve(new_size);
+	for (size_t i = 0; i < box_count; i++)
+	{
+		//hurtboxes are stored first, the order is what tells them apart from hitboxes
+		float values[4];
+		memcpy(values, boxes + i * JONB_BOX_SIZE + 4, sizeof(values));
+		m_type.push_back(i < hurtbox_count ? BoxEntryType_Hurtbox : BoxEntryType_Hitbox);
+		m_offsetX.push_back(values[0]);
+		m_offsetY.push_back(values[1]);
+		m_width.push_back(values[2]);
+		m_height.push_back(values[3]);
+	}
+	return true;
+}
+
+uint32_t JonbBoxDB::Intern(const char* name, size_t length)
+{
+	uint32_t sprite = FindSprite(name, length);
+	if (sprite != JONB_INVALID_SPRITE)
+	{
+		return sprite;
+	}
+	sprite = (uint32_t)m_ranges.size();
+	m_names.resize(m_names.size() + JONB_NAME_SIZE, 0);
+	memcpy(&m_names[sprite * JONB_NAME_SIZE], name, length);
+	m_nameHashes.push_back(hash_name(name, length));
+	m_ranges.push_back(JonbBoxRange());
+	//kept at most half full so the probing stays short
+	if ((m_ranges.size() * 2) > m_slots.size())
+	{
+		Rehash(std::max<size_t>(64, m_slots.size() * 2));
+	}
+	else
+	{
+		InsertSlot(sprite);
+	}
+	return sprite;
+}
+
+void JonbBoxDB::InsertSlot(uint32_t sprite)
+{
+	uint32_t mask = (uint32_t)m_slots.size() - 1;
+	uint32_t i = m_nameHashes[sprite] & mask;
+	while (m_slots[i])
+	{
+		i = (i + 1) & mask;
+	}
+	m_slots[i] = sprite + 1;
+}
+
+void JonbBoxDB::Rehash(size_t slot_count)
+{
+	m_slots.assign(slot_count, 0);
+	for (uint32_t sprite = 0; sprite < m_ranges.size(); sprite++)
+	{
+		InsertSlot(sprite);
+	}
+}
+
+uint32_t JonbBoxDB::FindSprite(const char* name, size_t length) const
+{
+	if (m_slots.empty() || length >= JONB_NAME_SIZE)
+	{
+		return JONB_INVALID_SPRITE;
+	}
+	uint32_t hash = hash_name(name, length);
+	uint32_t mask = (uint32_t)m_slots.size() - 1;
+	for (uint32_t i = hash & mask; m_slots[i]; i = (i + 1) & mask)
+	{
+		uint32_t sprite = m_slots[i] - 1;
+		const char* sprite_name = &m_names[sprite * JONB_NAME_SIZE];
+		if (m_nameHashes[sprite] == hash && memcmp(sprite_name, name, length) == 0 && sprite_name[length] == 0)
+		{
+			return sprite;
+		}
+	}
+	return JONB_INVALID_SPRITE;
+}
+
+uint32_t JonbBoxDB::FindSprite(const char* name) const
+{
+	return FindSprite(name, strnlen(name, JONB_NAME_SIZE));
+}
+
+uint32_t JonbBoxDB::GetSpriteCount() const
+{
+	return (uint32_t)m_ranges.size();
+}
+
+const char* JonbBoxDB::GetSpriteName(uint32_t sprite) const
+{
+	return &m_names[sprite * JONB_NAME_SIZE];
+}
+
+const JonbBoxRange& JonbBoxDB::GetBoxes(uint32_t sprite) const
+{
+	return m_ranges[sprite];
+}
+
+bool JonbBoxDB::HasHitboxes(const char* name) const
+{
+	uint32_t sprite = FindSprite(name);
+	return sprite != JONB_INVALID_SPRITE && m_ranges[sprite].HitboxCount() > 0;
+}
+
+size_t JonbBoxDB::GetBoxCount() const
+{
+	return m_type.size();
+}
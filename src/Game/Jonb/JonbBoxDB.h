@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "JonbDBEntry.h"
+
+constexpr uint32_t JONB_INVALID_SPRITE = 0xFFFFFFFF;
+
+// Boxes of one sprite inside the JonbBoxDB arrays, [begin, hitbox_begin) are hurtboxes and [hitbox_begin, end) hitboxes
+struct JonbBoxRange {
+	uint32_t begin = 0;
+	uint32_t hitbox_begin = 0;
+	uint32_t end = 0;
+
+	uint32_t HurtboxCount() const { return hitbox_begin - begin; }
+	uint32_t HitboxCount() const { return end - hitbox_begin; }
+};
+
+/*Every box of every jonbin of one or more FPACs, decoded once into flat arrays so drawing or testing boxes doesn't
+need to go back to the game memory. Sprites are interned, the id of a sprite indexes its name and box range.*/
+class JonbBoxDB
+{
+public:
+	void Clear();
+	// Decodes every jonbin of the FPAC, returns the amount of sprites added. See JonbDBReader::read_fpac_index for the arguments
+	size_t AddFpac(char* fpac, bool is_jubei, const char* end = nullptr);
+
+	// Sprites are keyed by their jonbin name without the extension, for ex "ha000_00"
+	uint32_t FindSprite(const char* name, size_t length) const;
+	uint32_t FindSprite(const char* name) const;
+	uint32_t GetSpriteCount() const;
+	const char* GetSpriteName(uint32_t sprite) const; //null terminated, at most JONB_NAME_SIZE - 1 characters
+	const JonbBoxRange& GetBoxes(uint32_t sprite) const;
+	// False for sprites that aren't in the index
+	bool HasHitboxes(const char* name) const;
+
+	size_t GetBoxCount() const;
+	const BoxEntry_* GetTypes() const { return m_type.data(); }
+	const float* GetOffsetX() const { return m_offsetX.data(); }
+	const float* GetOffsetY() const { return m_offsetY.data(); }
+	const float* GetWidth() const { return m_width.data(); }
+	const float* GetHeight() const { return m_height.data(); }
+
+private:
+	uint32_t Intern(const char* name, size_t length);
+	void InsertSlot(uint32_t sprite);
+	void Rehash(size_t slot_count);
+	bool DecodeJonb(const char* jonb, const char* end, JonbBoxRange& range);
+
+	std::vector<char> m_names; //JONB_NAME_SIZE bytes per sprite
+	std::vector<uint32_t> m_nameHashes;
+	std::vector<JonbBoxRange> m_ranges;
+	std::vector<uint32_t> m_slots; //open addressing, sprite id + 1, 0 is empty
+
+	std::vector<BoxEntry_> m_type;
+	std::vector<float> m_offsetX;
+	std::vector<float> m_offsetY;
+	std::vector<float> m_width;
+	std::vector<float> m_height;
+};
@@ -0,0 +1,229 @@
+#include "JonbCollision.h"
+#include "JonbReader.h"
+
+#include "Core/interfaces.h"
+#include "Game/FrameSnapshot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace
+{
+	// Padding boxes, far enough that they are never the closest one but their squared distance still fits a float
+	constexpr float UNREACHABLE = 1e15f;
+	constexpr float PI = 3.14159265f;
+}
+
+HitboxCollision& HitboxCollision::GetInstance()
+{
+	static HitboxCollision instance;
+	return instance;
+}
+
+const HitboxCollisionResult& HitboxCollision::Update()
+{
+	const FrameSnapshot& snapshot = FrameSnapshotCache::GetInstance().Get();
+	if (!snapshot.has_frame)
+	{
+		m_result = HitboxCollisionResult();
+		m_hasResult = false;
+		return m_result;
+	}
+	if (m_hasResult && m_result.frame == snapshot.frame)
+	{
+		return m_result;
+	}
+
+	LARGE_INTEGER start, end, frequency;
+	QueryPerformanceCounter(&start);
+
+	m_result = HitboxCollisionResult();
+	m_result.frame = snapshot.frame;
+	Gather(snapshot);
+	TestSide(0);
+	TestSide(1);
+	m_hasResult = true;
+
+	QueryPerformanceCounter(&end);
+	QueryPerformanceFrequency(&frequency);
+	m_result.time_ms = (double)(end.QuadPart - start.QuadPart) * 1000.0 / (double)frequency.QuadPart;
+	return m_result;
+}
+
+void HitboxCollision::Gather(const FrameSnapshot& snapshot)
+{
+	for (int side = 0; side < 2; side++)
+	{
+		m_hitboxes[side].clear();
+		m_hitboxEntity[side].clear();
+		m_hurtMinX[side].clear();
+		m_hurtMinY[side].clear();
+		m_hurtMaxX[side].clear();
+		m_hurtMaxY[side].clear();
+		m_hurtEntity[side].clear();
+	}
+
+	for (uint16_t i = 0; i < snapshot.entity_count; i++)
+	{
+		const EntitySnapshot& entity = snapshot.entities[i];
+		if (entity.side != -1)
+		{
+			AddEntityBoxes(entity);
+		}
+	}
+
+	for (int side = 0; side < 2; side++)
+	{
+		m_result.sides[side].hitbox_count = (int)m_hitboxes[side].size();
+		m_result.hurtbox_count += (int)m_hurtEntity[side].size();
+		while (m_hurtEntity[side].size() % 4)
+		{
+			m_hurtMinX[side].push_back(UNREACHABLE);
+			m_hurtMinY[side].push_back(UNREACHABLE);
+			m_hurtMaxX[side].push_back(UNREACHABLE);
+			m_hurtMaxY[side].push_back(UNREACHABLE);
+			m_hurtEntity[side].push_back(-1);
+		}
+	}
+}
+
+// Same world space as HitboxOverlay, without its screen scale and rounding
+void HitboxCollision::AddEntityBoxes(const EntitySnapshot& snapshot)
+{
+	const JonbEntrySpan& entries = snapshot.boxes;
+	if (entries.Empty())
+	{
+		return;
+	}
+
+	const int entity = snapshot.slot;
+	const int side = snapshot.side;
+	const bool facingLeft = (snapshot.flags & FrameSnapshotEntityFlags_FacingLeft) != 0;
+	const float posX = snapshot.pos_x / 1000.0f;
+	const float posY = snapshot.pos_y / 1000.0f;
+	const float scaleX = snapshot.scale_x / 1000.0f;
+	const float scaleY = snapshot.scale_y / 1000.0f;
+	float rotationDeg = snapshot.rotation / 1000.0f;
+	if (!facingLeft && rotationDeg)
+	{
+		rotationDeg = 360.0f - rotationDeg;
+	}
+	const float rotationRad = rotationDeg * PI / 180.0f;
+	const float s = rotationRad ? sin(rotationRad) : 0.0f;
+	const float c = rotationRad ? cos(rotationRad) : 1.0f;
+
+	const bool hitboxesDisabled = (snapshot.flags & FrameSnapshotEntityFlags_HitboxesDisabled) != 0;
+
+	for (const JonbEntry& entry : entries)
+	{
+		const bool isHitbox = entry.type == JonbChunkType_Hitbox;
+		if (isHitbox && hitboxesDisabled)
+		{
+			continue;
+		}
+
+		float offsetX = entry.offsetX * scaleX;
+		float offsetY = -entry.offsetY * scaleY;
+		float width = entry.width * scaleX;
+		float height = -entry.height * scaleY;
+		if (!facingLeft)
+		{
+			offsetX = -offsetX;
+			width = -width;
+		}
+
+		const float cornersX[4] = { offsetX, offsetX + width, offsetX + width, offsetX };
+		const float cornersY[4] = { offsetY, offsetY, offsetY + height, offsetY + height };
+		Aabb box = { UNREACHABLE, UNREACHABLE, -UNREACHABLE, -UNREACHABLE };
+		for (int i = 0; i < 4; i++)
+		{
+			const float x = posX + cornersX[i] * c - cornersY[i] * s;
+			const float y = posY + cornersX[i] * s + cornersY[i] * c;
+			box.min_x = std::min(box.min_x, x);
+			box.min_y = std::min(box.min_y, y);
+			box.max_x = std::max(box.max_x, x);
+			box.max_y = std::max(box.max_y, y);
+		}
+
+		if (isHitbox)
+		{
+			m_hitboxes[side].push_back(box);
+			m_hitboxEntity[side].push_back(entity);
+		}
+		else
+		{
+			m_hurtMinX[side].push_back(box.min_x);
+			m_hurtMinY[side].push_back(box.min_y);
+			m_hurtMaxX[side].push_back(box.max_x);
+			m_hurtMaxY[side].push_back(box.max_y);
+			m_hurtEntity[side].push_back(entity);
+		}
+	}
+}
+
+// Hitboxes of side against the hurtboxes of the other side, 4 hurtboxes per step
+void HitboxCollision::TestSide(int side)
+{
+	const int other = 1 - side;
+	HitboxCollisionSide& result = m_result.sides[side];
+	const size_t hurtboxCount = m_hurtEntity[other].size();
+	if (m_hitboxes[side].empty() || hurtboxCount == 0)
+	{
+		return;
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	float bestDistance = UNREACHABLE * UNREACHABLE;
+	for (size_t h = 0; h < m_hitboxes[side].size(); h++)
+	{
+		const Aabb& hitbox = m_hitboxes[side][h];
+		const __m128 hitMinX = _mm_set1_ps(hitbox.min_x);
+		const __m128 hitMinY = _mm_set1_ps(hitbox.min_y);
+		const __m128 hitMaxX = _mm_set1_ps(hitbox.max_x);
+		const __m128 hitMaxY = _mm_set1_ps(hitbox.max_y);
+
+		for (size_t i = 0; i < hurtboxCount; i += 4)
+		{
+			// gap on each axis, 0 when the intervals overlap
+			const __m128 dx = _mm_max_ps(_mm_max_ps(
+				_mm_sub_ps(_mm_loadu_ps(&m_hurtMinX[other][i]), hitMaxX),
+				_mm_sub_ps(hitMinX, _mm_loadu_ps(&m_hurtMaxX[other][i]))), zero);
+			const __m128 dy = _mm_max_ps(_mm_max_ps(
+				_mm_sub_ps(_mm_loadu_ps(&m_hurtMinY[other][i]), hitMaxY),
+				_mm_sub_ps(hitMinY, _mm_loadu_ps(&m_hurtMaxY[other][i]))), zero);
+			const __m128 distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+			// the closest pair changes rarely, so only go scalar when one of the 4 beats it
+			if (_mm_movemask_ps(_mm_cmplt_ps(distance, _mm_set1_ps(bestDistance))) == 0)
+			{
+				continue;
+			}
+			float distances[4], gapsX[4], gapsY[4];
+			_mm_storeu_ps(distances, distance);
+			_mm_storeu_ps(gapsX, dx);
+			_mm_storeu_ps(gapsY, dy);
+			for (int k = 0; k < 4; k++)
+			{
+				if (distances[k] < bestDistance)
+				{
+					bestDistance = distances[k];
+					result.gap_x = gapsX[k];
+					result.gap_y = gapsY[k];
+					result.attacker_entity = m_hitboxEntity[side][h];
+					result.target_entity = m_hurtEntity[other][i + k];
+				}
+			}
+		}
+		if (bestDistance == 0.0f)
+		{
+			break;
+		}
+	}
+
+	if (result.target_entity != -1)
+	{
+		result.gap = sqrt(bestDistance);
+		result.hits = bestDistance == 0.0f;
+	}
+}
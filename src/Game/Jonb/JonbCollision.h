@@ -0,0 +1,62 @@
+#pragma once
+#include "Game/CharData.h"
+#include "Game/FrameSnapshot.h"
+
+#include <vector>
+
+// Hitboxes of one side(the player and everything they own) against the hurtboxes of the other side
+struct HitboxCollisionSide {
+	int hitbox_count = 0; //active hitboxes this frame
+	bool hits = false;
+	// Distance between the closest hitbox/hurtbox pair in sprite pixels(game units / 1000), 0 when it hits,
+	// -1 if the side has no active hitbox or the other side has no hurtbox
+	float gap = -1.0f;
+	float gap_x = 0.0f;
+	float gap_y = 0.0f;
+	int attacker_entity = -1; //index in g_gameVals.pEntityList of the closest pair
+	int target_entity = -1;
+};
+
+struct HitboxCollisionResult {
+	unsigned int frame = 0;
+	HitboxCollisionSide sides[2];
+	int hurtbox_count = 0;
+	double time_ms = 0.0;
+};
+
+/*Tells whether the active hitboxes would hit right now, and if not by how much they miss. Boxes are taken from every entity in
+the FrameSnapshot the same way the HitboxOverlay draws them, rotated boxes are tested with the box around their corners.
+The hurtboxes of a side are kept in SoA arrays so each hitbox is tested against 4 of them at once.*/
+class HitboxCollision
+{
+public:
+	static HitboxCollision& GetInstance();
+
+	// Runs the tests once per game frame, later calls during the same frame return the same result
+	const HitboxCollisionResult& Update();
+	const HitboxCollisionResult& GetResult() const { return m_result; }
+
+private:
+	HitboxCollision() = default;
+
+	struct Aabb {
+		float min_x, min_y, max_x, max_y;
+	};
+
+	void Gather(const FrameSnapshot& snapshot);
+	void AddEntityBoxes(const EntitySnapshot& snapshot);
+	void TestSide(int side);
+
+	// Arrays only ever grow, so after the first few frames Update doesn't allocate
+	std::vector<Aabb> m_hitboxes[2];
+	std::vector<int> m_hitboxEntity[2];
+	// padded to a multiple of 4 with boxes nothing can reach
+	std::vector<float> m_hurtMinX[2];
+	std::vector<float> m_hurtMinY[2];
+	std::vector<float> m_hurtMaxX[2];
+	std::vector<float> m_hurtMaxY[2];
+	std::vector<int> m_hurtEntity[2];
+
+	HitboxCollisionResult m_result;
+	bool m_hasResult = false;
+};
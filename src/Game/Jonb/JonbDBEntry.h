@@ -1,7 +1,17 @@
 #pragma once
-#include <vector>
-#include <string>
-#include <ctype.h>
+#include <cstdint>
+/*JONB layout: "JONB", uint16 image count, char[32] per image name, then the counts block. The counts block starts with an
+unknown byte followed by the uint16 amount of chunks, the hurtbox and hitbox counts are the bytes at +7 and +9, the rest are
+counts of box types not used here. After the counts block come the chunks and then the boxes, hurtboxes first, each laid out
+like a JonbEntry. JonbBoxDB decodes all of it.*/
+constexpr auto JONB_NAME_SIZE = 32;
+constexpr auto JONB_COUNTS_SIZE = 0xAD; //10 bytes up to the hitbox count + the 0xa3 bytes after it
+constexpr auto JONB_CHUNK_COUNT_OFFSET = 1;
+constexpr auto JONB_HURTBOX_COUNT_OFFSET = 7;
+constexpr auto JONB_HITBOX_COUNT_OFFSET = 9;
+constexpr auto JONB_CHUNK_SIZE = 0x40;
+constexpr auto JONB_BOX_SIZE = 20;
+
 enum BoxEntry_
 {
 	BoxEntryType_Hurtbox,
@@ -18,47 +28,6 @@ public:
 	float height;
 };
 
-class JonbDBEntry {
-public:
-	char JONB[4]; //just JONB  literal string + 2 bytes
-	uint16_t number_of_sprite_names; //the amount of sprite names, each sprite name is char[32]
-	//char sprite_name[32]; //for ex ar000_02.bmp  //std::vector<std::string>
-	std::vector<std::string> sprite_names;
-	//char pad_0[6];
-	//uint8_t pad_2;
-	uint8_t hurtbox_count;//uint8_t
-	//uint8_t pad_3;
-	uint8_t hitbox_count;//uint8_t
-	//char pad_1[0xa3];
-	//BoxEntry* all_boxes; //I should implement later, leave it for now for it is not necessary, can check hitbox/hurtbox count for current purpose
-	JonbDBEntry() {}
-	JonbDBEntry(char* addr){
-		char offset = 0;
-		memcpy(JONB, addr, 4);
-		offset += 4;
-		memcpy(&number_of_sprite_names, (addr + offset), 2);
-		offset += 2;
-		for (int i = 0; i < number_of_sprite_names; i++) {
-			std::string sprite_name = (char*)(addr + offset);
-			sprite_names.push_back(sprite_name);
-			offset += 32;
-			if (i > 10) {
-				hurtbox_count = 0;
-				hitbox_count = 0;
-				return;
-			}
-		}
-		offset += 6;
-		offset += 1;
-		memcpy(&hurtbox_count, (uint8_t*)(addr + offset),1);
-		offset += 1;
-		offset += 1;
-		memcpy(&hitbox_count, (uint8_t*)(addr + offset), 1);
-		offset += 1;
-		///this is where all the other offsets would come in to get the other things
-	}
-};
-
 class JonbDBIndexHeader {
 public:
 	char FPAC[4]; //just FPAC  literal string
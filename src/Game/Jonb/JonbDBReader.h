@@ -1,10 +1,21 @@
 #pragma once
-#include <map>
 #include <string>
+#include <vector>
 #include "JonbDBEntry.h"
+
+// One jonbin of an FPAC, as found through its index
+struct JonbFpacEntry {
+	const char* name; //jonbin name without the ".jonbin" extension, not null terminated
+	size_t name_length;
+	char* jonb; //the JONB data
+};
+
 class JonbDBReader
 {
 public:
-	std::map<std::string, JonbDBEntry>  parse_all_jonbins(char* bbcf_base_addr, int player_num);
+	// Finds the jonbin FPAC the game has loaded for the player(1 or 2), nullptr if there is none
+	static char* find_loaded_fpac(char* bbcf_base_addr, int player_num, bool& is_jubei, int32_t& char_index);
+	// Walks the index of a jonbin FPAC, either the one loaded by the game or a col_xx.pac extracted to disk. The entries point
+	// into the FPAC itself. end is one past the last byte of the file, nullptr when reading game memory.
+	static std::vector<JonbFpacEntry> read_fpac_index(char* fpac, bool is_jubei, const char* end = nullptr);
 };
-
@@ -0,0 +1,27 @@
+#include "JonbIndex.h"
+#include "JonbDBReader.h"
+#include "Core/logger.h"
+
+JonbIndex::PlayerIndex JonbIndex::s_players[2];
+
+const JonbBoxDB& JonbIndex::Get(char* bbcf_base_addr, int player_num)
+{
+	PlayerIndex& player = s_players[player_num == 2 ? 1 : 0];
+	bool is_jubei = false;
+	int32_t char_index = -1;
+	char* fpac = JonbDBReader::find_loaded_fpac(bbcf_base_addr, player_num, is_jubei, char_index);
+	if (fpac == player.fpac && char_index == player.char_index)
+	{
+		return player.boxes;
+	}
+
+	player.fpac = fpac;
+	player.char_index = char_index;
+	player.boxes.Clear();
+	if (fpac)
+	{
+		size_t sprite_count = player.boxes.AddFpac(fpac, is_jubei);
+		LOG(2, "JonbIndex: P%d jonbins indexed, %d sprites, %d boxes\n", player_num, (int)sprite_count, (int)player.boxes.GetBoxCount());
+	}
+	return player.boxes;
+}
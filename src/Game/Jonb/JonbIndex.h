@@ -0,0 +1,20 @@
+#pragma once
+#include "JonbBoxDB.h"
+
+/*Jonbin boxes of the characters the game has loaded, decoded once per character load and shared by the scr parser, the
+ScrWindow and the frame history instead of each of them walking the FPAC again.*/
+class JonbIndex
+{
+public:
+	// Index of the player's (1 or 2) character, rebuilt only when the game has loaded a different FPAC for that player.
+	// Empty if the player has no character loaded.
+	static const JonbBoxDB& Get(char* bbcf_base_addr, int player_num);
+
+private:
+	struct PlayerIndex {
+		char* fpac = nullptr;
+		int32_t char_index = -1;
+		JonbBoxDB boxes;
+	};
+	static PlayerIndex s_players[2];
+};
@@ -1,17 +1,28 @@
 #include "JonbReader.h"
 
-std::vector<JonbEntry> JonbReader::getJonbEntries(const CharData * charObj)
+JonbEntrySpan::JonbEntrySpan(const JonbEntry* entries, size_t hurtboxCount, size_t hitboxCount)
+	: m_entries(entries), m_hurtboxCount(hurtboxCount), m_hitboxCount(hitboxCount)
 {
-	std::vector<JonbEntry> jonbEntries;
+	if (!entries)
+	{
+		m_hurtboxCount = 0;
+		m_hitboxCount = 0;
+	}
+}
 
-	const int entriesCount = charObj->hurtboxCount + charObj->hitboxCount;
-	JonbEntry* pEntry = charObj->pJonbEntryBegin;
+const JonbEntry* JonbEntrySpan::At(size_t index) const
+{
+	return index < Size() ? m_entries + index : nullptr;
+}
 
-	for (int i = 0; i < entriesCount; i++)
+JonbEntrySpan JonbReader::getJonbEntries(const CharData* charObj)
+{
+	if (!charObj
+		|| charObj->hurtboxCount > JONB_MAX_ENTRIES_PER_TYPE
+		|| charObj->hitboxCount > JONB_MAX_ENTRIES_PER_TYPE)
 	{
-		jonbEntries.push_back(*pEntry);
-		pEntry++;
+		return JonbEntrySpan();
 	}
 
-	return jonbEntries;
+	return JonbEntrySpan(charObj->pJonbEntryBegin, charObj->hurtboxCount, charObj->hitboxCount);
 }
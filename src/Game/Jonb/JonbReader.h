@@ -2,10 +2,39 @@
 #include "../CharData.h"
 #include "JonbEntry.h"
 
-#include <vector>
+#include <cstddef>
+
+// The jonbin stores the box counts in a byte each, anything above means the CharData is garbage
+const size_t JONB_MAX_ENTRIES_PER_TYPE = 0xFF;
+
+// Non owning view over the jonb entries the game keeps for an entity, hurtboxes first then hitboxes.
+// Only valid until the game changes the entity's sprite, so don't keep it past the frame it was taken in.
+class JonbEntrySpan
+{
+public:
+	JonbEntrySpan() = default;
+	JonbEntrySpan(const JonbEntry* entries, size_t hurtboxCount, size_t hitboxCount);
+
+	const JonbEntry* begin() const { return m_entries; }
+	const JonbEntry* end() const { return m_entries + Size(); }
+	size_t Size() const { return m_hurtboxCount + m_hitboxCount; }
+	bool Empty() const { return Size() == 0; }
+	size_t HurtboxCount() const { return m_hurtboxCount; }
+	size_t HitboxCount() const { return m_hitboxCount; }
+	// nullptr if index is out of range
+	const JonbEntry* At(size_t index) const;
+	JonbEntrySpan Hurtboxes() const { return JonbEntrySpan(m_entries, m_hurtboxCount, 0); }
+	JonbEntrySpan Hitboxes() const { return JonbEntrySpan(m_entries + m_hurtboxCount, 0, m_hitboxCount); }
+
+private:
+	const JonbEntry* m_entries = nullptr;
+	size_t m_hurtboxCount = 0;
+	size_t m_hitboxCount = 0;
+};
 
 class JonbReader
 {
 public:
-	static std::vector<JonbEntry> getJonbEntries(const CharData* charObj);
+	// Empty if the entity has no entries or the counts are out of range
+	static JonbEntrySpan getJonbEntries(const CharData* charObj);
 };
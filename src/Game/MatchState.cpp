@@ -2,6 +2,7 @@
 
 #include "Core/interfaces.h"
 #include "Core/logger.h"
+#include "Game/GameEventBus.h"
 #include "Game/gamestates.h"
 #include "Game/ReplayFiles/ReplayFileManager.h"
 #include "Overlay/Window/PaletteEditorWindow.h"
@@ -9,6 +10,17 @@
 #include "Overlay/WindowContainer/WindowType.h"
 #include "Overlay/WindowManager.h"
 
+namespace
+{
+	void PublishMatchEvent(GameEventType type)
+	{
+		GameEvent event = {};
+		event.type = type;
+		event.frame = g_gameVals.pFrameCount ? *g_gameVals.pFrameCount : 0;
+		event.side = -1;
+		GameEventBus::GetInstance().Publish(event);
+	}
+}
 
 void MatchState::OnMatchInit()
 {
@@ -19,6 +31,8 @@ void MatchState::OnMatchInit()
 
 	LOG(2, "MatchState::OnMatchInit\n");
 
+	PublishMatchEvent(GameEventType_MatchInit);
+
 	g_interfaces.pPaletteManager->LoadPaletteSettingsFile();
 	g_interfaces.pPaletteManager->OnMatchInit(g_interfaces.player1, g_interfaces.player2);
 
@@ -77,6 +91,8 @@ void MatchState::OnMatchEnd()
 {
 	LOG(2, "MatchState::OnMatchEnd\n");
 
+	PublishMatchEvent(GameEventType_MatchEnd);
+
 	g_interfaces.pGameModeManager->EndGameMode();
 
 	g_interfaces.pPaletteManager->OnMatchEnd(
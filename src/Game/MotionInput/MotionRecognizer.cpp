@@ -0,0 +1,209 @@
+#include "MotionRecognizer.h"
+
+#include <cstring>
+
+namespace
+{
+	const uint16_t PACKED_DIRECTION_MASK = 0x000F;
+	const uint8_t DIRECTION_NEUTRAL = 5;
+
+	// Numpad directions clockwise, starting forward
+	const uint8_t ring[8] = { 6, 3, 2, 1, 4, 7, 8, 9 };
+	const uint8_t mirrored[10] = { 5, 3, 2, 1, 6, 5, 4, 9, 8, 7 };
+
+	int RingIndex(uint8_t direction)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			if (ring[i] == direction)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	// The directions rolled through on the short way from one to the other, 3 between 6 and 2
+	bool IsBetween(uint8_t from, uint8_t to, uint8_t direction)
+	{
+		const int a = RingIndex(from);
+		const int b = RingIndex(to);
+		const int d = RingIndex(direction);
+		if (a < 0 || b < 0 || d < 0)
+		{
+			return false;
+		}
+		const int forward = (b - a + 8) % 8;
+		if (forward == 4)
+		{
+			return false;
+		}
+		const int step = forward < 4 ? 1 : 7;
+		for (int i = (a + step) % 8; i != b; i = (i + step) % 8)
+		{
+			if (i == d)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Each character of steps is a direction that has to come after the previous one. Holding the previous one or
+	// rolling through the directions in between keeps the progress, anything else starts over.
+	void CompileSequence(MotionTable& table, const char* steps, uint8_t stepWindow, uint8_t totalWindow)
+	{
+		const int count = (int)strlen(steps);
+		memset(&table, 0, sizeof(table));
+		table.accept = (uint8_t)count;
+		table.stepWindow = stepWindow;
+		table.totalWindow = totalWindow;
+
+		const uint8_t first = (uint8_t)(steps[0] - '0');
+		for (int state = 0; state < count; state++)
+		{
+			const uint8_t expected = (uint8_t)(steps[state] - '0');
+			const uint8_t previous = state ? (uint8_t)(steps[state - 1] - '0') : 0;
+			for (uint8_t direction = 1; direction <= 9; direction++)
+			{
+				uint8_t next;
+				if (direction == expected)
+				{
+					next = (uint8_t)(state + 1);
+					if (state == 0)
+					{
+						next |= MOTION_RESTART;
+					}
+				}
+				else if (state && (direction == previous || IsBetween(previous, expected, direction)))
+				{
+					next = (uint8_t)state;
+				}
+				else if (direction == first)
+				{
+					next = 1 | MOTION_RESTART;
+				}
+				else
+				{
+					next = 0;
+				}
+				table.next[state][direction] = next;
+			}
+		}
+	}
+
+	// Every cardinal direction in any order. Diagonals hold the progress without counting for either of theirs, so
+	// rolling between two opposite diagonals (1 and 9, 3 and 7) isn't a 360.
+	void CompileFullCircle(MotionTable& table, uint8_t stepWindow, uint8_t totalWindow)
+	{
+		static const uint8_t cardinals[10] = { 0, 0, 1, 0, 2, 0, 4, 0, 8, 0 };
+		memset(&table, 0, sizeof(table));
+		table.accept = 15;
+		table.stepWindow = stepWindow;
+		table.totalWindow = totalWindow;
+		for (uint8_t state = 0; state < 16; state++)
+		{
+			for (uint8_t direction = 1; direction <= 9; direction++)
+			{
+				uint8_t next = state | cardinals[direction];
+				if (state == 0 && next)
+				{
+					next |= MOTION_RESTART;
+				}
+				table.next[state][direction] = next;
+			}
+		}
+	}
+
+	struct MotionTables
+	{
+		MotionTable tables[Motion_Count];
+
+		MotionTables()
+		{
+			CompileSequence(tables[Motion_236], "236", 10, 20);
+			CompileSequence(tables[Motion_214], "214", 10, 20);
+			CompileSequence(tables[Motion_623], "623", 10, 20);
+			CompileSequence(tables[Motion_41236], "41236", 8, 30);
+			CompileFullCircle(tables[Motion_360], 15, 40);
+			CompileSequence(tables[Motion_66], "656", 10, 15);
+			CompileSequence(tables[Motion_44], "454", 10, 15);
+		}
+	};
+
+	const MotionTables& Tables()
+	{
+		static const MotionTables tables;
+		return tables;
+	}
+}
+
+void MotionRecognizer::Reset()
+{
+	memset(m_runs, 0, sizeof(m_runs));
+	memset(m_durations, 0, sizeof(m_durations));
+}
+
+uint32_t MotionRecognizer::Step(uint16_t packedInput, bool facingLeft)
+{
+	uint8_t direction = (uint8_t)(packedInput & PACKED_DIRECTION_MASK);
+	if (direction < 1 || direction > 9)
+	{
+		direction = DIRECTION_NEUTRAL;
+	}
+	if (facingLeft)
+	{
+		direction = mirrored[direction];
+	}
+
+	const MotionTable* tables = Tables().tables;
+	uint32_t completed = 0;
+	for (int i = 0; i < Motion_Count; i++)
+	{
+		const MotionTable& table = tables[i];
+		Run& run = m_runs[i];
+		if (run.state)
+		{
+			run.sinceStep++;
+			run.sinceStart++;
+			if (run.sinceStep > table.stepWindow || run.sinceStart > table.totalWindow)
+			{
+				run.state = 0;
+			}
+		}
+
+		const uint8_t next = table.next[run.state][direction];
+		const uint8_t state = next & ~MOTION_RESTART;
+		if (next & MOTION_RESTART)
+		{
+			run.sinceStart = 0;
+			run.sinceStep = 0;
+		}
+		else if (state != run.state)
+		{
+			run.sinceStep = 0;
+		}
+		run.state = state;
+
+		if (state == table.accept)
+		{
+			completed |= 1u << i;
+			m_durations[i] = run.sinceStart;
+			run.state = table.next[0][direction] & ~MOTION_RESTART;
+			run.sinceStart = 0;
+			run.sinceStep = 0;
+		}
+	}
+	return completed;
+}
+
+const MotionTable& MotionRecognizer::GetTable(Motion motion)
+{
+	return Tables().tables[motion];
+}
+
+const char* MotionRecognizer::GetName(Motion motion)
+{
+	static const char* names[Motion_Count] = { "236", "214", "623", "41236", "360", "66", "44" };
+	return motion < Motion_Count ? names[motion] : "";
+}
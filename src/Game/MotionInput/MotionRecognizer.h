@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+
+constexpr int MOTION_MAX_STATES = 16;
+
+enum Motion : uint8_t
+{
+	Motion_236,
+	Motion_214,
+	Motion_623,
+	Motion_41236,
+	Motion_360,
+	Motion_66,
+	Motion_44,
+	Motion_Count
+};
+
+/*One automaton per motion, next is indexed by the state and the numpad direction (0 unused). An entry with
+MOTION_RESTART set starts the timing windows over, a motion has to reach accept without spending more than
+stepWindow frames between two steps or totalWindow frames in all.*/
+constexpr uint8_t MOTION_RESTART = 0x80;
+
+struct MotionTable
+{
+	uint8_t next[MOTION_MAX_STATES][10];
+	uint8_t accept;
+	uint8_t stepWindow;
+	uint8_t totalWindow;
+};
+
+// Recognizes the motions of one player from the packed battle inputs, Step is one game frame
+class MotionRecognizer
+{
+public:
+	MotionRecognizer() { Reset(); }
+	void Reset();
+
+	// Directions are mirrored when facing left so the motions are relative to the facing, like the game's own buffers.
+	// Returns a bit per Motion completed on this frame.
+	uint32_t Step(uint16_t packedInput, bool facingLeft);
+
+	// Frames the last completion of the motion took from its first step
+	uint16_t GetDuration(Motion motion) const { return m_durations[motion]; }
+
+	static const MotionTable& GetTable(Motion motion);
+	static const char* GetName(Motion motion);
+
+private:
+	struct Run
+	{
+		uint8_t state;
+		uint8_t sinceStep;
+		uint16_t sinceStart;
+	};
+
+	Run m_runs[Motion_Count];
+	uint16_t m_durations[Motion_Count];
+};
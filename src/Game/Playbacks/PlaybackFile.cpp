@@ -0,0 +1,135 @@
+#include "PlaybackFile.h"
+
+#include "PlaybackSlot.h"
+
+#include <cstring>
+#include <ctime>
+#include <fstream>
+
+void playback_encode_runs(const std::vector<uint16_t>& frames, std::vector<PlaybackRun>& runs)
+{
+	runs.clear();
+	for (uint16_t input : frames)
+	{
+		if (!runs.empty() && runs.back().input == input && runs.back().length < UINT16_MAX)
+		{
+			runs.back().length++;
+		}
+		else
+		{
+			runs.push_back({ input, 1 });
+		}
+	}
+}
+
+bool playback_decode_runs(const std::vector<PlaybackRun>& runs, uint32_t frame_count, std::vector<uint16_t>& frames)
+{
+	frames.clear();
+	frames.reserve(frame_count);
+	for (const PlaybackRun& run : runs)
+	{
+		if (run.length == 0 || frames.size() + run.length > frame_count)
+		{
+			return false;
+		}
+		frames.insert(frames.end(), run.length, run.input);
+	}
+	return frames.size() == frame_count;
+}
+
+bool playback_write_file(const std::string& path, const PlaybackData& playback)
+{
+	std::vector<PlaybackRun> runs;
+	playback_encode_runs(playback.frames, runs);
+	if (runs.size() > UINT16_MAX)
+	{
+		return false;
+	}
+
+	PlaybackFileHeader header = {};
+	memcpy(header.magic, "BBPB", 4);
+	header.version = PLAYBACK_FILE_VERSION;
+	header.facing_direction = (uint8_t)playback.facing_direction;
+	header.char_index = playback.char_index;
+	header.run_count = (uint16_t)runs.size();
+	header.frame_count = (uint32_t)playback.frames.size();
+	header.created = playback.created ? playback.created : (int64_t)time(nullptr);
+
+	std::ofstream out(path, std::ios::binary);
+	if (!out)
+	{
+		return false;
+	}
+	out.write((const char*)&header, sizeof(header));
+	if (!runs.empty())
+	{
+		out.write((const char*)runs.data(), runs.size() * sizeof(PlaybackRun));
+	}
+	return out.good();
+}
+
+bool playback_read_file(const std::string& path, PlaybackData& playback, std::string& error)
+{
+	playback = PlaybackData();
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		error = "can't open the file";
+		return false;
+	}
+	file.seekg(0, std::ios::end);
+	const size_t file_size = (size_t)file.tellg();
+	file.seekg(0, std::ios::beg);
+	if (file_size == 0)
+	{
+		error = "the file is empty";
+		return false;
+	}
+
+	PlaybackFileHeader header = {};
+	file.read((char*)&header, file_size < sizeof(header) ? file_size : sizeof(header));
+	if (file_size < sizeof(header.magic) || memcmp(header.magic, "BBPB", 4) != 0)
+	{
+		// Old raw dump, the facing byte then a byte per frame
+		std::vector<char> raw(file_size);
+		file.clear();
+		file.seekg(0, std::ios::beg);
+		file.read(raw.data(), file_size);
+		playback.facing_direction = raw[0];
+		playback.frames.assign((const uint8_t*)raw.data() + 1, (const uint8_t*)raw.data() + raw.size());
+		playback.legacy = true;
+		return true;
+	}
+
+	if (file_size < sizeof(header))
+	{
+		error = "the playback file is damaged";
+		return false;
+	}
+	if (header.version != PLAYBACK_FILE_VERSION)
+	{
+		error = "unsupported playback file version";
+		return false;
+	}
+	if (header.frame_count > PLAYBACK_SLOT_MAX_FRAMES || file_size < sizeof(header) + header.run_count * sizeof(PlaybackRun))
+	{
+		error = "the playback file is damaged";
+		return false;
+	}
+
+	std::vector<PlaybackRun> runs(header.run_count);
+	if (!runs.empty() && !file.read((char*)runs.data(), runs.size() * sizeof(PlaybackRun)))
+	{
+		error = "can't read the playback";
+		return false;
+	}
+	if (!playback_decode_runs(runs, header.frame_count, playback.frames))
+	{
+		error = "the playback file is damaged";
+		return false;
+	}
+	playback.facing_direction = (char)header.facing_direction;
+	playback.char_index = header.char_index;
+	playback.created = header.created;
+	return true;
+}
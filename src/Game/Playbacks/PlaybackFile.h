@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+.playback file, version 1:
+
+	PlaybackFileHeader
+	PlaybackRun runs[run_count]   the slot's frames run-length encoded, oldest first
+
+Every frame is the full uint16_t the game keeps in the slot, taunt and special included. Files without the magic
+are the old raw dumps: the facing byte, then one byte per frame with the high byte dropped. They still load.
+*/
+
+const uint16_t PLAYBACK_FILE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct PlaybackFileHeader
+{
+	char magic[4]; //"BBPB"
+	uint16_t version;
+	uint8_t facing_direction; //slot facing byte, 1 when recorded facing left
+	uint8_t reserved;
+	int16_t char_index; //character the playback was recorded on, -1 if unknown
+	uint16_t run_count;
+	uint32_t frame_count;
+	int64_t created; //unix time
+};
+
+struct PlaybackRun
+{
+	uint16_t input;
+	uint16_t length; //frames, never 0
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PlaybackFileHeader) == 24, "PlaybackFileHeader layout changed");
+static_assert(sizeof(PlaybackRun) == 4, "PlaybackRun layout changed");
+
+struct PlaybackData
+{
+	std::vector<uint16_t> frames;
+	char facing_direction = 0;
+	int16_t char_index = -1;
+	int64_t created = 0;
+	bool legacy = false; //read from an old raw dump
+};
+
+void playback_encode_runs(const std::vector<uint16_t>& frames, std::vector<PlaybackRun>& runs);
+bool playback_decode_runs(const std::vector<PlaybackRun>& runs, uint32_t frame_count, std::vector<uint16_t>& frames);
+
+bool playback_write_file(const std::string& path, const PlaybackData& playback);
+// Reads both the versioned files and the old raw dumps, error is set when it returns false
+bool playback_read_file(const std::string& path, PlaybackData& playback, std::string& error);
@@ -0,0 +1,190 @@
+#include "PlaybackLibrary.h"
+
+#include "PlaybackSlot.h"
+#include "Core/logger.h"
+
+#include <windows.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+
+#define PLAYBACK_FOLDER_PATH "slots"
+
+namespace
+{
+	std::vector<std::string> split_tags(const std::string& name)
+	{
+		std::vector<std::string> tags;
+		std::string tag;
+		for (char c : name)
+		{
+			if (c == '_' || c == '-' || c == ' ')
+			{
+				if (!tag.empty())
+				{
+					tags.push_back(tag);
+					tag.clear();
+				}
+				continue;
+			}
+			tag += (char)tolower((unsigned char)c);
+		}
+		if (!tag.empty())
+		{
+			tags.push_back(tag);
+		}
+		return tags;
+	}
+}
+
+PlaybackLibrary& PlaybackLibrary::GetInstance()
+{
+	static PlaybackLibrary instance;
+	return instance;
+}
+
+PlaybackLibrary::~PlaybackLibrary()
+{
+	// Static destruction runs in DllMain, the loader was already joined on WM_DESTROY if the game closed normally
+	stop_loading(false);
+}
+
+void PlaybackLibrary::start_loading()
+{
+	if (m_cancelled || m_loading.exchange(true))
+	{
+		return;
+	}
+	if (m_loader.joinable())
+	{
+		m_loader.join();
+	}
+	m_loader = std::thread(&PlaybackLibrary::load_folder, this);
+}
+
+void PlaybackLibrary::stop_loading(bool wait)
+{
+	m_cancelled = true;
+	if (!m_loader.joinable())
+	{
+		return;
+	}
+	// The loader publishes into m_entries, a cancelled one returns at the next file without touching them
+	if (wait)
+	{
+		m_loader.join();
+	}
+	else
+	{
+		m_loader.detach();
+	}
+}
+
+std::shared_ptr<const PlaybackLibraryEntries> PlaybackLibrary::get_entries() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_entries;
+}
+
+void PlaybackLibrary::load_folder()
+{
+	auto entries = std::make_shared<PlaybackLibraryEntries>();
+
+	WIN32_FIND_DATAA data;
+	HANDLE hFind = FindFirstFileA(PLAYBACK_FOLDER_PATH "\\*.playback", &data);
+	if (hFind != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if (m_cancelled)
+			{
+				break;
+			}
+			if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			{
+				continue;
+			}
+
+			PlaybackLibraryEntry entry;
+			entry.name = data.cFileName;
+			entry.name.erase(entry.name.size() - strlen(".playback"));
+			std::string error;
+			if (!playback_read_file(std::string(PLAYBACK_FOLDER_PATH "\\") + data.cFileName, entry.playback, error))
+			{
+				LOG(2, "PlaybackLibrary skipped %s: %s\n", data.cFileName, error.c_str());
+				continue;
+			}
+			if (entry.playback.frames.size() > PLAYBACK_SLOT_MAX_FRAMES)
+			{
+				entry.playback.frames.resize(PLAYBACK_SLOT_MAX_FRAMES);
+			}
+			entry.tags = split_tags(entry.name);
+			entries->push_back(std::move(entry));
+		} while (FindNextFileA(hFind, &data));
+		FindClose(hFind);
+	}
+	if (m_cancelled)
+	{
+		m_loading = false;
+		return;
+	}
+
+	std::sort(entries->begin(), entries->end(), [](const PlaybackLibraryEntry& a, const PlaybackLibraryEntry& b) {
+		return a.name < b.name;
+	});
+	LOG(2, "PlaybackLibrary loaded %d playbacks\n", (int)entries->size());
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries = entries;
+	}
+	m_loading = false;
+}
+
+bool PlaybackLibrary::matches(const PlaybackLibraryEntry& entry, int char_index, const std::string& tag)
+{
+	if (char_index >= 0 && entry.playback.char_index >= 0 && entry.playback.char_index != char_index)
+	{
+		return false;
+	}
+	if (tag.empty())
+	{
+		return true;
+	}
+	std::string lower(tag);
+	std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+	return std::find(entry.tags.begin(), entry.tags.end(), lower) != entry.tags.end();
+}
+
+bool PlaybackLibrary::load_into_slot(const PlaybackLibraryEntry& entry, int slot)
+{
+	if (slot < 1 || slot > 4)
+	{
+		return false;
+	}
+	PlaybackSlot target(slot);
+	target.set_facing_direction(entry.playback.facing_direction);
+	target.load_into_slot(entry.playback.frames);
+	return true;
+}
+
+std::string PlaybackLibrary::load_random_into_slot(int slot, int char_index, const std::string& tag)
+{
+	std::shared_ptr<const PlaybackLibraryEntries> entries = get_entries();
+	m_matches.clear();
+	for (const PlaybackLibraryEntry& entry : *entries)
+	{
+		if (matches(entry, char_index, tag))
+		{
+			m_matches.push_back(&entry);
+		}
+	}
+	if (m_matches.empty())
+	{
+		return "";
+	}
+
+	const PlaybackLibraryEntry& entry = *m_matches[std::rand() % m_matches.size()];
+	return load_into_slot(entry, slot) ? entry.name : "";
+}
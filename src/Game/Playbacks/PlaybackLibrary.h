@@ -0,0 +1,55 @@
+#pragma once
+#include "PlaybackFile.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PlaybackLibraryEntry
+{
+	std::string name; //file name without the extension
+	std::vector<std::string> tags; //lowercase words of the name, split on '_', '-' and spaces
+	PlaybackData playback;
+};
+
+typedef std::vector<PlaybackLibraryEntry> PlaybackLibraryEntries;
+
+/*Every .playback in the slots folder, decoded once on a loader thread so a playback can go into a slot on the
+frame it's needed without touching the disk. The entries are immutable once published, readers keep the
+shared_ptr they got and a reload swaps in a new list.*/
+class PlaybackLibrary
+{
+public:
+	static PlaybackLibrary& GetInstance();
+
+	// Starts reading the folder in the background, does nothing while a load is running
+	void start_loading();
+	bool is_loading() const { return m_loading; }
+	// Cancels a load in progress before the mod unloads, waits for the loader only if wait is set(not under the loader lock)
+	void stop_loading(bool wait = true);
+
+	std::shared_ptr<const PlaybackLibraryEntries> get_entries() const;
+
+	bool load_into_slot(const PlaybackLibraryEntry& entry, int slot);
+	// Puts a random entry recorded on char_index (-1 for any, unknown characters always match) with the tag ("" for any)
+	// into the slot, returns the entry's name or an empty string when nothing matched
+	std::string load_random_into_slot(int slot, int char_index, const std::string& tag);
+
+	static bool matches(const PlaybackLibraryEntry& entry, int char_index, const std::string& tag);
+
+private:
+	PlaybackLibrary() = default;
+	~PlaybackLibrary();
+
+	void load_folder();
+
+	mutable std::mutex m_mutex;
+	std::shared_ptr<const PlaybackLibraryEntries> m_entries = std::make_shared<PlaybackLibraryEntries>();
+	std::atomic<bool> m_loading{ false };
+	std::atomic<bool> m_cancelled{ false }; //the loader drops what it read and returns at the next file
+	std::thread m_loader;
+	std::vector<const PlaybackLibraryEntry*> m_matches; //load_random_into_slot scratch
+};
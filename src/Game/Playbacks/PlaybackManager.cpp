@@ -5,6 +5,7 @@
 #include <ostream>
 #include <windows.h>
 #include <fstream>
+#include "Core/logger.h"
 #include "Core/utils.h"
 
 
@@ -17,48 +18,38 @@ PlaybackManager::PlaybackManager()
     this->active_slot_p = this->bbcf_base_adress + this->active_slot_offset;
 }
 
-void  PlaybackManager::save_to_file(std::vector<char> slot_buffer, char facing_direction, char* fname) {
+void  PlaybackManager::save_to_file(const std::vector<uint16_t>& slot_buffer, char facing_direction, char* fname, int char_index) {
     CreateDirectory(L"slots", NULL);
 
     std::string fpath = "./slots/";
     fpath += fname;
     fpath += ".playback";
-    std::ofstream out(fpath);
-    out << facing_direction;
-    for (const auto& e : slot_buffer) out << e;
-    out.close();
+
+    PlaybackData playback;
+    playback.frames = slot_buffer;
+    playback.facing_direction = facing_direction;
+    playback.char_index = (int16_t)char_index;
+    if (!playback_write_file(fpath, playback)) {
+        LOG(2, "PlaybackManager::save_to_file couldn't write %s\n", fpath.c_str());
+    }
 }
-std::vector<char> PlaybackManager::load_from_file(char* fname) {
+bool PlaybackManager::load_from_file(char* fname, PlaybackData& playback) {
     std::string fpath = "./slots/";
     fpath += fname;
     if (fpath.find(".playback") == std::string::npos) {
         fpath += ".playback";
-        //fpath.substr(0, fpath.find(".playback") - 1);
-    }
-    //char* filename = "./slots/" + fpath;
-    std::streampos fileSize;
-    std::ifstream file(fpath, std::ios::binary);
-    if (file.good()) {
-        file.seekg(0, std::ios::end);
-        fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-
-        std::vector<char> fileData(fileSize);
-        file.read((char*)&fileData[0], fileSize);
-        return fileData;
     }
 
-    else {
-        std::vector<char> fd{};
-        return fd;
+    std::string error;
+    if (!playback_read_file(fpath, playback, error)) {
+        LOG(2, "PlaybackManager::load_from_file %s: %s\n", fpath.c_str(), error.c_str());
+        return false;
     }
-
-
+    return true;
 }
 
 
-std::vector<char> PlaybackManager::trim_playback(std::vector<char> slot_buffer) {
+std::vector<uint16_t> PlaybackManager::trim_playback(std::vector<uint16_t> slot_buffer) {
 
     if (!slot_buffer.empty()) {
         //trim the start
@@ -75,28 +66,26 @@ std::vector<char> PlaybackManager::trim_playback(std::vector<char> slot_buffer)
     return slot_buffer;
 }
 //this is the "load_trimmed_playback" function back in ScrWindow.cpp, loads from a buffer into a slot, this assumes the direction byte is already taken care of in caso of the buffer coming from a file
-void PlaybackManager::load_into_slot(std::vector<char> trimmed_playback, int slot) {
+void PlaybackManager::load_into_slot(const std::vector<uint16_t>& trimmed_playback, int slot) {
     //the playback is not necessarily trimmed btw, just leaving for reference until I overhaul scrwindow
     this->slots[slot - 1].load_into_slot(trimmed_playback);
 }
 //this version of the function takes the facing_left argument to set the direction byte as well
-void PlaybackManager::load_into_slot(std::vector<char> trimmed_playback, int facing_left, int slot) {
+void PlaybackManager::load_into_slot(const std::vector<uint16_t>& trimmed_playback, int facing_left, int slot) {
     //the playback is not necessarily trimmed btw, just leaving for reference until I overhaul scrwindow
-    *(PlaybackSlot(slot).facing_direction_p) = facing_left;
+    this->slots[slot - 1].set_facing_direction((char)facing_left);
     this->slots[slot - 1].load_into_slot(trimmed_playback);
 }
 void PlaybackManager::load_from_file_into_slot(char* fname, int slot)
 {
-    std::vector<char>loaded_file = this->load_from_file(fname);
-
-    if (!loaded_file.empty()) {
-        char facing_direction = loaded_file[0];
-        loaded_file.erase(loaded_file.begin());
-        //should make a set facing direction in the playbackslot maybe, if i'm not going to make a class to represent the playback by itself
-        memcpy(this->slots[slot - 1].facing_direction_p, &(facing_direction), sizeof(char));
+    PlaybackData playback;
+    if (!this->load_from_file(fname, playback)) {
+        return;
     }
-    if (!loaded_file.empty()) {
-        this->slots[slot - 1].load_into_slot(loaded_file);
+
+    this->slots[slot - 1].set_facing_direction(playback.facing_direction);
+    if (!playback.frames.empty()) {
+        this->slots[slot - 1].load_into_slot(playback.frames);
     }
 }
 
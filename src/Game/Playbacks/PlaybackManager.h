@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include "PlaybackFile.h"
 #include "PlaybackSlot.h"
 #include <array>
 class PlaybackManager
@@ -14,11 +15,11 @@ public:
 	std::vector<PlaybackSlot> slots; //one for each of the 4 playback slots
 
 	
-	void save_to_file(std::vector<char> slot_buffer, char facing_direction, char* fname);
-	std::vector<char> load_from_file(char* fname);/*returns the contents of the file*/
-	std::vector<char> trim_playback(std::vector<char> slot_buffer);
-	void load_into_slot(std::vector<char> trimmed_playback, int slot); /*this is the "load_trimmed_playback" function back in ScrWindow.cpp, loads from a buffer into a slot, this assumes the direction byte is already taken care of in caso of the buffer coming from a file*/
-	void load_into_slot(std::vector<char> trimmed_playback, int facing_left, int slot); /*this is the "load_trimmed_playback" function back in ScrWindow.cpp, loads from a buffer into a slot, this assumes the direction byte is already taken care of in caso of the buffer coming from a file*/
+	void save_to_file(const std::vector<uint16_t>& slot_buffer, char facing_direction, char* fname, int char_index = -1); /*writes a versioned .playback, see PlaybackFile.h*/
+	bool load_from_file(char* fname, PlaybackData& playback);/*reads the new files and the old raw dumps, false if it couldn't*/
+	std::vector<uint16_t> trim_playback(std::vector<uint16_t> slot_buffer);
+	void load_into_slot(const std::vector<uint16_t>& trimmed_playback, int slot); /*this is the "load_trimmed_playback" function back in ScrWindow.cpp, loads from a buffer into a slot, this assumes the direction byte is already taken care of in caso of the buffer coming from a file*/
+	void load_into_slot(const std::vector<uint16_t>& trimmed_playback, int facing_left, int slot); /*this is the "load_trimmed_playback" function back in ScrWindow.cpp, loads from a buffer into a slot, this assumes the direction byte is already taken care of in caso of the buffer coming from a file*/
 
 	void load_from_file_into_slot(char* fname, int slot); /*loads from a file into a slot doing the necessary checks to ensure the file is valid, the facing byte is correctly set and won't crash*/
 	void set_active_slot(int slot);
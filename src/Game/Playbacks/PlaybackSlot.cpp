@@ -34,24 +34,25 @@ char* PlaybackSlot::initialize_start_of_slot_inputs_p(int slot)
 	return this->start_of_slot_inputs_p;
 }
 
-void PlaybackSlot::load_into_slot(std::vector<char> trimmed_playback) {
-	int frame_len_loaded_file = trimmed_playback.size();
-	memcpy(this->frame_len_slot_p, &(frame_len_loaded_file), 4);
-	int iter = 0;
-	for (auto input : trimmed_playback) {
-		memcpy(this->start_of_slot_inputs_p + (iter * 2), &input, 1); //sets the move
-		memset(this->start_of_slot_inputs_p + (iter * 2)+1,0x0 , 1); //zeroes the taunt(?) flag. The next step is to change all the shit regarding playback from chars to uint16, so that the extra byte for taunt(?) is included and not just zeroed
-		iter++;
+void PlaybackSlot::load_into_slot(const std::vector<uint16_t>& frames) {
+	int frame_len = frames.size() > PLAYBACK_SLOT_MAX_FRAMES ? PLAYBACK_SLOT_MAX_FRAMES : (int)frames.size();
+	//the slot keeps the same uint16_t per frame, the whole playback goes in with one copy
+	if (frame_len) {
+		memcpy(this->start_of_slot_inputs_p, frames.data(), frame_len * sizeof(uint16_t));
 	}
+	memcpy(this->frame_len_slot_p, &frame_len, 4);
 }
-std::vector<char> PlaybackSlot::get_slot_buffer() {
-	std::vector<char> slot1_recording_frames{};
+std::vector<uint16_t> PlaybackSlot::get_slot_buffer() {
 	int frame_len_slot;
-	memcpy(&frame_len_slot, this->frame_len_slot_p, 4); // probably unnecessary, but dont have the time to test rn so i'll copy what i had before
-	for (int i = 0; i < frame_len_slot; i++) {
-		slot1_recording_frames.push_back(*(this->start_of_slot_inputs_p + i * 2));
+	memcpy(&frame_len_slot, this->frame_len_slot_p, 4);
+	if (frame_len_slot < 0 || frame_len_slot > PLAYBACK_SLOT_MAX_FRAMES) {
+		frame_len_slot = 0;
+	}
+	std::vector<uint16_t> frames(frame_len_slot);
+	if (frame_len_slot) {
+		memcpy(frames.data(), this->start_of_slot_inputs_p, frame_len_slot * sizeof(uint16_t));
 	}
-	return slot1_recording_frames;
+	return frames;
 }
 
 char PlaybackSlot::get_facing_direction()
@@ -59,3 +60,8 @@ char PlaybackSlot::get_facing_direction()
 	return *(this->facing_direction_p);
 }
 
+void PlaybackSlot::set_facing_direction(char facing_direction)
+{
+	*(this->facing_direction_p) = facing_direction;
+}
+
@@ -1,6 +1,10 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 
+// The slots are 0x960 bytes apart in the game's memory, more frames would run into the next slot
+const int PLAYBACK_SLOT_MAX_FRAMES = 0x960 / 2;
+
 class PlaybackSlot
 {
 public:
@@ -8,10 +12,11 @@ public:
 	int initialize_frame_len_slot(int slot);/*initializes the frame_len_slot for the specified slot*/
 	int initialize_facing_direction_slot(int slot); /*initializes the facing_direction for the specified slot*/
 	char* initialize_start_of_slot_inputs_p(int slot); /*initializes the start_of_slot_inputs_p for the specified slot*/
-	void load_into_slot(std::vector<char> trimmed_playback); //this is the "load_trimmed_playback" function back in ScrWindow.cpp
+	void load_into_slot(const std::vector<uint16_t>& frames); //this is the "load_trimmed_playback" function back in ScrWindow.cpp, frames past PLAYBACK_SLOT_MAX_FRAMES are dropped
 
-	std::vector<char> get_slot_buffer();
+	std::vector<uint16_t> get_slot_buffer(); /*every frame of the slot, taunt and special included*/
 	char get_facing_direction();
+	void set_facing_direction(char facing_direction);
 	
 	
 
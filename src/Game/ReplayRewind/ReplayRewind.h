@@ -10,6 +10,8 @@ public:
     ReplayRewind();
 	void OnUpdate();
     void rewind_to_nearest();
+	// From the EntityTracker as of the last FrameSnapshot capture, every game frame in battle and every rendered frame
+	// otherwise. Good for display, code that acts on the count in the same frame has to read the entity list itself.
 	unsigned int count_entities(bool unk_status2);
 	std::vector<int> find_nearest_checkpoint(std::vector<unsigned int>);
 
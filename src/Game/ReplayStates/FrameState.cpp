@@ -123,10 +123,6 @@ std::map<CharData*, CharData> FrameState::save_owned_entities() {
                 }
             }
         }
-    std::vector<CharData**> entities{};// = *g_gameVals.pEntityList;
-    for (int i = 0; i < 252; i++) {
-        entities.push_back((CharData**)(g_gameVals.pEntityList+i));
-    }
     //general entities
     /*for (auto entity : entities) {
         if (entity != NULL) {
@@ -0,0 +1,145 @@
+#include "ReplayTakeoverStream.h"
+
+#include "Core/interfaces.h"
+#include "Core/utils.h"
+#include "Game/gamestates.h"
+
+namespace
+{
+	// bbcf_base + REPLAY_INPUTS_OFFSET + REPLAY_PLAYER_STRIDE * player + REPLAY_ROUND_STRIDE * round is the first frame
+	const uint32_t REPLAY_INPUTS_OFFSET = 0x115B470 + 0x8d4;
+	const uint32_t REPLAY_PLAYER_STRIDE = 0x7080;
+	const uint32_t REPLAY_ROUND_STRIDE = 0xE100;
+	const uint32_t REPLAY_ROUND_FRAMES = REPLAY_PLAYER_STRIDE / 2;
+	const uint32_t REPLAY_ROUNDS = 3;
+
+	// Frames past the end of the recording are zeroed, a recorded frame always has a direction
+	bool IsRecordedInput(uint16_t packed)
+	{
+		const uint16_t direction = packed & 0x000F;
+		return direction >= 1 && direction <= 9;
+	}
+}
+
+ReplayTakeoverStream& ReplayTakeoverStream::GetInstance()
+{
+	static ReplayTakeoverStream instance;
+	return instance;
+}
+
+uint32_t ReplayTakeoverStream::Capture(uint32_t player, uint32_t round, uint32_t frame)
+{
+	Stop();
+	if (player > 1 || round >= REPLAY_ROUNDS || frame >= REPLAY_ROUND_FRAMES)
+	{
+		return 0;
+	}
+
+	const uint16_t* first = (const uint16_t*)(GetBbcfBaseAdress() + REPLAY_INPUTS_OFFSET
+		+ REPLAY_PLAYER_STRIDE * player + REPLAY_ROUND_STRIDE * round) + frame;
+	uint32_t length = 0;
+	while (length < REPLAY_ROUND_FRAMES - frame && IsRecordedInput(first[length]))
+	{
+		length++;
+	}
+	auto inputs = std::make_shared<const std::vector<uint16_t>>(first, first + length);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_captured = inputs;
+	m_released.reset();
+	m_capturedPlayer = player;
+	m_capturedLength = length;
+	return length;
+}
+
+void ReplayTakeoverStream::Start()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_captured || m_captured->empty())
+	{
+		return;
+	}
+	m_stopRequested.store(false, std::memory_order_relaxed);
+	m_startRequested.store(true, std::memory_order_release);
+}
+
+void ReplayTakeoverStream::Stop()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_startRequested.store(false, std::memory_order_relaxed);
+	m_stopRequested.store(true, std::memory_order_release);
+	m_active.store(false, std::memory_order_relaxed);
+}
+
+bool ReplayTakeoverStream::Tick(uint32_t player, uint16_t& packedOut)
+{
+	if (m_stopRequested.exchange(false, std::memory_order_acquire))
+	{
+		m_hasLastFrame = false;
+		m_next = 0;
+	}
+	if (m_startRequested.load(std::memory_order_acquire) && m_mutex.try_lock())
+	{
+		// Inputs replaced by a Capture go to released, the next Capture frees them off the game thread.
+		// Released is always empty here, it's only set by the first Start after a Capture.
+		if (m_running != m_captured)
+		{
+			m_released = std::move(m_running);
+			m_running = m_captured;
+		}
+		m_runningPlayer = m_capturedPlayer;
+		m_next = 0;
+		m_hasLastFrame = false;
+		m_events.attached = false;
+		m_position.store(0, std::memory_order_relaxed);
+		m_active.store(true, std::memory_order_relaxed);
+		m_startRequested.store(false, std::memory_order_relaxed);
+		m_mutex.unlock();
+	}
+
+	if (!m_running || !m_active.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	// The captured inputs only make sense in the training match they were loaded into
+	bool matchChanged = false;
+	GameEvent event;
+	while (GameEventBus::GetInstance().Poll(m_events, event))
+	{
+		matchChanged |= event.type == GameEventType_MatchInit || event.type == GameEventType_MatchEnd;
+	}
+	if (matchChanged || !g_gameVals.pGameMode || *g_gameVals.pGameMode != GameMode_Training)
+	{
+		m_active.store(false, std::memory_order_relaxed);
+		return false;
+	}
+
+	if (player != m_runningPlayer)
+	{
+		return false;
+	}
+
+	// The writer can run more than once on a game frame, the stream only moves when the frame does
+	if (g_gameVals.pFrameCount)
+	{
+		const unsigned int frame = *g_gameVals.pFrameCount;
+		if (m_hasLastFrame && frame == m_lastFrame)
+		{
+			packedOut = m_lastPacked;
+			return true;
+		}
+		m_hasLastFrame = true;
+		m_lastFrame = frame;
+	}
+
+	if (m_next >= m_running->size())
+	{
+		m_active.store(false, std::memory_order_relaxed);
+		return false;
+	}
+	m_lastPacked = (*m_running)[m_next++];
+	m_position.store(m_next, std::memory_order_relaxed);
+	packedOut = m_lastPacked;
+	return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "Game/GameEventBus.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*Feeds a player's recorded replay inputs into the battle input hook after a replay takeover. Capture copies the
+rest of the round out of the game's replay input buffer in one go, Start plays it from its first frame on the next
+game frame, as many times as the state is reloaded. The hook only takes the captured inputs with a try_lock, never
+allocates and never frees them. The stream stops by itself out of training mode and when a match starts or ends.*/
+class ReplayTakeoverStream
+{
+public:
+	static ReplayTakeoverStream& GetInstance();
+
+	// The player's inputs of the round from the frame on, up to the end of what was recorded. Stops a running stream.
+	// Returns the frames captured.
+	uint32_t Capture(uint32_t player, uint32_t round, uint32_t frame);
+	void Start();
+	void Stop();
+
+	// Called from the battle input hook, false when the stream doesn't write the player's input
+	bool Tick(uint32_t player, uint16_t& packedOut);
+
+	bool IsActive() const { return m_active.load(std::memory_order_relaxed); }
+	uint32_t GetPlayer() const { return m_capturedPlayer; }
+	uint32_t GetPosition() const { return m_position.load(std::memory_order_relaxed); }
+	uint32_t GetLength() const { return m_capturedLength; }
+
+private:
+	ReplayTakeoverStream() = default;
+
+	// Hook only
+	std::shared_ptr<const std::vector<uint16_t>> m_running;
+	uint32_t m_runningPlayer = 0;
+	uint32_t m_next = 0;
+	bool m_hasLastFrame = false;
+	unsigned int m_lastFrame = 0;
+	uint16_t m_lastPacked = 0;
+	GameEventCursor m_events; //MatchInit and MatchEnd since the stream started
+
+	// Capture and Start hand over through these
+	std::mutex m_mutex;
+	std::shared_ptr<const std::vector<uint16_t>> m_captured;
+	std::shared_ptr<const std::vector<uint16_t>> m_released; //what the hook let go of, freed by the next Capture
+	uint32_t m_capturedPlayer = 0;
+	uint32_t m_capturedLength = 0;
+	std::atomic<bool> m_startRequested{ false };
+	std::atomic<bool> m_stopRequested{ false };
+
+	// For the windows
+	std::atomic<bool> m_active{ false };
+	std::atomic<uint32_t> m_position{ 0 };
+};
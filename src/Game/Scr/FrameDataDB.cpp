@@ -0,0 +1,432 @@
+#include "FrameDataDB.h"
+#include "ScrStateParser.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const char FRAME_DATA_DB_MAGIC[4] = { 'B', 'B', 'F', 'D' };
+
+	uint16_t clamp_u16(unsigned int value)
+	{
+		return (uint16_t)std::min<unsigned int>(value, std::numeric_limits<uint16_t>::max());
+	}
+
+	// Both CharData::char_abbr and the state names are fixed size and not always null terminated
+	bool fixed_equals(const char* fixed, size_t fixed_size, const char* str)
+	{
+		size_t i = 0;
+		for (; i < fixed_size && fixed[i]; i++)
+		{
+			if (fixed[i] != str[i])
+			{
+				return false;
+			}
+		}
+		return i == fixed_size || str[i] == 0;
+	}
+
+	uint32_t slot_count_for(uint32_t record_count)
+	{
+		uint32_t count = 8;
+		while (count < record_count * 2)
+		{
+			count <<= 1;
+		}
+		return count;
+	}
+}
+
+// FNV-1a over at most the 32 characters a state name can hold
+uint32_t frame_data_name_hash(const char* name)
+{
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < 32 && name[i]; i++)
+	{
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+FrameDataDB::~FrameDataDB()
+{
+	Close();
+}
+
+bool FrameDataDB::Open(const char* path)
+{
+	Close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(FrameDataDBHeader) || size.HighPart != 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+	m_data = (const char*)view;
+	m_size = (size_t)size.QuadPart;
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(FrameDataDBHeader))
+	{
+		close(fd);
+		return false;
+	}
+	void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+	m_data = (const char*)view;
+	m_size = (size_t)st.st_size;
+#endif
+
+	if (!Validate(m_size))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void FrameDataDB::Close()
+{
+#ifdef _WIN32
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle)
+	{
+		CloseHandle((HANDLE)m_mappingHandle);
+	}
+	if (m_fileHandle)
+	{
+		CloseHandle((HANDLE)m_fileHandle);
+	}
+#else
+	if (m_data)
+	{
+		munmap((void*)m_data, m_size);
+	}
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_header = nullptr;
+	m_characters = nullptr;
+	m_records = nullptr;
+	m_slots = nullptr;
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+}
+
+bool FrameDataDB::IsOpen() const
+{
+	return m_header != nullptr;
+}
+
+// Checks every offset once so the lookups don't have to
+bool FrameDataDB::Validate(size_t size)
+{
+	const FrameDataDBHeader* header = (const FrameDataDBHeader*)m_data;
+	if (memcmp(header->magic, FRAME_DATA_DB_MAGIC, 4) != 0 || header->version != FRAME_DATA_DB_VERSION
+		|| header->record_size != sizeof(FrameDataRecord))
+	{
+		return false;
+	}
+	uint64_t offset = sizeof(FrameDataDBHeader);
+	uint64_t characters_size = (uint64_t)header->character_count * sizeof(FrameDataDBCharacter);
+	if (offset + characters_size > size)
+	{
+		return false;
+	}
+	const FrameDataDBCharacter* characters = (const FrameDataDBCharacter*)(m_data + offset);
+	offset += characters_size;
+
+	uint64_t record_count = 0;
+	uint64_t slot_count = 0;
+	for (uint32_t i = 0; i < header->character_count; i++)
+	{
+		const FrameDataDBCharacter& character = characters[i];
+		if (character.first_record != record_count || character.first_slot != slot_count
+			|| character.slot_count == 0 || (character.slot_count & (character.slot_count - 1)) != 0
+			|| character.slot_count <= character.record_count)
+		{
+			return false;
+		}
+		record_count += character.record_count;
+		slot_count += character.slot_count;
+	}
+	if (offset + record_count * sizeof(FrameDataRecord) + slot_count * sizeof(uint32_t) != size)
+	{
+		return false;
+	}
+	const FrameDataRecord* records = (const FrameDataRecord*)(m_data + offset);
+	const uint32_t* slots = (const uint32_t*)(m_data + offset + record_count * sizeof(FrameDataRecord));
+	for (uint32_t i = 0; i < header->character_count; i++)
+	{
+		const FrameDataDBCharacter& character = characters[i];
+		for (uint32_t s = 0; s < character.slot_count; s++)
+		{
+			if (slots[character.first_slot + s] > character.record_count)
+			{
+				return false;
+			}
+		}
+	}
+
+	m_header = header;
+	m_characters = characters;
+	m_records = records;
+	m_slots = slots;
+	return true;
+}
+
+uint32_t FrameDataDB::GetCharacterCount() const
+{
+	return m_header ? m_header->character_count : 0;
+}
+
+const FrameDataDBCharacter* FrameDataDB::GetCharacter(uint32_t index) const
+{
+	if (index >= GetCharacterCount())
+	{
+		return nullptr;
+	}
+	return &m_characters[index];
+}
+
+const FrameDataDBCharacter* FrameDataDB::FindCharacter(const char* abbr) const
+{
+	for (uint32_t i = 0; i < GetCharacterCount(); i++)
+	{
+		if (fixed_equals(m_characters[i].abbr, sizeof(m_characters[i].abbr), abbr))
+		{
+			return &m_characters[i];
+		}
+	}
+	return nullptr;
+}
+
+const FrameDataRecord* FrameDataDB::GetRecords(const FrameDataDBCharacter* character) const
+{
+	if (!character)
+	{
+		return nullptr;
+	}
+	return m_records + character->first_record;
+}
+
+const FrameDataRecord* FrameDataDB::Find(const FrameDataDBCharacter* character, const char* state_name) const
+{
+	if (!character || !state_name)
+	{
+		return nullptr;
+	}
+	const FrameDataRecord* records = GetRecords(character);
+	const uint32_t* slots = m_slots + character->first_slot;
+	uint32_t mask = character->slot_count - 1;
+	uint32_t hash = frame_data_name_hash(state_name);
+	// Validate made sure the table is never full, so there is always an empty slot to stop at
+	for (uint32_t i = hash & mask;; i = (i + 1) & mask)
+	{
+		uint32_t slot = slots[i];
+		if (slot == 0)
+		{
+			return nullptr;
+		}
+		const FrameDataRecord& record = records[slot - 1];
+		if (record.name_hash == hash && fixed_equals(record.name, sizeof(record.name), state_name))
+		{
+			return &record;
+		}
+	}
+}
+
+const FrameDataRecord* FrameDataDB::Find(const char* abbr, const char* state_name) const
+{
+	return Find(FindCharacter(abbr), state_name);
+}
+
+FrameDataDBBuilder::Character& FrameDataDBBuilder::GetOrAddCharacter(const std::string& abbr)
+{
+	for (auto& character : m_characters)
+	{
+		if (character.abbr == abbr)
+		{
+			character.records.clear();
+			return character;
+		}
+	}
+	m_characters.push_back(Character());
+	m_characters.back().abbr = abbr;
+	return m_characters.back();
+}
+
+void FrameDataDBBuilder::AddCharacter(const std::string& abbr, const std::vector<scrState*>& states)
+{
+	Character& character = GetOrAddCharacter(abbr);
+	character.records.reserve(states.size());
+	for (const scrState* state : states)
+	{
+		FrameDataRecord record{};
+		memcpy(record.name, state->name.c_str(), std::min(state->name.size(), sizeof(record.name)));
+		record.name_hash = frame_data_name_hash(record.name);
+
+		ScrFrameData frame_data = summarize_frame_data(state);
+		record.frames = clamp_u16(frame_data.total);
+		record.startup = clamp_u16(frame_data.startup);
+		record.active = clamp_u16(frame_data.active);
+		record.recovery = clamp_u16(frame_data.recovery);
+		record.invuln_start = clamp_u16(frame_data.invuln_start);
+		record.invuln_end = clamp_u16(frame_data.invuln_end);
+		record.damage = state->damage;
+		record.atk_type = clamp_u16(state->atk_type);
+		record.atk_level = clamp_u16(state->atk_level);
+		record.hitstun = clamp_u16(state->hitstun);
+		record.blockstun = clamp_u16(state->blockstun);
+		record.hitstop = clamp_u16(state->hitstop);
+		record.starter_rating = clamp_u16(state->starter_rating);
+		record.attack_p1 = state->attack_p1;
+		record.attack_p2 = state->attack_p2;
+		for (size_t i = 0; i < state->frame_activity_status.size(); i++)
+		{
+			if (state->frame_activity_status[i] == FrameActivity::Active)
+			{
+				record.first_active = clamp_u16(i + 1);
+				break;
+			}
+		}
+		if (frame_data.non_deterministic)
+			record.flags |= FrameDataRecordFlags_NonDeterministic;
+		if (state->hit_overhead)
+			record.flags |= FrameDataRecordFlags_Overhead;
+		if (state->hit_low)
+			record.flags |= FrameDataRecordFlags_Low;
+		if (state->hit_air_unblockable)
+			record.flags |= FrameDataRecordFlags_AirUnblockable;
+		if (state->fatal_counter)
+			record.flags |= FrameDataRecordFlags_FatalCounter;
+		character.records.push_back(record);
+	}
+}
+
+void FrameDataDBBuilder::AddCharacter(const std::string& abbr, const FrameDataRecord* records, uint32_t count)
+{
+	Character& character = GetOrAddCharacter(abbr);
+	character.records.assign(records, records + count);
+}
+
+bool FrameDataDBBuilder::HasCharacter(const std::string& abbr) const
+{
+	for (auto& character : m_characters)
+	{
+		if (character.abbr == abbr)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FrameDataDBBuilder::Write(const char* path) const
+{
+	FrameDataDBHeader header{};
+	memcpy(header.magic, FRAME_DATA_DB_MAGIC, 4);
+	header.version = FRAME_DATA_DB_VERSION;
+	header.character_count = (uint32_t)m_characters.size();
+	header.record_size = sizeof(FrameDataRecord);
+
+	std::vector<FrameDataDBCharacter> table;
+	std::vector<FrameDataRecord> records;
+	std::vector<uint32_t> slots;
+	for (auto& character : m_characters)
+	{
+		FrameDataDBCharacter entry{};
+		memcpy(entry.abbr, character.abbr.c_str(), std::min(character.abbr.size(), sizeof(entry.abbr)));
+		entry.first_record = (uint32_t)records.size();
+		entry.first_slot = (uint32_t)slots.size();
+		entry.slot_count = slot_count_for((uint32_t)character.records.size());
+		slots.resize(slots.size() + entry.slot_count, 0);
+		uint32_t* character_slots = slots.data() + entry.first_slot;
+		uint32_t mask = entry.slot_count - 1;
+
+		for (auto& record : character.records)
+		{
+			// Scripts can define a state twice, the game uses the first one so that's the one that gets indexed
+			uint32_t i = record.name_hash & mask;
+			bool duplicate = false;
+			for (; character_slots[i]; i = (i + 1) & mask)
+			{
+				const FrameDataRecord& other = records[entry.first_record + character_slots[i] - 1];
+				if (other.name_hash == record.name_hash && strncmp(other.name, record.name, sizeof(record.name)) == 0)
+				{
+					duplicate = true;
+					break;
+				}
+			}
+			if (duplicate)
+			{
+				continue;
+			}
+			records.push_back(record);
+			entry.record_count++;
+			character_slots[i] = entry.record_count;
+		}
+		table.push_back(entry);
+	}
+
+	FILE* file = fopen(path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && (table.empty() || fwrite(table.data(), sizeof(FrameDataDBCharacter), table.size(), file) == table.size());
+	ok = ok && (records.empty() || fwrite(records.data(), sizeof(FrameDataRecord), records.size(), file) == records.size());
+	ok = ok && (slots.empty() || fwrite(slots.data(), sizeof(uint32_t), slots.size(), file) == slots.size());
+	ok = fclose(file) == 0 && ok;
+	return ok;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ScrStateEntry.h"
+
+/*Frame data database, a single file holding the precomputed move properties of every character so the overlay can look them
+up without parsing scripts. Layout, all little endian:
+	FrameDataDBHeader
+	FrameDataDBCharacter[character_count]
+	FrameDataRecord[sum of record_count]
+	uint32_t slots[sum of slot_count], open addressing hash index per character, value is record index + 1, 0 is empty
+The file is memory mapped as is, so records are fixed size and nothing needs to be decoded at runtime.*/
+
+constexpr uint32_t FRAME_DATA_DB_VERSION = 2;
+constexpr auto FRAME_DATA_DB_PATH = "BBCF_IM/framedata.bin";
+
+enum FrameDataRecordFlags_ : uint16_t
+{
+	FrameDataRecordFlags_NonDeterministic = 0x1,
+	FrameDataRecordFlags_Overhead = 0x2,
+	FrameDataRecordFlags_Low = 0x4,
+	FrameDataRecordFlags_AirUnblockable = 0x8,
+	FrameDataRecordFlags_FatalCounter = 0x10,
+};
+
+struct FrameDataDBHeader
+{
+	char magic[4]; //"BBFD"
+	uint32_t version;
+	uint32_t character_count;
+	uint32_t record_size; //sizeof(FrameDataRecord) of the writer, guards against layout changes without a version bump
+};
+
+struct FrameDataDBCharacter
+{
+	char abbr[4]; //same as CharData::char_abbr
+	uint32_t first_record;
+	uint32_t record_count;
+	uint32_t first_slot;
+	uint32_t slot_count; //power of two
+};
+
+struct FrameDataRecord
+{
+	char name[32];
+	uint32_t name_hash;
+	uint16_t frames;
+	uint16_t startup;
+	uint16_t active;
+	uint16_t recovery;
+	uint16_t invuln_start;
+	uint16_t invuln_end;
+	uint32_t damage;
+	uint16_t atk_type;
+	uint16_t atk_level;
+	uint16_t hitstun;
+	uint16_t blockstun;
+	uint16_t hitstop;
+	uint16_t starter_rating;
+	uint16_t flags; //FrameDataRecordFlags_
+	uint16_t first_active; //first active frame that isn't in a non deterministic sprite, counted from 1, 0 if none
+	uint32_t attack_p1;
+	uint32_t attack_p2;
+	uint32_t reserved;
+};
+static_assert(sizeof(FrameDataDBHeader) == 16, "FrameDataDBHeader layout changed");
+static_assert(sizeof(FrameDataDBCharacter) == 20, "FrameDataDBCharacter layout changed");
+static_assert(sizeof(FrameDataRecord) == 80, "FrameDataRecord layout changed, bump FRAME_DATA_DB_VERSION");
+
+uint32_t frame_data_name_hash(const char* name);
+
+// Read only view over a mapped database file. Lookups never allocate.
+class FrameDataDB
+{
+public:
+	FrameDataDB() = default;
+	~FrameDataDB();
+	FrameDataDB(const FrameDataDB&) = delete;
+	FrameDataDB& operator=(const FrameDataDB&) = delete;
+
+	bool Open(const char* path);
+	void Close();
+	bool IsOpen() const;
+
+	uint32_t GetCharacterCount() const;
+	const FrameDataDBCharacter* GetCharacter(uint32_t index) const;
+	const FrameDataDBCharacter* FindCharacter(const char* abbr) const;
+	const FrameDataRecord* GetRecords(const FrameDataDBCharacter* character) const;
+	const FrameDataRecord* Find(const FrameDataDBCharacter* character, const char* state_name) const;
+	const FrameDataRecord* Find(const char* abbr, const char* state_name) const;
+
+private:
+	bool Validate(size_t size);
+
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+	const FrameDataDBHeader* m_header = nullptr;
+	const FrameDataDBCharacter* m_characters = nullptr;
+	const FrameDataRecord* m_records = nullptr;
+	const uint32_t* m_slots = nullptr;
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+};
+
+// Generates database files, either from freshly parsed scripts or by carrying over characters of an existing database.
+class FrameDataDBBuilder
+{
+public:
+	// Replaces the character if it was already added
+	void AddCharacter(const std::string& abbr, const std::vector<scrState*>& states);
+	void AddCharacter(const std::string& abbr, const FrameDataRecord* records, uint32_t count);
+	bool HasCharacter(const std::string& abbr) const;
+	bool Write(const char* path) const;
+
+private:
+	struct Character
+	{
+		std::string abbr;
+		std::vector<FrameDataRecord> records;
+	};
+	Character& GetOrAddCharacter(const std::string& abbr);
+	std::vector<Character> m_characters;
+};
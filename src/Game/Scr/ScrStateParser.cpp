@@ -0,0 +1,430 @@
+#include "ScrStateParser.h"
+#include "CmdList.h"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+constexpr auto SCR_INDEX_ENTRY_SIZE = 36; //char name[32] + int32 offset from the pre_init
+constexpr auto SCR_STATE_HEADER_SIZE = 40; //CMD 0 + char name[32] + first CMD
+
+ScrScriptView make_scr_script_view(char* data, size_t size) {
+	ScrScriptView view{};
+	if (data == nullptr || size < 4) {
+		return view;
+	}
+	uint32_t n_funcs;
+	memcpy(&n_funcs, data, 4);
+	if (n_funcs == 0 || (size - 4) / SCR_INDEX_ENTRY_SIZE < n_funcs) {
+		return view;
+	}
+	view.index = data;
+	view.body = data + 4 + n_funcs * SCR_INDEX_ENTRY_SIZE;
+	view.end = data + size;
+	return view;
+}
+
+/*walks the index of one script and parses every state in it, the last entry of the index is skipped like it always was*/
+static void parse_scr_index(const ScrScriptView& scr,
+							std::vector<scrState*>& states_parsed,
+							const JonbBoxDB* jonb_index,
+							std::map<std::string, scrState*>* ea_state_map) {
+	if (scr.index == nullptr || scr.body == nullptr) {
+		return;
+	}
+	int n_funcs;
+	int func_num = 0;
+	int i = 0;
+	memcpy(&n_funcs, scr.index, 4);
+	i += 4;
+	while (func_num < n_funcs - 1) {
+		char name_index[32];
+		int pos_before_offset;
+		memcpy(name_index, scr.index + i, 32);
+		i += 32;
+		memcpy(&pos_before_offset, scr.index + i, 4);
+		i += 4;
+
+		char* addr = scr.body + pos_before_offset;
+		if (scr.end && (pos_before_offset < 0 || addr + SCR_STATE_HEADER_SIZE > scr.end)) {
+			func_num += 1;
+			continue;
+		}
+		parse_state(addr, states_parsed, jonb_index, ea_state_map, scr.end);
+		func_num += 1;
+	}
+}
+
+std::vector<scrState*> parse_scr_script(const ScrScriptView& scr, const ScrScriptView& ea,
+										const JonbBoxDB* jonb_index,
+										std::vector<scrState*>* ea_states_out) {
+	std::vector<scrState*> states_parsed;
+	std::vector<scrState*> ea_states_parsed;
+	/*doing the EA before the main states*/
+	std::map<std::string, scrState*> ea_state_map = {};  //ea_sstate_map to reference in the main state parsing. This way recursive ea_states(ea states called from ea state) won't work, I need to find a better way later.
+	parse_scr_index(ea, ea_states_parsed, jonb_index, &ea_state_map);
+
+	//builds ea_state_map to reference in the main state parsing.
+	for (auto& state : ea_states_parsed) {
+		ea_state_map[state->name] = state;
+	}
+	/*ending the EA*/
+
+	parse_scr_index(scr, states_parsed, jonb_index, &ea_state_map);
+
+	//the main states keep their own copies of the EA states they spawn
+	if (ea_states_out) {
+		ea_states_out->insert(ea_states_out->end(), ea_states_parsed.begin(), ea_states_parsed.end());
+	}
+	else {
+		free_scr_states(ea_states_parsed);
+	}
+	return states_parsed;
+}
+
+int scr_command_size(uint32_t cmd) {
+	//flattened once from the CmdList.h tables, looking a command up in them on every call was most of the parse time
+	static const std::vector<uint8_t> sizes = []() {
+		const std::pair<const std::vector<unsigned int>*, int> tables[] = {
+			{ &size_4, 4 }, { &size_8, 8 }, { &size_12, 12 }, { &size_16, 16 }, { &size_20, 20 }, { &size_24, 24 },
+			{ &size_28, 28 }, { &size_32, 32 }, { &size_36, 36 }, { &size_40, 40 }, { &size_44, 44 }, { &size_48, 48 },
+			{ &size_52, 52 }, { &size_68, 68 }, { &size_72, 72 }, { &size_84, 84 }, { &size_88, 88 }, { &size_132, 132 },
+			{ &size_148, 148 },
+		};
+		std::vector<uint8_t> res;
+		for (auto& table : tables) {
+			for (unsigned int cmd : *table.first) {
+				if (cmd >= res.size()) {
+					res.resize(cmd + 1, 0);
+				}
+				if (res[cmd] == 0) {
+					res[cmd] = table.second;
+				}
+			}
+		}
+		//(string[16], x, string[16], x, string[16], x, string[16], x), 7007 is listed in size_84
+		if (res.size() <= 7006) {
+			res.resize(7007, 0);
+		}
+		if (res[7006] == 0) {
+			res[7006] = 4 + 16 * 3 + 4 * 3;
+		}
+		return res;
+	}();
+	return cmd < sizes.size() ? sizes[cmd] : 0;
+}
+
+bool is_sprite_active_frame(const char* name_addr, const JonbBoxDB* jonb_index) {
+	if (name_addr == nullptr || jonb_index == nullptr) { return false; }
+	return jonb_index->HasHitboxes(name_addr);
+}
+
+int parse_state(char* addr, 
+				std::vector<scrState*>& states_parsed, 
+				const JonbBoxDB* jonb_index,
+				std::map<std::string, scrState*>* ea_state_map,
+				const char* end) {
+	scrState* s = new scrState();
+
+	s->addr = addr;
+	uint32_t CMD; //bbscript commands are 4 bytes wide
+	unsigned int offset = 0;
+	unsigned int prev_frames = 0; //saving the frames before the call to sprite, because functions that apply to those begin at the start of the sprite(), not at the end, such as invuln frames and spawning EA effects
+	//memcpy(&s->name, addr + offset, 32);
+	offset += 4;
+	s->name = addr + offset;
+	//cout << s->name << endl;
+	offset += 32;
+	memcpy(&CMD, addr + offset, sizeof(CMD));
+
+	//CMD = *(addr + offset);
+	offset += 4;
+	FrameInvuln invuln = FrameInvuln::None; //flag to turn on/off invuln windows
+	//int iter = 0;
+	//PS: I may have been calling uint32 char for some reason here, not sure why tbh, gotta double check before changing the comments
+	while (CMD != 0x1) {
+		//the arguments have to fit in the script too, a truncated or corrupt one ends the state here
+		const int cmd_size = scr_command_size(CMD);
+		if (end && cmd_size && addr + offset - sizeof(CMD) + cmd_size > end) {
+			break;
+		}
+		///remember to check for the configuration of defaults, 17000 up to 17006
+		if (CMD == 0x2) {
+			///sprite call(string[32],char) name of sprite and frames
+			//if (s->name == "NmlAtk5B") {
+			//	auto tsts = 1;
+			//	std::string cmd_str32(addr + offset);
+			//}
+			bool is_active = is_sprite_active_frame(addr + offset, jonb_index);//there's some weirdness on some moves, such as izayoi's "CmdActFDash", showing hitboxes when there shouldn't be
+			offset += 32;
+			//unsigned int frames;
+			uint32_t frames;
+			char* address = (addr + offset);
+			/////memcpy(&frames, addr + offset, 4);
+			frames = *(addr + offset);
+			FrameActivity activity_status = is_active? FrameActivity::Active: FrameActivity::Inactive;
+			offset += 4;
+			prev_frames = s->frames;
+			s->frames += frames;
+			for (int i = 0; i < frames;  i++) {
+				//if (frames == 32767){
+				if (frames == 0xffffffff || frames == 32767) {
+					s->frame_activity_status.push_back((FrameActivity)(0x10 | (uint16_t)activity_status));
+					s->frame_invuln_status.push_back(invuln);
+					break;
+				}
+				s->frame_activity_status.push_back(activity_status);
+				//sets the invuln
+				s->frame_invuln_status.push_back(invuln);
+				if (i > 100) {/*I still don't know why some sprites have absurdly long durations(well, actually is -1), such as jin's and izayoi's 6B, don't think its a parsing issue tbh*/
+					break;
+				}
+			}
+		}
+		else if (CMD == 4000) {
+			//EA state call(string[32],char); name of EA state and position
+			if (!ea_state_map->empty()) {
+				std::string cmd_str32(addr + offset);
+				auto match = ea_state_map->find(cmd_str32); //try to find the string[32] of the command in the map
+				if (match != ea_state_map->end()) { //safety check
+					scrState* entry = ea_state_map->at(cmd_str32);
+					s->frame_EA_effect_pairs.push_back({ prev_frames, *entry });
+				}
+			}
+			offset += 32;
+			//offsets the position
+			offset += 4;
+		}
+		else if (CMD == 22007) {
+			//setInvincible call(char); 0 if not set invincible, 1 if set. If CMD 22019 doesnt appear later assume full invincibility
+			uint32_t argument = *(uint32_t*)(addr + offset);
+			if (argument == 1) {//when invuln is turned on/off I need to retroactively remove the last sprite length added, since it applies its effect to the start, not end of the sprite
+				invuln = FrameInvuln::All;
+				for (int i = prev_frames; i < s->frames; i++) {
+					s->frame_invuln_status.at(i) = invuln;
+				}
+			}
+			else {
+				//when invuln is turned on/off I need to retroactively remove the last sprite length added, since it applies its effect to the start, not end of the sprite
+				invuln = FrameInvuln::None;
+				for (int i = prev_frames; i < s->frames; i++) {
+					s->frame_invuln_status.at(i) = invuln;
+				}
+			}
+			
+			offset += 4;
+		}
+		else if (CMD == 22019) {
+			//setInvincibleArgs call(char,char,char,char,char); they are equivalent to the flags for each property, head, body, leg, approach, throw. 0 for not set 1 for set.
+			uint16_t head = *(uint32_t*)(addr + offset) * (uint16_t)FrameInvuln::Head;
+			offset += 4;
+			uint16_t body = *(uint32_t*)(addr + offset) * (uint16_t)FrameInvuln::Body;
+			offset += 4;
+			uint16_t leg = *(uint32_t*)(addr + offset) * (uint16_t)FrameInvuln::Foot;
+			offset += 4;
+			uint16_t approach = *(uint32_t*)(addr + offset); //idk what approach is, I assume its projectile which is not implemented yet
+			offset += 4;
+			uint16_t thro = *(uint32_t*)(addr + offset) * (uint16_t)FrameInvuln::Throw; //thro is throw, throw is a reserved word
+			offset += 4;
+			invuln = (FrameInvuln)(head | body | leg  | thro);// note the missing projectile assumed "approach" since its not implemented yet
+			for (int i = prev_frames; i < s->frames; i++) {//when invuln is turned on/off I need to retroactively remove the last sprite length added, since it applies its effect to the start, not end of the sprite
+				s->frame_invuln_status.at(i) = invuln;
+			}
+
+		}
+		else if (CMD == 2002 || CMD == 23027) {
+			//refreshMultihit(more like disableHitbox)  call() 2002
+			//DisableAttackRestOfMove() call() 23027
+			//this will disable the hitbox of the last sprite, its listed by dantation as startMultihit but its more akin to disablehitbox.
+			for (int i = prev_frames; i < s->frames; i++) {//when hitbox is disabled I need to retroactively remove the last sprite length added, since it applies its effect to the start, not end of the sprite
+				if (i < s->frame_activity_status.size()) {//need to check due to edge cases where sprites last absurdly long(or are -1)
+				s->frame_activity_status.at(i) = FrameActivity::Inactive;
+			}
+				//else {
+				//	auto tst = 1;
+				//}
+			}
+		}
+		//still need to get the guard point CMD
+		else if (CMD == 9003) {
+			///Damage call(char) set dmg 
+			memcpy(&s->damage, addr + offset, 4);
+			offset += 4;
+		}
+		else if (CMD == 9001) {
+			///Damage call(char) set atk_type
+			//unsigned int atk_type;
+			//atk_type = *(addr + offset);
+			memcpy(&s->atk_type, addr + offset, 4);
+
+			offset += 4;
+			//s->atk_type = atk_type;
+		}
+		else if (CMD == 9002) {
+			///Damage call(char) set atk_level
+			///unsigned int atk_level;
+			//atk_level = *(addr + offset);
+			memcpy(&s->atk_level, addr + offset, 4);
+			offset += 4;
+			//s->atk_level = atk_level;
+		}
+		else if (CMD == 9154) {
+			///hitstun call(char) set hitstun when not tied to atk_level
+			//unsigned int hitstun;
+			//memcpy(&hitstun, addr + offset, 4);
+			memcpy(&s->hitstun, addr + offset, 4);
+			offset += 4;
+			//s->hitstun = hitstun;
+		}
+		else if (CMD == 11000) {
+			///hitstop call(char) set hitstop
+			//unsigned int hitstop;
+			memcpy(&s->hitstop, addr + offset, 4);
+			offset += 4;
+			//s->hitstop = hitstop;
+		}
+		else if (CMD == 9274) {
+			///attack_p1 call(char) set attack_p1
+			unsigned int attack_p1;
+			memcpy(&attack_p1, addr + offset, 4);
+			offset += 4;
+			s->attack_p1 = attack_p1;
+		}
+		else if (CMD == 9286) {
+			///attack_p2 call(char) set attack_p2
+			unsigned int attack_p2;
+			memcpy(&attack_p2, addr + offset, 4);
+			offset += 4;
+			s->attack_p2 = attack_p2;
+		}
+		else if (CMD == 11036) {
+			///hitOverhead call(char) set hitOverhead
+			unsigned int hit_overhead;
+			memcpy(&hit_overhead, addr + offset, 4);
+			offset += 4;
+			s->hit_overhead = hit_overhead;
+		}
+		else if (CMD == 11035) {
+			///hitLow call(char) set hitLow
+			unsigned int hit_low;
+			memcpy(&hit_low, addr + offset, 4);
+			offset += 4;
+			s->hit_low = hit_low;
+		}
+		else if (CMD == 11037) {
+			///HitAirUnblockable call(char) set HitAirUnblockable
+			unsigned int hit_air_unblockable;
+			memcpy(&hit_air_unblockable, addr + offset, 4);
+			offset += 4;
+			s->hit_air_unblockable = hit_air_unblockable;
+		}
+		else if (CMD == 14068) {
+			///whiffCancel call(string[32]) set whiffcancel to moves
+			std::string whiff_cancel;
+			whiff_cancel = (addr + offset);
+			//memcpy(&whiff_cancel, addr + offset, 4);
+			offset += 32;
+			s->whiff_cancel.push_back(whiff_cancel);
+		}
+		else if (CMD == 14069) {
+			///hit or block cancel call(string[32]) set hit or block cancel to moves
+			std::string hit_or_block_cancel;
+			hit_or_block_cancel = (addr + offset);
+			//memcpy(&whiff_cancel, addr + offset, 4);
+			offset += 32;
+			s->hit_or_block_cancel.push_back(hit_or_block_cancel);
+		}
+
+		else if (CMD == 11088) {
+			///starter rating call(char) set starter rating
+			unsigned int fatal_counter;
+			memcpy(&s->fatal_counter, addr + offset, 4);
+			offset += 4;
+			//s->fatal_counter = fatal_counter;
+		}
+		else if (CMD == 12051) {
+			///starter rating call(char) set starter rating
+			unsigned int starter_rating;
+			memcpy(&starter_rating, addr + offset, 4);
+			offset += 4;
+			s->starter_rating = starter_rating;
+		}
+		else if (CMD == 11028) {
+			///blockstun call(char) set blockstun
+			unsigned int blockstun;
+			memcpy(&blockstun, addr + offset, 4);
+			offset += 4;
+			s->blockstun = blockstun;
+		}
+
+		//these are the commands in the script in not interested in using
+		else if (cmd_size) {
+			offset += cmd_size - 4;
+		}
+		else {
+			///if (CMD != 7) { 
+
+			std::cerr << s->name << ":  offset: " << offset << " |  b10:  " << CMD << "| hex:" << std::hex << CMD << std::endl;
+			break;
+			//}; 
+		};
+
+		if (end && addr + offset + sizeof(CMD) > end) {
+			//ran past the end of a script read from disk, the state is either the last one or the file is truncated
+			break;
+		}
+		memcpy(&CMD, addr + offset, sizeof(CMD));
+		//CMD = *(unsigned long*)(addr + offset);
+		offset += 4;
+
+	}
+	states_parsed.push_back(s);
+	return 0;
+}
+
+ScrFrameData summarize_frame_data(const scrState* state) {
+	if (state == nullptr) {
+		return ScrFrameData{};
+	}
+	return summarize_frame_data(state->frame_activity_status, state->frame_invuln_status);
+}
+
+ScrFrameData summarize_frame_data(const std::vector<FrameActivity>& activity_status, const std::vector<FrameInvuln>& invuln_status) {
+	ScrFrameData data{};
+	int first_active = -1;
+	int last_active = -1;
+	for (size_t i = 0; i < activity_status.size(); i++) {
+		FrameActivity activity = activity_status[i];
+		if (activity == FrameActivity::NonDeterministicAcive || activity == FrameActivity::NonDeterministicInactive) {
+			data.non_deterministic = true;
+		}
+		if (activity == FrameActivity::Active || activity == FrameActivity::NonDeterministicAcive) {
+			if (first_active == -1) {
+				first_active = i;
+			}
+			last_active = i;
+		}
+	}
+	for (size_t i = 0; i < invuln_status.size(); i++) {
+		if (invuln_status[i] != FrameInvuln::None) {
+			if (data.invuln_start == 0) {
+				data.invuln_start = i + 1;
+			}
+			data.invuln_end = i + 1;
+		}
+	}
+	data.total = activity_status.size();
+	if (first_active != -1) {
+		data.startup = first_active + 1;
+		data.active = last_active - first_active + 1;
+		data.recovery = data.total - (last_active + 1);
+	}
+	return data;
+}
+
+void free_scr_states(std::vector<scrState*>& states) {
+	for (auto state : states) {
+		delete state;
+	}
+	states.clear();
+}
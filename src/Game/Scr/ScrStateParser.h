@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "Game/Jonb/JonbBoxDB.h"
+#include "ScrStateEntry.h"
+
+/*Parsing core for bbscript files. Nothing in here touches game memory on its own, it only works on the pointers it is
+given, so the same code parses the scripts the game has loaded (see ScrStateReader) and scr files extracted to disk.*/
+
+// One bbscript file: uint32 function count, then count * {char name[32], int32 offset}, then the state definitions
+// the offsets are relative to.
+struct ScrScriptView {
+	char* index = nullptr;
+	char* body = nullptr; //the pre_init, the first state definition
+	char* end = nullptr; //one past the last byte of the file, nullptr when reading game memory (no bounds checks)
+};
+
+// Frame data summarized from a parsed state, all values are in frames. 0 means the move has no such phase.
+struct ScrFrameData {
+	unsigned int startup = 0; //first active frame, counted from 1
+	unsigned int active = 0; //from the first to the last active frame, gaps between hits included
+	unsigned int recovery = 0; //frames after the last active frame
+	unsigned int total = 0;
+	unsigned int invuln_start = 0; //first frame with any invuln, counted from 1
+	unsigned int invuln_end = 0; //last frame with any invuln, counted from 1
+	bool non_deterministic = false; //the state has a sprite with script controlled length, values after it are lower bounds
+};
+
+// Builds the view for a scr file read from disk. Returns an empty view(index == nullptr) if the data doesn't look like a script.
+ScrScriptView make_scr_script_view(char* data, size_t size);
+
+// Parses every state of the script, jonb_index tells which sprites have hitboxes. The EA script is parsed first so the main states can reference the effects they spawn.
+// The main states keep copies of the EA states they spawn, so the parsed EA states are only handed over if ea_states_out is given
+// and freed otherwise.
+std::vector<scrState*> parse_scr_script(const ScrScriptView& scr, const ScrScriptView& ea,
+	const JonbBoxDB* jonb_index, std::vector<scrState*>* ea_states_out = nullptr);
+
+int parse_state(char* addr, std::vector<scrState*>& states_parsed, const JonbBoxDB* jonb_index,
+	std::map<std::string, scrState*>* ea_state_map, const char* end = nullptr);
+
+ScrFrameData summarize_frame_data(const scrState* state);
+ScrFrameData summarize_frame_data(const std::vector<FrameActivity>& activity, const std::vector<FrameInvuln>& invuln);
+
+// Full size of a command in bytes, id included. 0 if the command is unknown.
+int scr_command_size(uint32_t cmd);
+
+void free_scr_states(std::vector<scrState*>& states);
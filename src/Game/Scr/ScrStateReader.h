@@ -3,11 +3,10 @@
 #include <vector>
 #include <string>
 #include <map>
-#include "Game/Jonb/JonbDBReader.h"
-#include "Game/Jonb/JonbDBEntry.h"
+#include "Game/Jonb/JonbIndex.h"
 #include "ScrStateEntry.h"
+#include "ScrStateParser.h"
 
-
+// Parses the script of the character the game has loaded for the given player, see ScrStateParser for the file based version.
 std::vector<scrState*> parse_scr(char* bbcf_base_addr, int player_num);
-int parse_state(char* addr, std::vector<scrState*>& states_parsed, std::map<std::string, JonbDBEntry>*, std::map<std::string, scrState*>* ea_state_map);
-void override_state(char* addr, char* new_state);
\ No newline at end of file
+void override_state(char* addr, char* new_state);
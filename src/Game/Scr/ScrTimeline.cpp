@@ -0,0 +1,342 @@
+#include "ScrTimeline.h"
+#include "ScrStateParser.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	enum ScrCmd : uint32_t {
+		ScrCmd_StartState = 0,
+		ScrCmd_EndState = 1,
+		ScrCmd_Sprite = 2,
+		ScrCmd_If = 4,
+		ScrCmd_EndIf = 5,
+		ScrCmd_BeginSubroutine = 8,
+		ScrCmd_EndSubroutine = 9,
+		ScrCmd_CallSubroutine = 10,
+		ScrCmd_Label = 11,
+		ScrCmd_GotoLabel = 13,
+		ScrCmd_ExitState = 14,
+		ScrCmd_Upon = 15,
+		ScrCmd_EndUpon = 16,
+		ScrCmd_EnterState = 21,
+		ScrCmd_RefreshMultihit = 2002,
+		ScrCmd_SpawnEA = 4000,
+		ScrCmd_SetInvincible = 22007,
+		ScrCmd_SetInvincibleArgs = 22019,
+		ScrCmd_DisableAttackRestOfMove = 23027,
+	};
+
+	constexpr int SCR_STATE_HEADER_SIZE = 36; //startState + char name[32]
+
+	int32_t read_i32(const char* addr)
+	{
+		int32_t value;
+		memcpy(&value, addr, 4);
+		return value;
+	}
+
+	bool is_held_sprite(int length)
+	{
+		return length == -1 || length == 32767;
+	}
+}
+
+ScrTimelineSimulator::ScrTimelineSimulator(const JonbBoxDB* jonb_index)
+	: m_jonbIndex(jonb_index)
+{
+}
+
+void ScrTimelineSimulator::SetJonbIndex(const JonbBoxDB* jonb_index)
+{
+	m_jonbIndex = jonb_index;
+}
+
+const ScrTimeline& ScrTimelineSimulator::GetTimeline(size_t index) const
+{
+	return m_timelines[index];
+}
+
+bool ScrTimelineSimulator::ReadCmd(const char* addr, uint32_t& cmd, int& size) const
+{
+	if (m_end && addr + 4 > m_end)
+	{
+		return false;
+	}
+	memcpy(&cmd, addr, 4);
+	size = scr_command_size(cmd);
+	return size != 0 && (!m_end || addr + size <= m_end);
+}
+
+// Returns the command right after the one closing the block opened just before addr, nullptr if it isn't closed
+const char* ScrTimelineSimulator::SkipBlock(const char* addr, uint32_t open_cmd, uint32_t close_cmd) const
+{
+	int depth = 1;
+	uint32_t cmd;
+	int size;
+	while (ReadCmd(addr, cmd, size))
+	{
+		if (cmd == ScrCmd_EndState)
+		{
+			return nullptr;
+		}
+		addr += size;
+		if (cmd == open_cmd)
+		{
+			depth++;
+		}
+		else if (cmd == close_cmd && --depth == 0)
+		{
+			return addr;
+		}
+	}
+	return nullptr;
+}
+
+const char* ScrTimelineSimulator::FindLabel(int id) const
+{
+	for (auto& label : m_labels)
+	{
+		if (label.first == id)
+		{
+			return label.second;
+		}
+	}
+	return nullptr;
+}
+
+void ScrTimelineSimulator::Flush(ScrTimeline& timeline, Sprite& sprite, FrameInvuln invuln)
+{
+	if (!sprite.name)
+	{
+		return;
+	}
+	FrameActivity activity = sprite.active ? FrameActivity::Active : FrameActivity::Inactive;
+	unsigned int frames = (unsigned int)sprite.length;
+	if (is_held_sprite(sprite.length))
+	{
+		activity = (FrameActivity)(0x10 | (uint16_t)activity);
+		frames = 1;
+		timeline.open_ended = true;
+	}
+	else if (sprite.length < 0)
+	{
+		frames = 0;
+	}
+	if (timeline.frame_activity_status.size() + frames > max_frames)
+	{
+		frames = max_frames - (unsigned int)std::min<size_t>(timeline.frame_activity_status.size(), max_frames);
+		timeline.truncated = true;
+	}
+	timeline.frame_activity_status.insert(timeline.frame_activity_status.end(), frames, activity);
+	timeline.frame_invuln_status.insert(timeline.frame_invuln_status.end(), frames, invuln);
+	sprite.name = nullptr;
+}
+
+void ScrTimelineSimulator::RunPath(ScrTimeline& timeline, const std::vector<bool>& decisions)
+{
+	Sprite sprite;
+	FrameInvuln invuln = FrameInvuln::None;
+	bool attack_disabled = false;
+	size_t branch_count = 0;
+	m_labelFrames.clear();
+
+	const char* addr = m_body;
+	uint32_t cmd;
+	int size;
+	unsigned int command_count = 0;
+	while (!timeline.truncated)
+	{
+		if (++command_count > max_commands)
+		{
+			//jumps without sprites in between never add frames, this stops whatever max_frames can't
+			timeline.truncated = true;
+			break;
+		}
+		if (!ReadCmd(addr, cmd, size))
+		{
+			timeline.truncated = true;
+			break;
+		}
+		const char* args = addr + 4;
+		addr += size;
+		unsigned int frame = (unsigned int)timeline.frame_activity_status.size();
+
+		if (cmd == ScrCmd_EndState || cmd == ScrCmd_ExitState)
+		{
+			break;
+		}
+		else if (cmd == ScrCmd_Sprite)
+		{
+			Flush(timeline, sprite, invuln);
+			frame = (unsigned int)timeline.frame_activity_status.size();
+			sprite.name = args;
+			sprite.start = frame;
+			sprite.length = read_i32(args + 32);
+			sprite.active = !attack_disabled && m_jonbIndex && m_jonbIndex->HasHitboxes(args);
+			timeline.events.push_back({ frame, ScrTimelineEventType::Sprite, is_held_sprite(sprite.length) ? -1 : sprite.length, args });
+		}
+		else if (cmd == ScrCmd_RefreshMultihit || cmd == ScrCmd_DisableAttackRestOfMove)
+		{
+			sprite.active = false;
+			attack_disabled |= cmd == ScrCmd_DisableAttackRestOfMove;
+			timeline.events.push_back({ sprite.start, ScrTimelineEventType::HitboxDisabled, 0, nullptr });
+		}
+		else if (cmd == ScrCmd_SetInvincible)
+		{
+			invuln = read_i32(args) == 1 ? FrameInvuln::All : FrameInvuln::None;
+			timeline.events.push_back({ sprite.start, ScrTimelineEventType::Invuln, (int)invuln, nullptr });
+		}
+		else if (cmd == ScrCmd_SetInvincibleArgs)
+		{
+			//head, body, leg, approach(projectile, not in FrameInvuln yet), throw
+			int flags = (read_i32(args) ? (int)FrameInvuln::Head : 0)
+				| (read_i32(args + 4) ? (int)FrameInvuln::Body : 0)
+				| (read_i32(args + 8) ? (int)FrameInvuln::Foot : 0)
+				| (read_i32(args + 16) ? (int)FrameInvuln::Throw : 0);
+			invuln = (FrameInvuln)flags;
+			timeline.events.push_back({ sprite.start, ScrTimelineEventType::Invuln, flags, nullptr });
+		}
+		else if (cmd == ScrCmd_SpawnEA)
+		{
+			timeline.events.push_back({ sprite.start, ScrTimelineEventType::SpawnEA, 0, args });
+		}
+		else if (cmd == ScrCmd_Label)
+		{
+			int id = read_i32(args);
+			Flush(timeline, sprite, invuln);
+			frame = (unsigned int)timeline.frame_activity_status.size();
+			m_labelFrames.push_back({ id, frame });
+			timeline.events.push_back({ frame, ScrTimelineEventType::Label, id, nullptr });
+		}
+		else if (cmd == ScrCmd_GotoLabel)
+		{
+			int id = read_i32(args);
+			const char* target = FindLabel(id);
+			Flush(timeline, sprite, invuln);
+			frame = (unsigned int)timeline.frame_activity_status.size();
+			timeline.events.push_back({ frame, ScrTimelineEventType::Jump, id, nullptr });
+			if (!target)
+			{
+				timeline.truncated = true;
+				break;
+			}
+			bool visited = false;
+			for (auto& label : m_labelFrames)
+			{
+				if (label.first == id)
+				{
+					//going back to a label this path already went through, everything from there on repeats
+					timeline.loop_start = (int)label.second;
+					visited = true;
+					break;
+				}
+			}
+			if (visited)
+			{
+				break;
+			}
+			//target points past the label command, so it's recorded here or a later jump to it wouldn't be seen as a loop
+			m_labelFrames.push_back({ id, frame });
+			timeline.events.push_back({ frame, ScrTimelineEventType::Label, id, nullptr });
+			addr = target;
+		}
+		else if (cmd == ScrCmd_If)
+		{
+			bool taken = false;
+			if (branch_count < decisions.size())
+			{
+				taken = decisions[branch_count];
+			}
+			else if (m_timelineCount + m_pendingDecisions.size() < max_paths)
+			{
+				//every path takes the "not entered" side of new branches first, the other side is simulated later
+				m_pendingDecisions.emplace_back(decisions.begin(), decisions.end());
+				m_pendingDecisions.back().resize(branch_count, false);
+				m_pendingDecisions.back().push_back(true);
+			}
+			if (taken && branch_count < 32)
+			{
+				timeline.branch_mask |= 1u << branch_count;
+			}
+			branch_count++;
+			timeline.events.push_back({ frame, ScrTimelineEventType::Branch, taken ? 1 : 0, nullptr });
+			if (!taken && !(addr = SkipBlock(addr, ScrCmd_If, ScrCmd_EndIf)))
+			{
+				timeline.truncated = true;
+				break;
+			}
+		}
+		else if (cmd == ScrCmd_Upon || cmd == ScrCmd_BeginSubroutine)
+		{
+			//handlers run on game events, not in the state's own flow
+			if (!(addr = SkipBlock(addr, cmd, cmd == ScrCmd_Upon ? ScrCmd_EndUpon : ScrCmd_EndSubroutine)))
+			{
+				timeline.truncated = true;
+				break;
+			}
+		}
+		else if (cmd == ScrCmd_CallSubroutine)
+		{
+			timeline.events.push_back({ frame, ScrTimelineEventType::CallSubroutine, 0, args });
+		}
+		else if (cmd == ScrCmd_EnterState)
+		{
+			Flush(timeline, sprite, invuln);
+			frame = (unsigned int)timeline.frame_activity_status.size();
+			timeline.next_state = args;
+			timeline.events.push_back({ frame, ScrTimelineEventType::EnterState, 0, args });
+			break;
+		}
+	}
+	Flush(timeline, sprite, invuln);
+}
+
+size_t ScrTimelineSimulator::Simulate(const char* state_addr, const char* end)
+{
+	m_timelineCount = 0;
+	m_end = end;
+	m_labels.clear();
+	m_pendingDecisions.clear();
+	if (!state_addr || (end && state_addr + SCR_STATE_HEADER_SIZE > end))
+	{
+		return 0;
+	}
+	m_body = state_addr + SCR_STATE_HEADER_SIZE;
+
+	//labels can be jumped to from before they appear, so they are collected first
+	const char* addr = m_body;
+	uint32_t cmd;
+	int size;
+	while (ReadCmd(addr, cmd, size) && cmd != ScrCmd_EndState)
+	{
+		if (cmd == ScrCmd_Label)
+		{
+			m_labels.push_back({ read_i32(addr + 4), addr + size });
+		}
+		addr += size;
+	}
+
+	m_pendingDecisions.emplace_back();
+	while (!m_pendingDecisions.empty() && m_timelineCount < max_paths)
+	{
+		std::vector<bool> decisions = std::move(m_pendingDecisions.back());
+		m_pendingDecisions.pop_back();
+		if (m_timelineCount == m_timelines.size())
+		{
+			m_timelines.emplace_back();
+		}
+		ScrTimeline& timeline = m_timelines[m_timelineCount++];
+		timeline.frame_activity_status.clear();
+		timeline.frame_invuln_status.clear();
+		timeline.events.clear();
+		timeline.branch_mask = 0;
+		timeline.loop_start = -1;
+		timeline.open_ended = false;
+		timeline.truncated = false;
+		timeline.next_state = nullptr;
+		RunPath(timeline, decisions);
+	}
+	return m_timelineCount;
+}
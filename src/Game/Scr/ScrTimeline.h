@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Game/Jonb/JonbBoxDB.h"
+#include "ScrStateEntry.h"
+
+/*Steps through a state the way the game runs it instead of flattening it like parse_state does. Sprites are committed when the
+next one starts, so everything the script sets in between (invuln, disabled hitboxes) applies to the whole sprite. Labels and
+gotoLabel are followed, and each if block splits the state in two paths, so a state gives one exact timeline per path.
+Control flow command ids, as listed by the community bbscript command db:
+	1 endState, 2 sprite, 4 if, 5 endIf, 8/9 subroutine definition, 10 callSubroutine, 11 label, 13 gotoLabel, 14 exitState,
+	15/16 upon block, 21 enterState*/
+
+enum class ScrTimelineEventType : uint8_t {
+	Sprite, //value is the length, -1 for sprites held until something else ends them
+	HitboxDisabled,
+	Invuln, //value is the FrameInvuln flags
+	SpawnEA,
+	Label, //value is the label id
+	Jump, //value is the label id
+	Branch, //value is 1 if the if block was entered
+	CallSubroutine,
+	EnterState,
+};
+
+struct ScrTimelineEvent {
+	unsigned int frame; //first frame it applies to, counted from 0
+	ScrTimelineEventType type;
+	int value;
+	const char* name; //sprite/EA/subroutine/state name inside the script, nullptr if the event has none
+};
+
+struct ScrTimeline {
+	std::vector<FrameActivity> frame_activity_status;
+	std::vector<FrameInvuln> frame_invuln_status;
+	std::vector<ScrTimelineEvent> events;
+	uint32_t branch_mask = 0; //bit n is set if the n-th if block met on this path was entered
+	int loop_start = -1; //frame a backwards gotoLabel returns to, the frames from there on repeat until the game ends the state
+	bool open_ended = false; //has a sprite with a -1/32767 length, it is a single NonDeterministic frame in the timeline
+	bool truncated = false; //ran into max_frames, max_commands, the end of the file or an unknown command
+	const char* next_state = nullptr; //state entered with enterState at the end of the path
+};
+
+class ScrTimelineSimulator
+{
+public:
+	// The jonbin index decides which sprites have active hitboxes, sprites not in it are inactive
+	explicit ScrTimelineSimulator(const JonbBoxDB* jonb_index);
+	void SetJonbIndex(const JonbBoxDB* jonb_index);
+
+	// Simulates the state starting at state_addr(its startState command), returns the number of paths found.
+	// The timelines are reused between calls, so simulating a whole script doesn't allocate after the first few states.
+	size_t Simulate(const char* state_addr, const char* end = nullptr);
+	const ScrTimeline& GetTimeline(size_t index) const;
+
+	unsigned int max_frames = 1200;
+	unsigned int max_paths = 16;
+	unsigned int max_commands = 100000; //per path
+
+private:
+	struct Sprite {
+		const char* name = nullptr;
+		unsigned int start = 0;
+		int length = 0;
+		bool active = false;
+	};
+
+	void RunPath(ScrTimeline& timeline, const std::vector<bool>& decisions);
+	void Flush(ScrTimeline& timeline, Sprite& sprite, FrameInvuln invuln);
+	const char* SkipBlock(const char* addr, uint32_t open_cmd, uint32_t close_cmd) const;
+	const char* FindLabel(int id) const;
+	bool ReadCmd(const char* addr, uint32_t& cmd, int& size) const;
+
+	const JonbBoxDB* m_jonbIndex;
+	std::vector<ScrTimeline> m_timelines;
+	size_t m_timelineCount = 0;
+	std::vector<std::vector<bool> > m_pendingDecisions;
+	std::vector<std::pair<int, const char*> > m_labels;
+	std::vector<std::pair<int, unsigned int> > m_labelFrames;
+	const char* m_body = nullptr;
+	const char* m_end = nullptr;
+};
@@ -0,0 +1,295 @@
+#include "TraceFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	void write_varint(std::vector<uint8_t>& out, uint32_t value)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back((uint8_t)(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back((uint8_t)value);
+	}
+
+	void write_delta(std::vector<uint8_t>& out, int32_t value, int32_t& prev)
+	{
+		int32_t delta = (int32_t)((uint32_t)value - (uint32_t)prev);
+		prev = value;
+		write_varint(out, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31)); //zigzag, small negatives stay small
+	}
+
+	int32_t quantize_box(float value)
+	{
+		return (int32_t)std::lround(value * TRACE_BOX_QUANT);
+	}
+
+	struct ColumnReader
+	{
+		const uint8_t* pos;
+		const uint8_t* end;
+		bool ok = true;
+
+		uint32_t Varint()
+		{
+			uint32_t value = 0;
+			for (int shift = 0; shift < 35; shift += 7)
+			{
+				if (pos >= end)
+				{
+					ok = false;
+					return 0;
+				}
+				uint8_t byte = *pos++;
+				value |= (uint32_t)(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+				{
+					return value;
+				}
+			}
+			ok = false;
+			return 0;
+		}
+
+		int32_t Delta(int32_t& prev)
+		{
+			uint32_t zigzag = Varint();
+			int32_t delta = (int32_t)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+			prev = (int32_t)((uint32_t)prev + (uint32_t)delta);
+			return prev;
+		}
+
+		uint8_t Byte()
+		{
+			if (pos >= end)
+			{
+				ok = false;
+				return 0;
+			}
+			return *pos++;
+		}
+	};
+}
+
+TraceBlockEncoder::TraceBlockEncoder()
+{
+	ResetState();
+}
+
+void TraceBlockEncoder::ResetState()
+{
+	for (auto& column : m_columns)
+	{
+		column.clear();
+	}
+	for (auto& slot : m_slots)
+	{
+		memset(slot.values, 0, sizeof(slot.values));
+		slot.boxes.clear();
+	}
+	m_prevFrame = 0;
+	m_frameCount = 0;
+}
+
+uint32_t TraceBlockEncoder::Intern(const char* action)
+{
+	std::string name(action, strnlen(action, sizeof(TraceEntity::action)));
+	auto it = m_stringIds.find(name);
+	if (it != m_stringIds.end())
+	{
+		return it->second;
+	}
+	uint32_t id = (uint32_t)m_strings.size();
+	m_strings.push_back(name);
+	m_stringIds[name] = id;
+	return id;
+}
+
+void TraceBlockEncoder::AddFrame(const TraceFrame& frame)
+{
+	if (m_frameCount == 0)
+	{
+		m_firstFrame = frame.frame;
+		m_prevFrame = frame.frame;
+		m_minFrame = frame.frame;
+		m_maxFrame = frame.frame;
+	}
+	m_minFrame = std::min(m_minFrame, frame.frame);
+	m_maxFrame = std::max(m_maxFrame, frame.frame);
+	m_frameCount++;
+
+	int32_t prevFrame = (int32_t)m_prevFrame;
+	write_delta(m_columns[TraceColumn_Frame], (int32_t)frame.frame, prevFrame);
+	m_prevFrame = frame.frame;
+	write_varint(m_columns[TraceColumn_Frame], (uint32_t)frame.entities.size());
+
+	uint32_t prevSlot = 0;
+	for (const TraceEntity& entity : frame.entities)
+	{
+		const uint32_t slotIndex = std::min<uint32_t>(entity.slot, TRACE_MAX_SLOTS - 1);
+		write_varint(m_columns[TraceColumn_Slot], slotIndex - prevSlot);
+		prevSlot = slotIndex;
+		m_columns[TraceColumn_Flags].push_back(entity.flags);
+
+		SlotState& slot = m_slots[slotIndex];
+		write_delta(m_columns[TraceColumn_Position], entity.pos_x, slot.values[0]);
+		write_delta(m_columns[TraceColumn_Position], entity.pos_y, slot.values[1]);
+		write_delta(m_columns[TraceColumn_Transform], entity.scale_x, slot.values[2]);
+		write_delta(m_columns[TraceColumn_Transform], entity.scale_y, slot.values[3]);
+		write_delta(m_columns[TraceColumn_Transform], entity.rotation, slot.values[4]);
+		write_delta(m_columns[TraceColumn_Action], (int32_t)Intern(entity.action), slot.values[5]);
+
+		// boxes are compared with the box at the same index on the previous frame, a sprite held for a few frames costs 1 byte per value
+		std::vector<uint8_t>& boxes = m_columns[TraceColumn_Boxes];
+		write_varint(boxes, entity.box_count);
+		if (slot.boxes.size() < entity.box_count * 4)
+		{
+			slot.boxes.resize(entity.box_count * 4, 0);
+		}
+		for (uint32_t i = 0; i < entity.box_count; i++)
+		{
+			const TraceBox& box = frame.boxes[entity.first_box + i];
+			int32_t* prev = &slot.boxes[i * 4];
+			boxes.push_back(box.type);
+			write_delta(boxes, quantize_box(box.x), prev[0]);
+			write_delta(boxes, quantize_box(box.y), prev[1]);
+			write_delta(boxes, quantize_box(box.w), prev[2]);
+			write_delta(boxes, quantize_box(box.h), prev[3]);
+		}
+	}
+}
+
+void TraceBlockEncoder::Flush(std::vector<char>& out, TraceIndexEntry& entry)
+{
+	TraceBlockHeader header = {};
+	memcpy(header.magic, "BBTB", 4);
+	header.first_frame = m_firstFrame;
+	header.frame_count = m_frameCount;
+	header.min_frame = m_minFrame;
+	header.max_frame = m_maxFrame;
+	size_t size = sizeof(header);
+	for (int i = 0; i < TRACE_COLUMN_COUNT; i++)
+	{
+		header.column_size[i] = (uint32_t)m_columns[i].size();
+		size += m_columns[i].size();
+	}
+
+	entry.min_frame = m_minFrame;
+	entry.max_frame = m_maxFrame;
+	entry.offset = 0; //the writer knows where the block ends up
+	entry.size = (uint32_t)size;
+	entry.frame_count = m_frameCount;
+
+	out.insert(out.end(), (const char*)&header, (const char*)&header + sizeof(header));
+	for (auto& column : m_columns)
+	{
+		out.insert(out.end(), column.begin(), column.end());
+	}
+	ResetState();
+}
+
+bool trace_decode_block(const char* block, size_t size, const std::vector<std::string>& strings, std::vector<TraceFrame>& out)
+{
+	TraceBlockHeader header;
+	if (size < sizeof(header))
+	{
+		return false;
+	}
+	memcpy(&header, block, sizeof(header));
+	if (memcmp(header.magic, "BBTB", 4) != 0)
+	{
+		return false;
+	}
+
+	ColumnReader columns[TRACE_COLUMN_COUNT];
+	const uint8_t* pos = (const uint8_t*)block + sizeof(header);
+	const uint8_t* end = (const uint8_t*)block + size;
+	for (int i = 0; i < TRACE_COLUMN_COUNT; i++)
+	{
+		if (header.column_size[i] > (size_t)(end - pos))
+		{
+			return false;
+		}
+		columns[i].pos = pos;
+		columns[i].end = pos + header.column_size[i];
+		pos += header.column_size[i];
+	}
+
+	// same delta state as TraceBlockEncoder, reset per block
+	std::vector<int32_t> values(TRACE_MAX_SLOTS * 6, 0);
+	std::vector<std::vector<int32_t> > prevBoxes(TRACE_MAX_SLOTS);
+	int32_t prevFrame = (int32_t)header.first_frame;
+	for (uint32_t f = 0; f < header.frame_count; f++)
+	{
+		out.emplace_back();
+		TraceFrame& frame = out.back();
+		frame.frame = (uint32_t)columns[TraceColumn_Frame].Delta(prevFrame);
+		uint32_t entityCount = columns[TraceColumn_Frame].Varint();
+		if (entityCount > TRACE_MAX_SLOTS)
+		{
+			return false;
+		}
+
+		uint32_t slotIndex = 0;
+		for (uint32_t e = 0; e < entityCount; e++)
+		{
+			TraceEntity entity = {};
+			slotIndex += columns[TraceColumn_Slot].Varint();
+			if (slotIndex >= TRACE_MAX_SLOTS)
+			{
+				return false;
+			}
+			entity.slot = (uint16_t)slotIndex;
+			entity.flags = columns[TraceColumn_Flags].Byte();
+
+			int32_t* slot = &values[slotIndex * 6];
+			entity.pos_x = columns[TraceColumn_Position].Delta(slot[0]);
+			entity.pos_y = columns[TraceColumn_Position].Delta(slot[1]);
+			entity.scale_x = columns[TraceColumn_Transform].Delta(slot[2]);
+			entity.scale_y = columns[TraceColumn_Transform].Delta(slot[3]);
+			entity.rotation = columns[TraceColumn_Transform].Delta(slot[4]);
+			uint32_t action = (uint32_t)columns[TraceColumn_Action].Delta(slot[5]);
+			if (action < strings.size())
+			{
+				strncpy(entity.action, strings[action].c_str(), sizeof(entity.action) - 1);
+			}
+
+			ColumnReader& boxes = columns[TraceColumn_Boxes];
+			entity.first_box = (uint32_t)frame.boxes.size();
+			entity.box_count = boxes.Varint();
+			if (entity.box_count > 0xFFFF || !boxes.ok)
+			{
+				return false;
+			}
+			std::vector<int32_t>& prev = prevBoxes[slotIndex];
+			if (prev.size() < entity.box_count * 4)
+			{
+				prev.resize(entity.box_count * 4, 0);
+			}
+			for (uint32_t i = 0; i < entity.box_count; i++)
+			{
+				TraceBox box;
+				box.type = boxes.Byte();
+				box.x = boxes.Delta(prev[i * 4 + 0]) / (float)TRACE_BOX_QUANT;
+				box.y = boxes.Delta(prev[i * 4 + 1]) / (float)TRACE_BOX_QUANT;
+				box.w = boxes.Delta(prev[i * 4 + 2]) / (float)TRACE_BOX_QUANT;
+				box.h = boxes.Delta(prev[i * 4 + 3]) / (float)TRACE_BOX_QUANT;
+				frame.boxes.push_back(box);
+			}
+			frame.entities.push_back(entity);
+		}
+	}
+
+	for (auto& column : columns)
+	{
+		if (!column.ok)
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*Hitbox trace, a per frame recording of every drawn entity's position, transform, action and jonb boxes for offline analysis.
+Layout, all little endian:
+	TraceFileHeader
+	blocks, each TraceBlockHeader followed by its TRACE_COLUMN_COUNT columns
+	string table: uint32_t count, then count times uint8_t length + characters, the action names the blocks refer to by id
+	TraceIndexEntry[block_count]
+	TraceFooter
+A block holds up to TRACE_BLOCK_FRAMES frames. Values are stored as varints in separate columns, positions, transforms and boxes
+as the difference from the same entity slot on the previous frame, so an idle entity costs a few bytes a frame. The delta state is
+reset at the start of every block, so any block can be decoded on its own through the index.*/
+
+constexpr uint16_t TRACE_VERSION = 1;
+constexpr uint32_t TRACE_BLOCK_FRAMES = 120;
+constexpr int TRACE_BOX_QUANT = 16; //box values are stored in 1/16 pixels
+constexpr uint32_t TRACE_MAX_SLOTS = 256; //the game's entity list has 252
+
+enum TraceColumn_
+{
+	TraceColumn_Frame, //frame number delta, entity count
+	TraceColumn_Slot, //entity list index delta from the previous entity of the frame
+	TraceColumn_Flags,
+	TraceColumn_Position,
+	TraceColumn_Transform, //scale x, scale y, rotation
+	TraceColumn_Action,
+	TraceColumn_Boxes, //box count, then type + x, y, w, h per box
+	TraceColumn_Count
+};
+constexpr int TRACE_COLUMN_COUNT = TraceColumn_Count;
+
+enum TraceEntityFlags_ : uint8_t
+{
+	TraceEntityFlags_FacingLeft = 0x1,
+	TraceEntityFlags_Character = 0x2,
+	TraceEntityFlags_HitboxesDisabled = 0x4, //multihit/AttackOff, the hitboxes are in the trace but don't hit
+	TraceEntityFlags_OwnerP2 = 0x8, //owned by player 2, player 1 otherwise
+};
+
+struct TraceFileHeader
+{
+	char magic[4]; //"BBTR"
+	uint16_t version;
+	uint16_t column_count;
+	uint32_t block_frames;
+	uint32_t reserved;
+};
+
+struct TraceBlockHeader
+{
+	char magic[4]; //"BBTB"
+	uint32_t first_frame; //base of the first frame delta
+	uint32_t frame_count;
+	uint32_t min_frame;
+	uint32_t max_frame;
+	uint32_t column_size[TRACE_COLUMN_COUNT];
+};
+
+struct TraceIndexEntry
+{
+	uint32_t min_frame; //frame numbers aren't always increasing, the counter goes back on round resets
+	uint32_t max_frame;
+	uint64_t offset; //of the TraceBlockHeader
+	uint32_t size; //header included
+	uint32_t frame_count;
+};
+
+struct TraceFooter
+{
+	uint64_t strings_offset;
+	uint64_t index_offset;
+	uint32_t block_count;
+	char magic[4]; //"BBTI"
+};
+
+struct TraceBox
+{
+	uint8_t type; //JonbEntryType_
+	float x, y, w, h;
+};
+
+struct TraceEntity
+{
+	uint16_t slot; //index in g_gameVals.pEntityList
+	uint8_t flags; //TraceEntityFlags_
+	int32_t pos_x, pos_y; //game units, same origin as the hitbox overlay
+	int32_t scale_x, scale_y; //1000 is 100%
+	int32_t rotation; //1/1000 degrees
+	char action[32];
+	uint32_t first_box; //in TraceFrame::boxes
+	uint32_t box_count;
+};
+
+struct TraceFrame
+{
+	uint32_t frame;
+	std::vector<TraceEntity> entities; //ascending slots
+	std::vector<TraceBox> boxes;
+};
+
+// Turns frames into blocks, used by the recorder's writer thread. Not thread safe.
+class TraceBlockEncoder
+{
+public:
+	TraceBlockEncoder();
+	void AddFrame(const TraceFrame& frame);
+	uint32_t GetFrameCount() const { return m_frameCount; }
+	// Appends the block to out and starts a new one
+	void Flush(std::vector<char>& out, TraceIndexEntry& entry);
+
+	// Action names seen so far, in id order, written once at the end of the file
+	const std::vector<std::string>& GetStrings() const { return m_strings; }
+
+private:
+	struct SlotState
+	{
+		int32_t values[6]; //pos_x, pos_y, scale_x, scale_y, rotation, action
+		std::vector<int32_t> boxes; //x, y, w, h per box
+	};
+	void ResetState();
+	uint32_t Intern(const char* action);
+
+	std::vector<uint8_t> m_columns[TRACE_COLUMN_COUNT];
+	SlotState m_slots[TRACE_MAX_SLOTS];
+	uint32_t m_prevFrame = 0;
+	uint32_t m_firstFrame = 0;
+	uint32_t m_minFrame = 0;
+	uint32_t m_maxFrame = 0;
+	uint32_t m_frameCount = 0;
+	std::vector<std::string> m_strings;
+	std::unordered_map<std::string, uint32_t> m_stringIds;
+};
+
+// Decodes a block written by TraceBlockEncoder, the strings are the file's string table
+bool trace_decode_block(const char* block, size_t size, const std::vector<std::string>& strings, std::vector<TraceFrame>& out);
@@ -0,0 +1,185 @@
+#include "TraceReader.h"
+
+#include <cstring>
+
+bool TraceReader::Fail(const char* error)
+{
+	m_error = error;
+	return false;
+}
+
+void TraceReader::Close()
+{
+	if (m_file.is_open())
+	{
+		m_file.close();
+	}
+	m_index.clear();
+	m_strings.clear();
+	m_error.clear();
+	m_hasFooter = false;
+}
+
+bool TraceReader::Open(const std::string& path)
+{
+	Close();
+	m_file.open(path, std::ios::binary);
+	if (!m_file)
+	{
+		return Fail("can't open the file");
+	}
+
+	m_file.seekg(0, std::ios::end);
+	uint64_t file_size = (uint64_t)m_file.tellg();
+	m_file.seekg(0);
+
+	TraceFileHeader header;
+	if (file_size < sizeof(header) || !m_file.read((char*)&header, sizeof(header)) || memcmp(header.magic, "BBTR", 4) != 0)
+	{
+		return Fail("not a trace file");
+	}
+	if (header.version != TRACE_VERSION || header.column_count != TRACE_COLUMN_COUNT)
+	{
+		return Fail("unsupported trace version");
+	}
+
+	m_hasFooter = ReadFooter(file_size);
+	if (!m_hasFooter)
+	{
+		m_index.clear();
+		m_strings.clear();
+		m_file.clear();
+		return ScanBlocks(file_size);
+	}
+	return true;
+}
+
+bool TraceReader::ReadFooter(uint64_t file_size)
+{
+	TraceFooter footer;
+	if (file_size < sizeof(TraceFileHeader) + sizeof(footer))
+	{
+		return false;
+	}
+	m_file.seekg(file_size - sizeof(footer));
+	if (!m_file.read((char*)&footer, sizeof(footer)) || memcmp(footer.magic, "BBTI", 4) != 0)
+	{
+		return false;
+	}
+	if (footer.strings_offset > footer.index_offset
+		|| footer.index_offset + (uint64_t)footer.block_count * sizeof(TraceIndexEntry) > file_size - sizeof(footer))
+	{
+		return false;
+	}
+
+	m_file.seekg(footer.strings_offset);
+	uint32_t count = 0;
+	if (!m_file.read((char*)&count, 4) || count > footer.index_offset - footer.strings_offset)
+	{
+		return false;
+	}
+	m_strings.resize(count);
+	for (auto& str : m_strings)
+	{
+		uint8_t length = 0;
+		if (!m_file.read((char*)&length, 1))
+		{
+			return false;
+		}
+		str.resize(length);
+		if (length && !m_file.read(&str[0], length))
+		{
+			return false;
+		}
+	}
+
+	m_index.resize(footer.block_count);
+	m_file.seekg(footer.index_offset);
+	if (footer.block_count && !m_file.read((char*)m_index.data(), footer.block_count * sizeof(TraceIndexEntry)))
+	{
+		return false;
+	}
+	for (auto& entry : m_index)
+	{
+		if (entry.offset + entry.size > footer.strings_offset)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool TraceReader::ScanBlocks(uint64_t file_size)
+{
+	uint64_t offset = sizeof(TraceFileHeader);
+	TraceBlockHeader header;
+	while (offset + sizeof(header) <= file_size)
+	{
+		m_file.seekg(offset);
+		if (!m_file.read((char*)&header, sizeof(header)) || memcmp(header.magic, "BBTB", 4) != 0)
+		{
+			break;
+		}
+		uint64_t size = sizeof(header);
+		for (int i = 0; i < TRACE_COLUMN_COUNT; i++)
+		{
+			size += header.column_size[i];
+		}
+		if (offset + size > file_size)
+		{
+			break; //the last block was being written
+		}
+		TraceIndexEntry entry;
+		entry.min_frame = header.min_frame;
+		entry.max_frame = header.max_frame;
+		entry.offset = offset;
+		entry.size = (uint32_t)size;
+		entry.frame_count = header.frame_count;
+		m_index.push_back(entry);
+		offset += size;
+	}
+	m_file.clear();
+	return m_index.empty() ? Fail("no complete block in the file") : true;
+}
+
+uint64_t TraceReader::GetFrameCount() const
+{
+	uint64_t count = 0;
+	for (auto& entry : m_index)
+	{
+		count += entry.frame_count;
+	}
+	return count;
+}
+
+bool TraceReader::ReadFrames(uint32_t first, uint32_t last, std::vector<TraceFrame>& out)
+{
+	std::vector<TraceFrame> frames;
+	for (auto& entry : m_index)
+	{
+		if (entry.max_frame < first || entry.min_frame > last)
+		{
+			continue;
+		}
+		m_block.resize(entry.size);
+		m_file.seekg(entry.offset);
+		if (!m_file.read(m_block.data(), entry.size))
+		{
+			m_file.clear();
+			return Fail("can't read a block");
+		}
+		frames.clear();
+		if (!trace_decode_block(m_block.data(), m_block.size(), m_strings, frames))
+		{
+			return Fail("corrupted block");
+		}
+		for (auto& frame : frames)
+		{
+			if (frame.frame >= first && frame.frame <= last)
+			{
+				out.push_back(std::move(frame));
+			}
+		}
+	}
+	return true;
+}
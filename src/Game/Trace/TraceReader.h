@@ -0,0 +1,39 @@
+#pragma once
+
+#include "TraceFormat.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Reads .bbtr files written by TraceRecorder. Portable, tools/trace_dump uses it on Linux.
+class TraceReader
+{
+public:
+	// Loads the header, string table and block index. A trace cut short (game closed mid recording) has no footer,
+	// its blocks are found by walking the file instead and the action names are lost.
+	bool Open(const std::string& path);
+	void Close();
+	const std::string& GetError() const { return m_error; }
+
+	bool HasFooter() const { return m_hasFooter; }
+	size_t GetBlockCount() const { return m_index.size(); }
+	const TraceIndexEntry& GetBlock(size_t index) const { return m_index[index]; }
+	const std::vector<std::string>& GetStrings() const { return m_strings; }
+	uint64_t GetFrameCount() const;
+
+	// Appends the frames numbered first to last, only the blocks the index says overlap the range are read
+	bool ReadFrames(uint32_t first, uint32_t last, std::vector<TraceFrame>& out);
+
+private:
+	bool ReadFooter(uint64_t file_size);
+	bool ScanBlocks(uint64_t file_size);
+	bool Fail(const char* error);
+
+	std::ifstream m_file;
+	std::vector<TraceIndexEntry> m_index;
+	std::vector<std::string> m_strings;
+	std::vector<char> m_block;
+	std::string m_error;
+	bool m_hasFooter = false;
+};
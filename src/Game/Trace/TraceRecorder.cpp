@@ -0,0 +1,277 @@
+#include "TraceRecorder.h"
+
+#include "Core/interfaces.h"
+#include "Core/logger.h"
+#include "Game/FrameSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#define TRACE_FOLDER_PATH "BBCF_IM\\traces"
+
+TraceRecorder& TraceRecorder::GetInstance()
+{
+	static TraceRecorder instance;
+	return instance;
+}
+
+TraceRecorder::~TraceRecorder()
+{
+	//static destruction runs in DllMain where joining can deadlock, the recording was stopped on WM_DESTROY if the game closed normally
+	Stop(false);
+}
+
+bool TraceRecorder::Start()
+{
+	if (m_recording)
+	{
+		return true;
+	}
+
+	CreateDirectoryA(TRACE_FOLDER_PATH, NULL);
+	char fileName[64];
+	time_t now = time(nullptr);
+	strftime(fileName, sizeof(fileName), "trace_%Y%m%d_%H%M%S.bbtr", localtime(&now));
+	m_path = std::string(TRACE_FOLDER_PATH) + "\\" + fileName;
+
+	m_file = fopen(m_path.c_str(), "wb");
+	if (!m_file)
+	{
+		LOG(2, "TraceRecorder::Start couldn't create %s\n", m_path.c_str());
+		return false;
+	}
+
+	m_fileOffset = 0;
+	m_frameCount = 0;
+	m_droppedCount = 0;
+	m_bytesWritten = 0;
+	m_index.clear();
+	m_encoder = TraceBlockEncoder();
+
+	TraceFileHeader header = {};
+	memcpy(header.magic, "BBTR", 4);
+	header.version = TRACE_VERSION;
+	header.column_count = TRACE_COLUMN_COUNT;
+	header.block_frames = TRACE_BLOCK_FRAMES;
+	Write(&header, sizeof(header));
+
+	if (m_pool.empty())
+	{
+		m_pool.resize(TRACE_QUEUE_FRAMES);
+	}
+	m_free.clear();
+	m_pending.clear();
+	for (size_t i = 0; i < m_pool.size(); i++)
+	{
+		m_free.push_back(i);
+	}
+
+	m_hasLastFrame = false;
+	m_stopRequested = false;
+	m_writer = std::thread(&TraceRecorder::WriterLoop, this);
+	m_recording = true;
+	LOG(2, "TraceRecorder::Start %s\n", m_path.c_str());
+	return true;
+}
+
+void TraceRecorder::Stop(bool wait)
+{
+	if (!m_recording)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopRequested = true;
+	}
+	m_condition.notify_one();
+	if (!wait)
+	{
+		m_writer.detach();
+		m_recording = false;
+		return;
+	}
+	m_writer.join();
+	m_recording = false;
+	LOG(2, "TraceRecorder::Stop %u frames, %u dropped\n", (uint32_t)m_frameCount, (uint32_t)m_droppedCount);
+}
+
+void TraceRecorder::Update()
+{
+	const FrameSnapshot& snapshot = FrameSnapshotCache::GetInstance().Get();
+	if (!m_recording || !snapshot.has_frame || snapshot.entity_count == 0)
+	{
+		return;
+	}
+	const unsigned int frameCount = snapshot.frame;
+	if (m_hasLastFrame && frameCount == m_lastFrame)
+	{
+		return;
+	}
+	m_lastFrame = frameCount;
+	m_hasLastFrame = true;
+
+	size_t slot;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_free.empty())
+		{
+			m_droppedCount++;
+			return;
+		}
+		slot = m_free.back();
+		m_free.pop_back();
+	}
+
+	// the pooled frame keeps its vectors' capacity, so this doesn't allocate once the trace is warmed up
+	Capture(snapshot, m_pool[slot]);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pending.push_back(slot);
+	}
+	m_condition.notify_one();
+}
+
+// Same entities as the HitboxOverlay draws, boxes are kept as the jonb stores them so the trace doesn't depend on the camera
+void TraceRecorder::Capture(const FrameSnapshot& snapshot, TraceFrame& frame) const
+{
+	frame.frame = snapshot.frame;
+	frame.entities.clear();
+	frame.boxes.clear();
+
+	for (uint16_t i = 0; i < snapshot.entity_count; i++)
+	{
+		const EntitySnapshot& source = snapshot.entities[i];
+		TraceEntity entity;
+		entity.slot = source.slot;
+		entity.flags = 0;
+		if (source.flags & FrameSnapshotEntityFlags_FacingLeft)
+		{
+			entity.flags |= TraceEntityFlags_FacingLeft;
+		}
+		if (source.flags & FrameSnapshotEntityFlags_Character)
+		{
+			entity.flags |= TraceEntityFlags_Character;
+		}
+		if (source.flags & FrameSnapshotEntityFlags_HitboxesDisabled)
+		{
+			entity.flags |= TraceEntityFlags_HitboxesDisabled;
+		}
+		if (source.side == 1)
+		{
+			entity.flags |= TraceEntityFlags_OwnerP2;
+		}
+		entity.pos_x = source.pos_x;
+		entity.pos_y = source.pos_y;
+		entity.scale_x = source.scale_x;
+		entity.scale_y = source.scale_y;
+		entity.rotation = source.rotation;
+		memcpy(entity.action, source.data->currentAction, sizeof(entity.action));
+		entity.action[sizeof(entity.action) - 1] = 0;
+
+		const JonbEntrySpan& entries = source.boxes;
+		entity.first_box = (uint32_t)frame.boxes.size();
+		entity.box_count = (uint32_t)entries.Size();
+		for (const JonbEntry& entry : entries)
+		{
+			frame.boxes.push_back({ (uint8_t)entry.type, entry.offsetX, entry.offsetY, entry.width, entry.height });
+		}
+		frame.entities.push_back(entity);
+	}
+}
+
+bool TraceRecorder::Write(const void* data, size_t size)
+{
+	if (!m_file || fwrite(data, 1, size, m_file) != size)
+	{
+		return false;
+	}
+	m_fileOffset += size;
+	m_bytesWritten = m_fileOffset;
+	return true;
+}
+
+void TraceRecorder::WriteBlock()
+{
+	if (m_encoder.GetFrameCount() == 0)
+	{
+		return;
+	}
+	TraceIndexEntry entry;
+	m_buffer.clear();
+	m_encoder.Flush(m_buffer, entry);
+	entry.offset = m_fileOffset;
+	if (Write(m_buffer.data(), m_buffer.size()))
+	{
+		m_index.push_back(entry);
+	}
+}
+
+void TraceRecorder::WriteFooter()
+{
+	TraceFooter footer = {};
+	memcpy(footer.magic, "BBTI", 4);
+	footer.strings_offset = m_fileOffset;
+
+	const std::vector<std::string>& strings = m_encoder.GetStrings();
+	uint32_t count = (uint32_t)strings.size();
+	Write(&count, sizeof(count));
+	for (auto& str : strings)
+	{
+		uint8_t length = (uint8_t)std::min<size_t>(str.size(), 0xFF);
+		Write(&length, 1);
+		Write(str.data(), length);
+	}
+
+	footer.index_offset = m_fileOffset;
+	footer.block_count = (uint32_t)m_index.size();
+	if (!m_index.empty())
+	{
+		Write(m_index.data(), m_index.size() * sizeof(TraceIndexEntry));
+	}
+	Write(&footer, sizeof(footer));
+}
+
+void TraceRecorder::WriterLoop()
+{
+	std::vector<size_t> batch;
+	while (true)
+	{
+		bool stop;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this] { return m_stopRequested || !m_pending.empty(); });
+			batch.assign(m_pending.begin(), m_pending.end());
+			m_pending.clear();
+			stop = m_stopRequested;
+		}
+
+		for (size_t slot : batch)
+		{
+			m_encoder.AddFrame(m_pool[slot]);
+			m_frameCount++;
+			if (m_encoder.GetFrameCount() >= TRACE_BLOCK_FRAMES)
+			{
+				WriteBlock();
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_free.insert(m_free.end(), batch.begin(), batch.end());
+		}
+
+		if (stop)
+		{
+			break;
+		}
+	}
+
+	WriteBlock();
+	WriteFooter();
+	fclose(m_file);
+	m_file = nullptr;
+}
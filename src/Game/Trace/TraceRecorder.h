@@ -0,0 +1,72 @@
+#pragma once
+#include "TraceFormat.h"
+#include "Game/FrameSnapshot.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Frames the game thread can be ahead of the writer before new frames are dropped
+constexpr size_t TRACE_QUEUE_FRAMES = TRACE_BLOCK_FRAMES * 4;
+
+/*Records the hitbox overlay's entities and boxes every game frame into BBCF_IM/traces, see TraceFormat.h.
+The game thread only copies the frame into a preallocated slot, encoding and file writes happen on a writer thread,
+so recording doesn't cost the render thread more than the copy.*/
+class TraceRecorder
+{
+public:
+	static TraceRecorder& GetInstance();
+
+	bool Start();
+	// Writes the last block and the index, the file is only complete after this. Waits for the writer only if wait is set,
+	// DllMain holds the loader lock and joining a thread there can deadlock.
+	void Stop(bool wait = true);
+	bool IsRecording() const { return m_recording; }
+
+	// Called once per rendered frame after the FrameSnapshot, captures when the game frame changed
+	void Update();
+
+	const std::string& GetPath() const { return m_path; }
+	uint32_t GetFrameCount() const { return m_frameCount; }
+	uint32_t GetDroppedCount() const { return m_droppedCount; }
+	uint64_t GetBytesWritten() const { return m_bytesWritten; }
+
+private:
+	TraceRecorder() = default;
+	~TraceRecorder();
+
+	void Capture(const FrameSnapshot& snapshot, TraceFrame& frame) const;
+	void WriterLoop();
+	void WriteBlock();
+	void WriteFooter();
+	bool Write(const void* data, size_t size);
+
+	bool m_recording = false;
+	std::string m_path;
+	unsigned int m_lastFrame = 0;
+	bool m_hasLastFrame = false;
+
+	std::vector<TraceFrame> m_pool;
+	std::vector<size_t> m_free; //indexes in m_pool
+	std::deque<size_t> m_pending;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_stopRequested = false;
+	std::thread m_writer;
+
+	// writer thread only
+	FILE* m_file = nullptr;
+	TraceBlockEncoder m_encoder;
+	std::vector<TraceIndexEntry> m_index;
+	std::vector<char> m_buffer;
+	uint64_t m_fileOffset = 0;
+
+	std::atomic<uint32_t> m_frameCount{ 0 };
+	std::atomic<uint32_t> m_droppedCount{ 0 };
+	std::atomic<uint64_t> m_bytesWritten{ 0 };
+};
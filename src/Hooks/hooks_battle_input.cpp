@@ -1,8 +1,16 @@
 #include "hooks_battle_input.h"
 #include "HookManager.h"
+#include "Core/InputLatencyMonitor.h"
+#include "Core/interfaces.h"
+#include "Game/FrameSnapshot.h"
+#include "Game/GameEventBus.h"
+#include "Game/InputSequencer/InputSequencer.h"
+#include "Game/ReplayTakeover/ReplayTakeoverStream.h"
+#include "Overlay/Window/FrameAdvantage/FrameAdvantage.h"
 #include "Core/logger.h"
 
 #include <array>
+#include <atomic>
 
 namespace
 {
@@ -22,12 +30,46 @@ namespace
         bool active = false;
         uint16_t packedValue = INPUT_DIRECTION_NEUTRAL;
         uint32_t framesRemaining = 0; // 0 = infinite
+        BattleInputSource source = BattleInputSource_Tool;
+    };
+
+    constexpr uint32_t BATTLE_INPUT_QUEUE_MASK = BATTLE_INPUT_QUEUE_SIZE - 1;
+    static_assert((BATTLE_INPUT_QUEUE_SIZE & BATTLE_INPUT_QUEUE_MASK) == 0, "BATTLE_INPUT_QUEUE_SIZE must be a power of two");
+
+    struct QueueSlot
+    {
+        std::atomic<uint32_t> sequence{ UINT32_MAX }; // sequence of the record in it, UINT32_MAX while it's written
+        BattleInputRecord record;
     };
 
     std::array<OverrideState, MAX_BATTLE_PLAYERS> g_overrideState{};
     std::array<uint16_t, MAX_BATTLE_PLAYERS> g_lastObservedPacked{ INPUT_DIRECTION_NEUTRAL, INPUT_DIRECTION_NEUTRAL };
     std::array<uint16_t, MAX_BATTLE_PLAYERS> g_lastAppliedPacked{ INPUT_DIRECTION_NEUTRAL, INPUT_DIRECTION_NEUTRAL };
 
+    QueueSlot g_queue[BATTLE_INPUT_QUEUE_SIZE];
+    std::atomic<uint32_t> g_queueWritten{ 0 };
+
+    // Game thread only
+    void PushBattleInput(uint32_t playerIndex, uint16_t observed, uint16_t applied, BattleInputSource source)
+    {
+        const uint32_t sequence = g_queueWritten.load(std::memory_order_relaxed);
+        QueueSlot& slot = g_queue[sequence & BATTLE_INPUT_QUEUE_MASK];
+
+        // Readers copying this slot see the marker, or the new sequence once the record is complete
+        slot.sequence.store(UINT32_MAX, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.record.sequence = sequence;
+        slot.record.frame = g_gameVals.pFrameCount ? *g_gameVals.pFrameCount : 0;
+        slot.record.player = static_cast<uint8_t>(playerIndex);
+        slot.record.source = source;
+        const Player& player = playerIndex == 0 ? g_interfaces.player1 : g_interfaces.player2;
+        slot.record.facingLeft = !player.IsCharDataNullPtr() && player.GetData()->facingLeft != 0;
+        slot.record.observed = observed;
+        slot.record.applied = applied;
+        slot.sequence.store(sequence, std::memory_order_release);
+        g_queueWritten.store(sequence + 1, std::memory_order_release);
+    }
+
 
     uint16_t BuildDirectionFromState(const InputState& state)
     {
@@ -47,6 +89,31 @@ namespace
         return INPUT_DIRECTION_NEUTRAL;
     }
 
+    bool g_hasGameFrame = false;
+    unsigned int g_lastGameFrame = 0;
+
+    // Render is skipped while the game is minimized or the Steam overlay is up, the hook still runs on every game
+    // frame. What can't miss a frame is updated here, once per frame before the first player's input: the events
+    // the bus detects and the frame advantage the InputSequencer waits on.
+    void UpdateGameFrame()
+    {
+        if (!g_gameVals.pFrameCount)
+        {
+            return;
+        }
+        const unsigned int frame = *g_gameVals.pFrameCount;
+        if (g_hasGameFrame && frame == g_lastGameFrame)
+        {
+            return;
+        }
+        g_hasGameFrame = true;
+        g_lastGameFrame = frame;
+
+        FrameSnapshotCache::GetInstance().Capture();
+        GameEventBus::GetInstance().Update(FrameSnapshotCache::GetInstance().Get());
+        computeFramedataInteractions();
+    }
+
     uint16_t __cdecl ProcessBattleInput(uint16_t packedInput, uint32_t playerIndex)
     {
         if (playerIndex >= MAX_BATTLE_PLAYERS)
@@ -54,12 +121,17 @@ namespace
             return packedInput;
         }
 
+        UpdateGameFrame();
+
         g_lastObservedPacked[playerIndex] = packedInput;
+        const uint16_t observedInput = packedInput;
+        BattleInputSource source = BattleInputSource_Game;
 
         OverrideState& overrideState = g_overrideState[playerIndex];
         if (overrideState.active)
         {
             packedInput = overrideState.packedValue;
+            source = overrideState.source;
 
             if (overrideState.framesRemaining > 0)
             {
@@ -71,7 +143,23 @@ namespace
             }
         }
 
+        uint16_t streamedInput;
+        if (ReplayTakeoverStream::GetInstance().Tick(playerIndex, streamedInput))
+        {
+            packedInput = streamedInput;
+            source = BattleInputSource_ReplayTakeover;
+        }
+
+        uint16_t sequencedInput;
+        if (InputSequencer::GetInstance().Tick(playerIndex, sequencedInput))
+        {
+            packedInput = sequencedInput;
+            source = BattleInputSource_Sequencer;
+        }
+
         g_lastAppliedPacked[playerIndex] = packedInput;
+        PushBattleInput(playerIndex, observedInput, packedInput, source);
+        InputLatencyMonitor::GetInstance().OnBattleInputWritten(playerIndex, packedInput);
         return packedInput;
     }
 
@@ -142,12 +230,12 @@ InputState InputState::FromPackedValue(uint16_t packed)
     return state;
 }
 
-void OverrideBattleInput(uint32_t playerIndex, const InputState& state, uint32_t framesToHold)
+void OverrideBattleInput(uint32_t playerIndex, const InputState& state, uint32_t framesToHold, BattleInputSource source)
 {
-    OverrideBattleInputPacked(playerIndex, state.ToPackedValue(), framesToHold);
+    OverrideBattleInputPacked(playerIndex, state.ToPackedValue(), framesToHold, source);
 }
 
-void OverrideBattleInputPacked(uint32_t playerIndex, uint16_t packedValue, uint32_t framesToHold)
+void OverrideBattleInputPacked(uint32_t playerIndex, uint16_t packedValue, uint32_t framesToHold, BattleInputSource source)
 {
     if (playerIndex >= MAX_BATTLE_PLAYERS)
     {
@@ -158,6 +246,7 @@ void OverrideBattleInputPacked(uint32_t playerIndex, uint16_t packedValue, uint3
     overrideState.active = true;
     overrideState.packedValue = packedValue;
     overrideState.framesRemaining = framesToHold;
+    overrideState.source = source;
 }
 
 void ClearBattleInputOverride(uint32_t playerIndex)
@@ -203,6 +292,45 @@ InputState GetLastAppliedBattleInput(uint32_t playerIndex)
     return InputState::FromPackedValue(g_lastAppliedPacked[playerIndex]);
 }
 
+bool PollBattleInput(BattleInputCursor& cursor, BattleInputRecord& out)
+{
+    const uint32_t written = g_queueWritten.load(std::memory_order_acquire);
+    if (!cursor.attached)
+    {
+        cursor.next = written;
+        cursor.attached = true;
+    }
+
+    while (cursor.next != written)
+    {
+        if (written - cursor.next > BATTLE_INPUT_QUEUE_SIZE)
+        {
+            cursor.dropped += written - cursor.next - BATTLE_INPUT_QUEUE_SIZE;
+            cursor.next = written - BATTLE_INPUT_QUEUE_SIZE;
+        }
+
+        const uint32_t sequence = cursor.next++;
+        const QueueSlot& slot = g_queue[sequence & BATTLE_INPUT_QUEUE_MASK];
+        if (slot.sequence.load(std::memory_order_acquire) == sequence)
+        {
+            out = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                return true;
+            }
+        }
+        // Overwritten while we got to it
+        cursor.dropped++;
+    }
+    return false;
+}
+
+uint32_t GetBattleInputWriteCount()
+{
+    return g_queueWritten.load(std::memory_order_relaxed);
+}
+
 void __declspec(naked) BattleInputWrite_Hook()
 {
     __asm {
@@ -30,6 +30,38 @@ struct InputState
     static InputState FromPackedValue(uint16_t packed);
 };
 
+// Who decided the value written back into the game
+enum BattleInputSource : uint8_t
+{
+    BattleInputSource_Game,             // no override, the game's own input
+    BattleInputSource_KeyboardOverride, // the P2 keyboard of the ControllerOverrideManager
+    BattleInputSource_Tool,             // any other caller of the override helpers
+    BattleInputSource_Sequencer,        // a program of the InputSequencer, wins over the overrides
+    BattleInputSource_ReplayTakeover    // the ReplayTakeoverStream, wins over the overrides, not over the sequencer
+};
+
+// One call of the battle input writer
+struct BattleInputRecord
+{
+    uint32_t sequence; // position in the queue
+    uint32_t frame;    // *g_gameVals.pFrameCount, 0 before it's found
+    uint8_t player;
+    uint8_t source;    // BattleInputSource
+    bool facingLeft;   // side the player faced when the input was written, motions read it per record
+    uint16_t observed; // packed, before overrides
+    uint16_t applied;  // packed, what the game got
+};
+
+// Each reader keeps its own, a new cursor starts at the next record written
+struct BattleInputCursor
+{
+    uint32_t next = 0;
+    uint32_t dropped = 0; // records overwritten before this cursor read them
+    bool attached = false;
+};
+
+constexpr uint32_t BATTLE_INPUT_QUEUE_SIZE = 4096; // power of two, ~30 seconds of both players
+
 // Installs the Detours hook that intercepts the battle input writer.
 bool Hook_BattleInput();
 
@@ -37,10 +69,12 @@ bool Hook_BattleInput();
 
 // Override a player's input using a high-level InputState description.
 // framesToHold = 0 keeps the override active until manually cleared.
-void OverrideBattleInput(uint32_t playerIndex, const InputState& state, uint32_t framesToHold = 0);
+void OverrideBattleInput(uint32_t playerIndex, const InputState& state, uint32_t framesToHold = 0,
+    BattleInputSource source = BattleInputSource_Tool);
 
 // Override using a raw packed value (for tools that already operate in packed form).
-void OverrideBattleInputPacked(uint32_t playerIndex, uint16_t packedValue, uint32_t framesToHold = 0);
+void OverrideBattleInputPacked(uint32_t playerIndex, uint16_t packedValue, uint32_t framesToHold = 0,
+    BattleInputSource source = BattleInputSource_Tool);
 
 // Clears any pending override for the given player.
 void ClearBattleInputOverride(uint32_t playerIndex);
@@ -53,3 +87,13 @@ InputState GetLastObservedBattleInput(uint32_t playerIndex);
 
 // Returns the last value that was written back into the game (after overrides).
 InputState GetLastAppliedBattleInput(uint32_t playerIndex);
+
+// Input queue -----------------------------------------------------------------
+
+// Every write of the hook goes into a fixed ring, only the game thread writes to it and it never waits or allocates.
+// Safe from any thread, returns false when the cursor caught up. A reader falling BATTLE_INPUT_QUEUE_SIZE records
+// behind loses the oldest ones, they're counted as dropped on its cursor.
+bool PollBattleInput(BattleInputCursor& cursor, BattleInputRecord& out);
+
+// Records written since the game started
+uint32_t GetBattleInputWriteCount();
@@ -15,8 +15,27 @@
 #include <string>
 #include "Web/update_check.h"
 #include "Game/ReplayFiles/ReplayFileManager.h"
+#include "Game/Playbacks/PlaybackLibrary.h"
+#include "Game/Trace/TraceRecorder.h"
 
-extern "C" void HandleControllerWndProcMessage(UINT msg, WPARAM wParam, LPARAM lParam);
+// The game destroys its window before the process exits, with no loader lock held, so the worker threads are
+// joined here. BBCF_IM_Shutdown runs in DllMain and only tells them to stop.
+static void StopWorkerThreads()
+{
+	LOG(1, "StopWorkerThreads\n");
+	ControllerOverrideManager::GetInstance().Shutdown();
+	PlaybackLibrary::GetInstance().stop_loading();
+	TraceRecorder::GetInstance().Stop();
+}
+
+extern "C" void HandleGameWndProcMessage(UINT msg, WPARAM wParam, LPARAM lParam)
+{
+	ControllerOverrideManager::GetInstance().HandleWindowMessage(msg, wParam, lParam);
+	if (msg == WM_DESTROY)
+	{
+		StopWorkerThreads();
+	}
+}
 
 
 
@@ -176,7 +195,7 @@ void __declspec(naked)PassMsgToImGui()
 		push[ebp + 10h] // lParam
 		push edi // wParam
 		push esi // msg
-		call HandleControllerWndProcMessage
+		call HandleGameWndProcMessage
 		add esp, 0Ch
 		popad
 	}
@@ -454,6 +473,7 @@ void __declspec(naked)GetEntityListAddr()
 	LOG_ASM(7, "GetEntityListAddr\n");
 
 	__asm mov[g_gameVals.pEntityList], eax
+	__asm inc[g_gameVals.entityListGeneration]
 
 	// Original:
 	// push    3F0h
@@ -474,6 +494,7 @@ void __declspec(naked)GetEntityListDeleteAddr()
 	_asm
 	{
 		mov[g_gameVals.pEntityList], 0
+		inc[g_gameVals.entityListGeneration]
 		mov[esi + 62784h], ecx
 		jmp[GetEntityListDeleteAddrJmpBackAddr]
 	}
@@ -5,26 +5,30 @@
 #include "Core/utils.h"
 #include "Game/gamestates.h"
 #include "Core/info.h"
+#include "Game/FrameSnapshot.h"
+#include "Game/GameEventBus.h"
+
+#include <utility>
 
 
 void ComboDataWindow::Draw() {
 	DrawMainSection();
 }
 struct HeatControl {
-	HeatControl(CharData* playerObj, CharData* opponentObj)
+	HeatControl(const CharData* playerObj, const CharData* opponentObj)
 		: player(playerObj),
 		opponent(opponentObj),
 		previous_heat(playerObj->heatMeter),
 		heat_gained(0){}
-	CharData* player = nullptr;
-	CharData* opponent = nullptr;
+	const CharData* player = nullptr;
+	const CharData* opponent = nullptr;
 	int previous_heat = 0;
 	int heat_gained = 0;
-	void HeatControl::set_char_objs(CharData* playerObj, CharData* opponentObj) {
+	void HeatControl::set_char_objs(const CharData* playerObj, const CharData* opponentObj) {
 		player = playerObj;
 		opponent = opponentObj;
 	};
-	void HeatControl::calculate_heat_gain() {
+	void HeatControl::calculate_heat_gain(bool reset) {
 		int currentHeat = player->heatMeter;
 		int delta = currentHeat - previous_heat;
 		if (delta > 0 && opponent->heatGeneratedForCombo > 0) {
@@ -43,7 +47,7 @@ struct HeatControl {
 			heat_gained = floor(opponent->heatGeneratedForCombo * heat_cd_mult);
 		}
 
-		if (*g_gameVals.pFrameCount == 1) {
+		if (reset) {
 			//resets all values when training mode is reset while the combo data window is open
 			currentHeat = 0;
 			previous_heat = 0;
@@ -56,68 +60,80 @@ struct HeatControl {
 };
 
 void ComboDataWindow::DrawMainSection() {
-	if (!g_interfaces.player1.IsCharDataNullPtr() && !g_interfaces.player2.IsCharDataNullPtr()) {
-		CharData* p1 = g_interfaces.player1.GetData();
-		CharData* p2 = g_interfaces.player2.GetData();
+	const FrameSnapshot& snapshot = FrameSnapshotCache::GetInstance().Get();
+	if (snapshot.HasPlayers()) {
+		const PlayerSnapshot* p1 = &snapshot.players[0];
+		const PlayerSnapshot* p2 = &snapshot.players[1];
 		auto starter_rating = ""; int histun_decay = 0;
 		HeatControl* hc;
 
-		static HeatControl heat_control_p1 = HeatControl(p1,p2);
-		static HeatControl heat_control_p2 = HeatControl(p2,p1);
+		static HeatControl heat_control_p1 = HeatControl(p1->data, p2->data);
+		static HeatControl heat_control_p2 = HeatControl(p2->data, p1->data);
 		static int player_radio = 0;
 		static int current_heat = 0;
 		static int previous_heat = 0;
 		static int heat_gained = 0;
+		static GameEventCursor events;
+		static uint32_t last_sequence = 0;
+		//the window wasn't drawn on the previous frame, skip what happened while it was closed
+		if (snapshot.sequence != last_sequence + 1) {
+			events.attached = false;
+		}
+		last_sequence = snapshot.sequence;
+		bool reset = false;
+		GameEvent event;
+		while (GameEventBus::GetInstance().Poll(events, event)) {
+			if (event.type == GameEventType_FrameReset) {
+				reset = true;
+			}
+		}
 		ImGui::RadioButton("P1", &player_radio, 0);
 		ImGui::SameLine();
 		ImGui::RadioButton("P2", &player_radio, 1);
 		//calculate heat gain for both players, regardless of which is currently chosen
-		heat_control_p1.set_char_objs(p1, p2);
-		heat_control_p1.calculate_heat_gain();
-		heat_control_p2.set_char_objs(p2, p1);
-		heat_control_p2.calculate_heat_gain();
+		heat_control_p1.set_char_objs(p1->data, p2->data);
+		heat_control_p1.calculate_heat_gain(reset);
+		heat_control_p2.set_char_objs(p2->data, p1->data);
+		heat_control_p2.calculate_heat_gain(reset);
 		//make it clearer later
 		if (player_radio == 0) {
-			p1 = g_interfaces.player1.GetData();
-			p2 = g_interfaces.player2.GetData();
 			hc = &heat_control_p1;
 		}
 		else {
-			p1 = g_interfaces.player2.GetData();
-			p2 = g_interfaces.player1.GetData();
+			std::swap(p1, p2);
 			hc = &heat_control_p2;
 		}
-		if (p2->starterRating == 1) {
+		if (p2->starter_rating == 1) {
 			starter_rating = "short";
 		}
-		else if (p2->starterRating == 2) {
+		else if (p2->starter_rating == 2) {
 			starter_rating = "normal";
 		}
-		else if (p2->starterRating == 3) {
+		else if (p2->starter_rating == 3) {
 			starter_rating = "long";
 		}
 		else { starter_rating = ""; }
-		if (p2->comboTime > 660) {
+		if (p2->combo_time > 660) {
 			histun_decay = -100000;
 		}
-		else if (p2->comboTime > 480) {
+		else if (p2->combo_time > 480) {
 			histun_decay = -10;
 		}
-		else if (p2->comboTime > 300) {
+		else if (p2->combo_time > 300) {
 			histun_decay = -5;
 		}
-		else if (p2->comboTime > 120) {
+		else if (p2->combo_time > 120) {
 			histun_decay = -2;
 		}
 		ImGui::Text("Starter Rating: %s", starter_rating);
-		ImGui::Text("Combo Time: %d", p2->comboTime);
+		ImGui::Text("Combo Time: %d", p2->combo_time);
 		ImGui::Text("Hitstun: %d", p2->hitstun);
 		ImGui::Text("Hitstun Decay: %dF", histun_decay);
-		ImGui::Text("Combo Proration: %d", p2->comboProration);
+		ImGui::Text("Combo Proration: %d", p2->combo_proration);
 		ImGui::Text("Heat Generated: %d", hc->heat_gained);
-		ImGui::Text("Heat Cooldown: %d", p1->heatGainCooldown);
+		ImGui::Text("Heat Cooldown: %d", p1->heat_gain_cooldown);
 		if (ImGui::TreeNode("Same Move Proration Stack")) {
-			char* smp_stack_location = p2->sameMoveProrationStack;
+			const char* smp_stack_location = p2->data->sameMoveProrationStack;
 			for (int iter = 0; iter < 5; iter++) {
 				
 				ImGui::Text("%s", smp_stack_location);
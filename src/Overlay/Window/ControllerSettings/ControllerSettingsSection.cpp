@@ -17,7 +17,6 @@ namespace ControllerSettings
         void DrawSection()
         {
                 auto& controllerManager = ControllerOverrideManager::GetInstance();
-                controllerManager.TickAutoRefresh();
                 const bool inDevelopmentFeaturesEnabled = Settings::settingsIni.enableInDevelopmentFeatures;
                 const bool steamInputLikely = inDevelopmentFeaturesEnabled ? controllerManager.IsSteamInputLikelyActive() : false;
 
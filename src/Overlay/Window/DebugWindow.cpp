@@ -1,10 +1,14 @@
 #pragma once
 #include "DebugWindow.h"
 
+#include "Core/ControllerOverrideManager.h"
+#include "Core/InputLatencyMonitor.h"
 #include "Core/interfaces.h"
+#include "Core/logger.h"
 #include "Core/Settings.h"
 #include "Core/utils.h"
 #include "Game/gamestates.h"
+#include "Game/InputSequencer/InputSequencer.h"
 #include "Overlay/NotificationBar/NotificationBar.h"
 #include "Overlay/WindowManager.h"
 #include "Overlay/Window/HitboxOverlay.h"
@@ -62,6 +66,12 @@
 
 
 
+DebugWindow::~DebugWindow()
+{
+	if (m_entityListener)
+		EntityTracker::GetInstance().Unsubscribe(m_entityListener);
+}
+
 void DebugWindow::Draw()
 {	
 	//g_pd3dDevice
@@ -613,6 +623,12 @@ void DebugWindow::DrawGameValuesSection()
 		ImGui::TreePop();
 	}
 
+	DrawEntityTracker();
+	DrawGameEvents();
+	DrawInputLatency();
+	DrawBattleInputQueue();
+	DrawInputSequencer();
+
 	if (ImGui::TreeNode("Hitbox overlay"))
 	{
 		float& scale = WindowManager::GetInstance().GetWindowContainer()->GetWindow<HitboxOverlay>(WindowType_HitboxOverlay)->GetScale();
@@ -622,6 +638,213 @@ void DebugWindow::DrawGameValuesSection()
 	}
 }
 
+void DebugWindow::DrawEntityTracker()
+{
+	if (!ImGui::TreeNode("Entity tracker"))
+		return;
+
+	// Only listens while someone looked at it once, so the log costs nothing otherwise
+	if (!m_entityListener)
+	{
+		m_entityListener = EntityTracker::GetInstance().Subscribe([this](const EntityEvent& event)
+		{
+			const size_t MAX_EVENTS = 64;
+			if (m_entityEvents.size() == MAX_EVENTS)
+				m_entityEvents.pop_front();
+			m_entityEvents.push_back(event);
+		});
+	}
+
+	const EntityTracker& tracker = EntityTracker::GetInstance();
+	ImGui::Text("List generation: %u", tracker.GetListGeneration());
+	ImGui::Text("Live entities: %d", (int)tracker.GetLiveCount());
+	ImGui::Text("Anchored entities: %u", tracker.CountAnchored());
+
+	if (ImGui::TreeNode("Live"))
+	{
+		for (size_t i = 0; i < tracker.GetLiveCount(); i++)
+		{
+			const TrackedEntity& entity = tracker.GetLive(i);
+			ImGui::Text("%3d 0x%p side %d owner %d spawned %u", entity.slot, entity.data, entity.side, entity.owner_slot, entity.spawn_frame);
+		}
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Events"))
+	{
+		for (auto it = m_entityEvents.rbegin(); it != m_entityEvents.rend(); ++it)
+		{
+			ImGui::Text("%u %s %3d side %d", it->frame, it->type == EntityEventType::Spawn ? "spawn" : "despawn", it->slot, it->side);
+		}
+		ImGui::TreePop();
+	}
+
+	ImGui::TreePop();
+}
+
+void DebugWindow::DrawGameEvents()
+{
+	if (!ImGui::TreeNode("Game events"))
+		return;
+
+	// Don't count what was published while the node was closed as dropped
+	const uint32_t sequence = FrameSnapshotCache::GetInstance().Get().sequence;
+	if (sequence != m_gameEventsSequence + 1)
+		m_gameEventCursor.attached = false;
+	m_gameEventsSequence = sequence;
+
+	const size_t MAX_EVENTS = 64;
+	GameEvent event;
+	while (GameEventBus::GetInstance().Poll(m_gameEventCursor, event))
+	{
+		if (m_gameEvents.size() == MAX_EVENTS)
+			m_gameEvents.pop_front();
+		m_gameEvents.push_back(event);
+	}
+
+	static const char* typeNames[GameEventType_Count] =
+	{
+		"ActionChanged", "Hit", "Block", "RoundStart", "RoundEnd", "FrameReset",
+		"MatchInit", "MatchEnd", "EntitySpawn", "EntityDespawn"
+	};
+
+	const GameEventStats stats = GameEventBus::GetInstance().GetStats();
+	ImGui::Text("Published: %u", stats.published);
+	ImGui::Text("Dropped: %u (this window %u)", stats.dropped, m_gameEventCursor.dropped);
+	ImGui::Text("Last frame: %u events, peak %u", stats.lastFrameVolume, stats.peakFrameVolume);
+	if (ImGui::TreeNode("By type"))
+	{
+		for (int i = 0; i < GameEventType_Count; i++)
+		{
+			ImGui::Text("%s: %u", typeNames[i], stats.countByType[i]);
+		}
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Recent"))
+	{
+		for (auto it = m_gameEvents.rbegin(); it != m_gameEvents.rend(); ++it)
+		{
+			ImGui::Text("%u %s side %d slot %d value %d %s", it->frame, typeNames[it->type], it->side, it->slot, it->value, it->action);
+		}
+		ImGui::TreePop();
+	}
+
+	ImGui::TreePop();
+}
+
+void DebugWindow::DrawInputLatency()
+{
+	if (!ImGui::TreeNode("Input latency"))
+		return;
+
+	InputLatencyMonitor& monitor = InputLatencyMonitor::GetInstance();
+	bool enabled = monitor.IsEnabled();
+	if (ImGui::Checkbox("Measure", &enabled))
+		monitor.SetEnabled(enabled);
+	ImGui::SameLine();
+	if (ImGui::Button("Reset"))
+		monitor.Reset();
+	ImGui::SameLine();
+	if (ImGui::Button("Export CSV"))
+	{
+		m_latencyExportPath = monitor.ExportCsv();
+		if (m_latencyExportPath.empty())
+			m_latencyExportPath = "Export failed";
+	}
+	if (!m_latencyExportPath.empty())
+		ImGui::Text("%s", m_latencyExportPath.c_str());
+
+	ImGui::Text("Keyboard separation: %s, V-sync: %s",
+		ControllerOverrideManager::GetInstance().IsMultipleKeyboardOverrideEnabled() ? "on" : "off",
+		Settings::settingsIni.vsync ? "on" : "off");
+	ImGui::Text("Events: %d", (int)monitor.GetEventCount());
+
+	static const char* sourceNames[InputLatencySource_Count] = { "Raw input", "Window message" };
+	for (int i = 0; i < InputLatencySource_Count; i++)
+	{
+		const InputLatencyStats stats = monitor.GetStats((InputLatencySource)i);
+		ImGui::Text("%s: %u presses, %u unmatched", sourceNames[i], stats.matched, stats.expired);
+		if (stats.matched)
+			ImGui::Text("    p50 %.2f ms  p95 %.2f ms  p99 %.2f ms  max %.2f ms", stats.p50, stats.p95, stats.p99, stats.max);
+	}
+
+	float histogram[INPUT_LATENCY_BUCKETS];
+	int used = monitor.GetHistogram(histogram, INPUT_LATENCY_BUCKETS);
+	if (used < 80)
+		used = 80;
+	char label[32];
+	sprintf_s(label, "0 - %.0f ms", used * INPUT_LATENCY_BUCKET_MS);
+	ImGui::PlotHistogram("##latency", histogram, used, 0, label, 0.0f, FLT_MAX, ImVec2(0, 80));
+
+	ImGui::TreePop();
+}
+
+void DebugWindow::DrawBattleInputQueue()
+{
+	if (!ImGui::TreeNode("Battle input queue"))
+	{
+		// Start from what's written when it's opened again
+		m_battleInputCursor.attached = false;
+		return;
+	}
+
+	const size_t MAX_RECORDS = 64;
+	BattleInputRecord record;
+	while (PollBattleInput(m_battleInputCursor, record))
+	{
+		if (m_battleInputs.size() == MAX_RECORDS)
+			m_battleInputs.pop_front();
+		m_battleInputs.push_back(record);
+	}
+
+	static const char* sourceNames[] = { "game", "keyboard", "tool", "sequencer", "takeover" };
+	ImGui::Text("Written: %u", GetBattleInputWriteCount());
+	ImGui::Text("Dropped (this window): %u", m_battleInputCursor.dropped);
+	for (auto it = m_battleInputs.rbegin(); it != m_battleInputs.rend(); ++it)
+	{
+		ImGui::Text("%u P%d observed %3u applied %3u %s", it->frame, it->player + 1, it->observed, it->applied,
+			it->source < IM_ARRAYSIZE(sourceNames) ? sourceNames[it->source] : "?");
+	}
+
+	ImGui::TreePop();
+}
+
+void DebugWindow::DrawInputSequencer()
+{
+	if (!ImGui::TreeNode("Input sequencer"))
+		return;
+
+	static const char* stateNames[] = { "idle", "running", "finished" };
+	InputSequencer& sequencer = InputSequencer::GetInstance();
+	for (uint32_t player = 0; player < 2; player++)
+	{
+		ImGui::PushID(player);
+		ImGui::Text("P%u: %s pc %u frame %u", player + 1, stateNames[sequencer.GetState(player)],
+			sequencer.GetPc(player), sequencer.GetFrame(player));
+		ImGui::SameLine();
+		if (ImGui::Button("5A x10"))
+		{
+			// 5A then 10 frames of neutral, ten times
+			InputProgramBuilder builder;
+			const int again = builder.Bind(builder.NewLabel());
+			builder.Hold(5 + 16, 1).Hold(5, 10).Loop(again, 10);
+			std::unique_ptr<InputProgram> program(new InputProgram);
+			std::string error;
+			if (builder.Build(*program, error))
+				sequencer.Start(player, std::move(program));
+			else
+				LOG(2, "DebugWindow::DrawInputSequencer %s\n", error.c_str());
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Stop"))
+			sequencer.Stop(player);
+		ImGui::PopID();
+	}
+
+	ImGui::TreePop();
+}
+
 void DebugWindow::DrawRoomSection()
 {
 	if (!ImGui::CollapsingHeader("Room"))
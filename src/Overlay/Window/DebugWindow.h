@@ -1,13 +1,19 @@
 #pragma once
 #include "IWindow.h"
 
+#include "Game/EntityTracker.h"
+#include "Game/GameEventBus.h"
+#include "Hooks/hooks_battle_input.h"
+
+#include <deque>
+
 class DebugWindow : public IWindow
 {
 public:
 	DebugWindow(const std::string& windowTitle, bool windowClosable,
 		ImGuiWindowFlags windowFlags = 0)
 		: IWindow(windowTitle, windowClosable, windowFlags) {}
-	~DebugWindow() override = default;
+	~DebugWindow() override;
 
 protected:
 	void Draw() override;
@@ -18,6 +24,19 @@ private:
 	void DrawRoomSection();
 	void DrawSettingsSection();
 	void DrawNotificationSection();
+	void DrawEntityTracker();
+	void DrawGameEvents();
+	void DrawInputLatency();
+	void DrawBattleInputQueue();
+	void DrawInputSequencer();
 
 	bool m_showDemoWindow = false;
+	int m_entityListener = 0;
+	std::deque<EntityEvent> m_entityEvents;
+	GameEventCursor m_gameEventCursor;
+	uint32_t m_gameEventsSequence = 0;
+	std::deque<GameEvent> m_gameEvents;
+	std::string m_latencyExportPath;
+	BattleInputCursor m_battleInputCursor;
+	std::deque<BattleInputRecord> m_battleInputs;
 };
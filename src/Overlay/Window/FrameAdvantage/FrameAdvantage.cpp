@@ -70,7 +70,8 @@ bool hasWorldTimeMoved()
 
 void computeFramedataInteractions()
 {
-    if (!isInMatch && !(*g_gameVals.pGameMode == GameMode_Training || *g_gameVals.pGameMode == GameMode_ReplayTheater))
+    // Same modes the Framedata section offers the window in
+    if (!isInMatch() || !(*g_gameVals.pGameMode == GameMode_Training || *g_gameVals.pGameMode == GameMode_ReplayTheater))
         return;
 
     if (!g_interfaces.player1.IsCharDataNullPtr() && !g_interfaces.player2.IsCharDataNullPtr())
@@ -8,8 +8,6 @@
 
 void FrameAdvantageWindow::Draw() {
 
-	computeFramedataInteractions();
-
 	
 
 	
@@ -0,0 +1,157 @@
+#include "ActionTable.h"
+
+#include <cstring>
+
+namespace {
+    // thanks to PCVolt
+    const char* const idleWords[] = {
+        // now classified under "Special"
+        // "CmnActFDash",
+
+        "_NEUTRAL", "CmnActStand", "CmnActStandTurn", "CmnActStand2Crouch",
+        "CmnActCrouch", "CmnActCrouchTurn", "CmnActCrouch2Stand", "CmnActFWalk",
+        "CmnActBWalk", "CmnActFDashStop", "CmnActJumpUpper",
+        "CmnActJumpDown", "CmnActJumpUpperEnd", "CmnActJumpLanding",
+        "CmnActLandingStiffEnd",
+        "CmnActUkemiLandNLanding", // to fix, 12F too long!
+        // Proxi block is triggered when an attack is closing in without being
+        // actually blocked If the player.blockstun is = 0, then those animations
+        // are still considered idle
+        "CmnActCrouchGuardPre", "CmnActCrouchGuardLoop", "CmnActCrouchGuardEnd", // Crouch
+        "CmnActCrouchHeavyGuardPre", "CmnActCrouchHeavyGuardLoop", "CmnActCrouchHeavyGuardEnd", // Crouch Heavy
+        "CmnActMidGuardPre", "CmnActMidGuardLoop", "CmnActMidGuardEnd", // Mid
+        "CmnActMidHeavyGuardPre", "CmnActMidHeavyGuardLoop", "CmnActMidHeavyGuardEnd", // Mid Heavy
+        "CmnActHighGuardPre", "CmnActHighGuardLoop", "CmnActHighGuardEnd", // High
+        "CmnActHighHeavyGuardPre", "CmnActHighHeavyGuardLoop", "CmnActHighHeavyGuardEnd", // High Heavy
+        "CmnActAirGuardPre", "CmnActAirGuardLoop", "CmnActAirGuardEnd", // Air
+        // Character specifics
+        "com3_kamae" // Mai 5xB stance
+    };
+
+    uint32_t hash_name(const char* name) {
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+        for (const char* c = name; *c; c++) {
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        }
+        return hash;
+    }
+
+    int first_det_active(const std::vector<FrameActivity>& activity_status) {
+        for (size_t i = 0; i < activity_status.size(); i++) {
+            if (activity_status[i] == FrameActivity::Active) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
+}
+
+void ActionTable::clear() {
+    names.clear();
+    nameOffsets.clear();
+    buckets.clear();
+    states.clear();
+    firstActiveFrames.clear();
+    idle.clear();
+    ukemiLandNLanding = ACTION_ID_NONE;
+    landingStiffLoop = ACTION_ID_NONE;
+}
+
+void ActionTable::reserve(size_t stateCount) {
+    clear();
+
+    const size_t nameCount = stateCount + sizeof(idleWords) / sizeof(idleWords[0]) + 1;
+    size_t bucketCount = 16;
+    while (bucketCount < nameCount * 2) {
+        bucketCount <<= 1;
+    }
+    buckets.assign(bucketCount, ACTION_ID_NONE);
+}
+
+void ActionTable::load(const std::vector<scrState*>& scrStates) {
+    reserve(scrStates.size());
+
+    for (scrState* state : scrStates) {
+        const uint16_t id = intern(state->name.c_str());
+        if (id != ACTION_ID_NONE && !states[id]) {
+            states[id] = state;
+            firstActiveFrames[id] = first_det_active(state->frame_activity_status);
+        }
+    }
+    markIdle();
+}
+
+void ActionTable::load(const FrameDataDB& db, const FrameDataDBCharacter* character) {
+    reserve(character->record_count);
+
+    const FrameDataRecord* records = db.GetRecords(character);
+    for (uint32_t i = 0; i < character->record_count; i++) {
+        // the names are fixed size, a full one has no terminator
+        char recordName[sizeof(records[i].name) + 1] = {};
+        memcpy(recordName, records[i].name, sizeof(records[i].name));
+        // a name defined twice keeps the first record, like the script path and the database index
+        const uint16_t newId = idCount();
+        const uint16_t id = intern(recordName);
+        if (id != ACTION_ID_NONE && id == newId) {
+            firstActiveFrames[id] = (int)records[i].first_active - 1;
+        }
+    }
+    markIdle();
+}
+
+void ActionTable::markIdle() {
+    // Idle actions that aren't in the script still get an id, _NEUTRAL for one. Every id is handed out before the
+    // idle bits are sized.
+    for (const char* word : idleWords) {
+        intern(word);
+    }
+    ukemiLandNLanding = find("CmnActUkemiLandNLanding");
+    landingStiffLoop = intern("CmnActLandingStiffLoop");
+
+    idle.assign((idCount() + 63) / 64, 0);
+    for (const char* word : idleWords) {
+        const uint16_t id = find(word);
+        if (id != ACTION_ID_NONE) {
+            idle[id >> 6] |= 1ull << (id & 63);
+        }
+    }
+}
+
+uint16_t ActionTable::find(const char* actionName) const {
+    if (buckets.empty()) {
+        return ACTION_ID_NONE;
+    }
+    const size_t mask = buckets.size() - 1;
+    for (size_t i = hash_name(actionName) & mask;; i = (i + 1) & mask) {
+        const uint16_t id = buckets[i];
+        if (id == ACTION_ID_NONE || strcmp(name(id), actionName) == 0) {
+            return id;
+        }
+    }
+}
+
+uint16_t ActionTable::intern(const char* actionName) {
+    const size_t mask = buckets.size() - 1;
+    size_t i = hash_name(actionName) & mask;
+    for (;; i = (i + 1) & mask) {
+        const uint16_t id = buckets[i];
+        if (id == ACTION_ID_NONE) {
+            break;
+        }
+        if (strcmp(name(id), actionName) == 0) {
+            return id;
+        }
+    }
+    if (nameOffsets.size() >= ACTION_ID_NONE || nameOffsets.size() * 2 >= buckets.size()) {
+        return ACTION_ID_NONE;
+    }
+
+    const uint16_t id = (uint16_t)nameOffsets.size();
+    nameOffsets.push_back((uint32_t)names.size());
+    names.insert(names.end(), actionName, actionName + strlen(actionName) + 1);
+    states.push_back(nullptr);
+    firstActiveFrames.push_back(-1);
+    buckets[i] = id;
+    return id;
+}
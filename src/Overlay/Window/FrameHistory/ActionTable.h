@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Game/Scr/FrameDataDB.h"
+#include "Game/Scr/ScrStateEntry.h"
+
+#include <cstdint>
+#include <vector>
+
+const uint16_t ACTION_ID_NONE = 0xFFFF;
+
+/// The action names of one character interned to ids when the character is
+/// loaded. The frame history only looks an action up by name when the state
+/// changes, everything it checks every frame (idle, first active frame, the
+/// couple of actions with special rules) is indexed by the id.
+class ActionTable {
+public:
+    void load(const std::vector<scrState*>& states);
+    /// Same as above from the frame data database, state() is nullptr for every action
+    void load(const FrameDataDB& db, const FrameDataDBCharacter* character);
+    void clear();
+
+    /// ACTION_ID_NONE if the character has no action with that name
+    uint16_t find(const char* name) const;
+
+    scrState* state(uint16_t id) const { return id < states.size() ? states[id] : nullptr; }
+    bool isIdle(uint16_t id) const { return (size_t)(id >> 6) < idle.size() && (idle[id >> 6] >> (id & 63)) & 1; }
+    /// -1 if the action has no deterministic active frame
+    int firstActive(uint16_t id) const { return id < firstActiveFrames.size() ? firstActiveFrames[id] : -1; }
+    uint16_t idCount() const { return (uint16_t)nameOffsets.size(); }
+
+    uint16_t ukemiLandNLanding = ACTION_ID_NONE;
+    uint16_t landingStiffLoop = ACTION_ID_NONE;
+
+private:
+    void reserve(size_t stateCount);
+    void markIdle();
+    uint16_t intern(const char* name);
+    const char* name(uint16_t id) const { return &names[nameOffsets[id]]; }
+
+    std::vector<char> names; // every name, null terminated
+    std::vector<uint32_t> nameOffsets;
+    std::vector<uint16_t> buckets; // open addressing, power of two
+    std::vector<scrState*> states; // nullptr for the names that aren't in the script
+    std::vector<int> firstActiveFrames;
+    std::vector<uint64_t> idle;
+};
@@ -1,37 +1,14 @@
 #include "FrameHistory.h"
+#include "FrameHistoryLog.h"
 #include "Overlay/Window/FrameAdvantage/PlayerExtendedData.h"
 #include <cstddef>
+#include <cstring>
 #include "Core/logger.h"
+#include "Game/Jonb/JonbCollision.h"
 #include "Overlay/Logger/ImGuiLogger.h"
 #define MAX(a,b)            (((a) > (b)) ? (a) : (b))
 
 
-// thanks to PCVolt
-const std::vector<std::string> idleWords = {
-    // now classified under "Special"
-    // "CmnActFDash",
-
-    
-    "_NEUTRAL", "CmnActStand", "CmnActStandTurn", "CmnActStand2Crouch",
-    "CmnActCrouch", "CmnActCrouchTurn", "CmnActCrouch2Stand", "CmnActFWalk",
-    "CmnActBWalk", "CmnActFDashStop", "CmnActJumpUpper",
-    "CmnActJumpDown", "CmnActJumpUpperEnd", "CmnActJumpLanding",
-    "CmnActLandingStiffEnd",
-    "CmnActUkemiLandNLanding", // to fix, 12F too long!
-    // Proxi block is triggered when an attack is closing in without being
-    // actually blocked If the player.blockstun is = 0, then those animations
-    // are still considered idle
-    "CmnActCrouchGuardPre", "CmnActCrouchGuardLoop", "CmnActCrouchGuardEnd", // Crouch
-    "CmnActCrouchHeavyGuardPre", "CmnActCrouchHeavyGuardLoop", "CmnActCrouchHeavyGuardEnd", // Crouch Heavy
-    "CmnActMidGuardPre", "CmnActMidGuardLoop", "CmnActMidGuardEnd", // Mid
-    "CmnActMidHeavyGuardPre", "CmnActMidHeavyGuardLoop", "CmnActMidHeavyGuardEnd", // Mid Heavy
-    "CmnActHighGuardPre", "CmnActHighGuardLoop", "CmnActHighGuardEnd", // High
-    "CmnActHighHeavyGuardPre", "CmnActHighHeavyGuardLoop", "CmnActHighHeavyGuardEnd", // High Heavy
-    "CmnActAirGuardPre", "CmnActAirGuardLoop", "CmnActAirGuardEnd", // Air
-    // Character specifics
-    "com3_kamae" // Mai 5xB stance
-};
-
 // TODO: Make this use arbitrary bases vectors
 std::array<float, 3> attributetoColor(Attribute attr, std::array<Attribute, 3> rgb_attr) {
     std::array<float, 3> res = {};
@@ -104,16 +81,6 @@ std::array<float, 3> kindtoColor(FrameKind kind) {
     return res;
 }
 
-int first_det_active(std::vector<FrameActivity>& activity_status) {
-    for (size_t i = 0; i < activity_status.size(); i++) {
-        if (activity_status[i] == FrameActivity::Active) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-
 Attribute parse_dyn_invul(uint32 invul_field, uint32 gp_bitfield) {
     if ((invul_field & 0x02) == 0) {
         return Attribute::N;
@@ -133,7 +100,7 @@ Attribute parse_dyn_invul(uint32 invul_field, uint32 gp_bitfield) {
     return invul;
 }
 
-PlayerFrameState::PlayerFrameState(scrState* state, unsigned int frame,
+PlayerFrameState::PlayerFrameState(const ActionTable& actions, uint16_t action, unsigned int frame,
     CharData* player, BackedUpCharData old_data) {
 
     // set state variables
@@ -142,20 +109,12 @@ PlayerFrameState::PlayerFrameState(scrState* state, unsigned int frame,
     
     
     // Set kind
-    std::string currentAction = std::string(player->currentAction);
-    int fst_det_active;
+    const size_t hitboxCount = JonbReader::getJonbEntries(player).HitboxCount();
+    const int fst_det_active = actions.firstActive(action);
     Attribute det_invul = Attribute::N;
-    bool is_idle_state = std::find(std::begin(idleWords), std::end(idleWords), currentAction) != std::end(idleWords);
-    
-    if (state == nullptr) {
-        fst_det_active = -1;
-    }
-    else {
-        fst_det_active = first_det_active(state->frame_activity_status);
-    }
-    
+    bool is_idle_state = actions.isIdle(action);
 
-    if (is_new && currentAction == "CmnActUkemiLandNLanding") {
+    if (is_new && action == actions.ukemiLandNLanding) {
         kind = FrameKind::Recovery;
     }
     else if (is_idle_state) {
@@ -164,7 +123,7 @@ PlayerFrameState::PlayerFrameState(scrState* state, unsigned int frame,
     else {
         kind = FrameKind::Special;
     }
-    if (player->hitboxCount > 0
+    if (hitboxCount > 0
         && (player->bitflags_for_curr_state_properties_or_smth & (0x400 | 0x200)) == 0) {
         kind = FrameKind::Active | kind;
     }
@@ -176,12 +135,12 @@ PlayerFrameState::PlayerFrameState(scrState* state, unsigned int frame,
     }
 
     // hardlanding is set even if the player is still airborn. We only want to flag the *landing* portion
-    if (/*player->hardLandingRecovery > 0 && player->position_y + old_data.position_y == 0 && */currentAction == "CmnActLandingStiffLoop") {
+    if (/*player->hardLandingRecovery > 0 && player->position_y + old_data.position_y == 0 && */action == actions.landingStiffLoop) {
         kind = FrameKind::HardLanding | kind;
     }
     // NOTE: Startup is only defined in a context with deterministic active frames
     if (fst_det_active > -1
-        && (player->hitboxCount <= 0 || (player->bitflags_for_curr_state_properties_or_smth & (0x400 | 0x200)) == 0)
+        && (hitboxCount <= 0 || (player->bitflags_for_curr_state_properties_or_smth & (0x400 | 0x200)) == 0)
         && !is_idle_state) {
         
         if (frame < fst_det_active) {
@@ -210,18 +169,11 @@ bool FrameHistory::getPlayerFrameStates(CharData* player1,
     // we need the amount of frames spent on the current state, in order to index into the state frames.
     // TODO: Might want to count frames since last update, and add those to the p1_frames. However, what if a state was changed in between updates, then we can't know.
     // This is all the more reason to query states purely dynamically.
-    std::string currentAction = std::string(player1->currentAction);
     // If the actionTime hasn't yet changed, don't register this frame.
     bool condition1 = p1_frames == player1->actionTime - 1;
     if (player1->stateChangedCount != p1_stateChangedCount) {
-        // if it is not, fetch the new states from the map
-        auto p1_new_state = p1_StateMap.find(currentAction);
-        if (p1_new_state != p1_StateMap.end()) {
-            p1_State = p1_StateMap.at(currentAction);
-        }
-        else {
-            p1_State = nullptr;
-        }
+        // if it is not, fetch the new action id, the only name lookup
+        p1_action = p1_actions.find(player1->currentAction);
         p1_frames = 0;
     }
     else {
@@ -229,16 +181,9 @@ bool FrameHistory::getPlayerFrameStates(CharData* player1,
         // increment this. If there is hitstop, do not add a frame.
         p1_frames = player1->actionTime - 1;
     }
-    currentAction = std::string(player2->currentAction);
     bool condition2 = p2_frames == player2->actionTime - 1;
     if (player2->stateChangedCount != p2_stateChangedCount) {
-        auto p2_new_state = p2_StateMap.find(currentAction);
-        if (p2_new_state != p2_StateMap.end()) {
-            p2_State = p2_StateMap.at(currentAction);
-        }
-        else {
-            p2_State = nullptr;
-        }
+        p2_action = p2_actions.find(player2->currentAction);
         p2_frames = 0;
     }
     else {
@@ -254,15 +199,18 @@ bool FrameHistory::getPlayerFrameStates(CharData* player1,
         return false;
     }
     else {
-        *res = { PlayerFrameState(p1_State, p1_frames, player1, p1_old_data),
-            PlayerFrameState(p2_State, p2_frames, player2, p2_old_data) };
+        *res = { PlayerFrameState(p1_actions, p1_action, p1_frames, player1, p1_old_data),
+            PlayerFrameState(p2_actions, p2_action, p2_frames, player2, p2_old_data) };
+        const HitboxCollisionResult& collision = HitboxCollision::GetInstance().Update();
+        (*res)[0].hitbox_gap = collision.sides[0].gap;
+        (*res)[1].hitbox_gap = collision.sides[1].gap;
         return true;
     }
 }
 
 /// update the history queue with the new player states. Only call after the
 /// game time has moved and by NO MORE than 1 frame
-void FrameHistory::updateHistory(bool resetting) {
+void FrameHistory::updateHistory(bool resetting, FrameHistoryLogWriter* log) {
     CharData* p1 = g_interfaces.player1.GetData();
     CharData* p2 = g_interfaces.player2.GetData();
 
@@ -283,6 +231,9 @@ void FrameHistory::updateHistory(bool resetting) {
     p1_stateChangedCount = p1->stateChangedCount;
     p2_stateChangedCount = p2->stateChangedCount;
 
+    if (log && log->IsRecording()) {
+        log->Append(states, g_gameVals.pFrameCount ? *g_gameVals.pFrameCount : 0, p1->charIndex, p2->charIndex);
+    }
 
     // TODO: If you add attack and guardp, add them to this condition
     // Reset on completely idle frames
@@ -302,11 +253,7 @@ void FrameHistory::updateHistory(bool resetting) {
             queue.clear();
         }
 
-        while (queue.size() >= HISTORY_DEPTH) {
-            queue.pop_front();
-        }
-        
-        queue.push_back(states);
+        queue.push(states);
         is_old = false;
     }
     // after doing updates, store this information for later.
@@ -323,7 +270,36 @@ void FrameHistory::backupChars()
     p2_old_data.position_y = p2->position_y;
 }
 
-StatePairQueue& FrameHistory::read() { return queue; }
+const StatePairRing& FrameHistory::read() const { return queue; }
+
+void FrameHistory::setDepth(size_t depth) {
+    queue.setDepth(depth < HISTORY_MAX_DEPTH ? depth : HISTORY_MAX_DEPTH);
+}
+
+void StatePairRing::setDepth(size_t depth) {
+    if (depth == 0) {
+        depth = 1;
+    }
+    size_t capacity = 1;
+    while (capacity < depth) {
+        capacity <<= 1;
+    }
+    if (capacity != m_mask + 1 || !m_buffer) {
+        m_buffer.reset(new StatePair[capacity]);
+        m_mask = capacity - 1;
+    }
+    m_depth = depth;
+    m_head = 0;
+    m_count = 0;
+}
+
+void StatePairRing::push(const StatePair& states) {
+    m_buffer[m_head & m_mask] = states;
+    m_head++;
+    if (m_count < m_depth) {
+        m_count++;
+    }
+}
 
 // TODO: Add safety checks
 void FrameHistory::loadCharData() {
@@ -337,29 +313,33 @@ void FrameHistory::loadCharData() {
     p1_stateChangedCount = p1->stateChangedCount - 1;
     p2_stateChangedCount = p2->stateChangedCount - 1;
 
+    // The frame data database has everything the history needs, the scripts are only parsed for the characters it doesn't have
+    const FrameDataDB* db = g_interfaces.pFrameDataDB;
+    const FrameDataDBCharacter* p1_record = db && db->IsOpen() ? db->FindCharacter(p1->char_abbr) : nullptr;
+    const FrameDataDBCharacter* p2_record = db && db->IsOpen() ? db->FindCharacter(p2->char_abbr) : nullptr;
+
     char* bbcf_base_adress = GetBbcfBaseAdress();
 
-    std::vector<scrState*> states_p1 = parse_scr(bbcf_base_adress, 1);
-    std::vector<scrState*> states_p2;
-    if (p1_charIndex == p2_charIndex) {
-        states_p2 = parse_scr(bbcf_base_adress, 1);
+    if (p1_record) {
+        p1_actions.load(*db, p1_record);
     } else {
-        states_p2 = parse_scr(bbcf_base_adress, 2);
+        p1_actions.load(parse_scr(bbcf_base_adress, 1));
     }
-
-    for (size_t i1 = 0; i1 < states_p1.size(); i1++) {
-        p1_StateMap[states_p1[i1]->name] = states_p1[i1];
-    }
-
-    for (size_t i2 = 0; i2 < states_p2.size(); i2++) {
-        p2_StateMap[states_p2[i2]->name] = states_p2[i2];
+    if (p2_record) {
+        p2_actions.load(*db, p2_record);
+    } else if (p1_charIndex == p2_charIndex) {
+        p2_actions.load(parse_scr(bbcf_base_adress, 1));
+    } else {
+        p2_actions.load(parse_scr(bbcf_base_adress, 2));
     }
+    p1_action = ACTION_ID_NONE;
+    p2_action = ACTION_ID_NONE;
 }
 
 void FrameHistory::clear() { queue.clear(); }
 
 FrameHistory::FrameHistory() {
-    queue = std::deque<StatePair>();
+    queue.setDepth(HISTORY_DEFAULT_DEPTH);
     p1_old_data = BackedUpCharData();
     p2_old_data = BackedUpCharData();
 }
@@ -1,17 +1,19 @@
 #pragma once
 
+#include "ActionTable.h"
 #include "Core/interfaces.h"
 #include "Core/utils.h"
 #include "Game/CharData.h"
-#include "Game/Jonb/JonbDBReader.h"
+#include "Game/Jonb/JonbReader.h"
 #include "Game/Scr/ScrStateReader.h"
 #include "imgui.h"
 #include <array>
 #include <cstddef>
-#include <deque>
+#include <memory>
 
-// maximum number of frames to be kept track of in the history
-const size_t HISTORY_DEPTH = 100;
+// number of frames kept track of in the history, see FrameHistory::setDepth
+const size_t HISTORY_DEFAULT_DEPTH = 100;
+const size_t HISTORY_MAX_DEPTH = 4096;
 
 /// An arbitrary, and abstract categorization of player state, several of these
 /// are difficult to determine, they are here as a reminder to future
@@ -95,14 +97,41 @@ public:
     // Boolean to signify that this frame is the first from the current state
     bool is_new = false;
     bool loggable = true;
+    // Closest hitbox of this player to a hurtbox of the other one, 0 when it hits, -1 without active hitboxes.
+    // See HitboxCollisionSide::gap
+    float hitbox_gap = -1.0f;
 
-    PlayerFrameState(scrState* state, unsigned int frame, CharData* player, BackedUpCharData old_data);
+    PlayerFrameState(const ActionTable& actions, uint16_t action, unsigned int frame, CharData* player, BackedUpCharData old_data);
     //PlayerFrameState(bool loggable);
     PlayerFrameState();
 };
 
 typedef std::array<PlayerFrameState, 2> StatePair;
-typedef std::deque<StatePair> StatePairQueue;
+
+class FrameHistoryLogWriter;
+
+/// Fixed ring of the last frames, the buffer is only allocated when the depth
+/// changes so pushing a frame never allocates
+class StatePairRing {
+public:
+    void setDepth(size_t depth);
+    size_t depth() const { return m_depth; }
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    void clear() { m_count = 0; }
+    /// Overwrites the oldest frame once the ring holds depth frames
+    void push(const StatePair& states);
+    /// 0 is the newest frame
+    const StatePair& newest(size_t age) const { return m_buffer[(m_head - 1 - age) & m_mask]; }
+
+private:
+    std::unique_ptr<StatePair[]> m_buffer;
+    size_t m_mask = 0;
+    size_t m_head = 0;
+    size_t m_count = 0;
+    size_t m_depth = 0;
+};
 
 
 struct FrameHistory {
@@ -112,9 +141,12 @@ public:
 
     // Update history with new data
     // Overwrites old history if both players have been previously idle
-    void updateHistory(bool resetting);
+    // Every computed frame is also appended to log when it's recording, idle ones included
+    void updateHistory(bool resetting, FrameHistoryLogWriter* log = nullptr);
 
-    StatePairQueue& read();
+    const StatePairRing& read() const;
+    // clamped to HISTORY_MAX_DEPTH, drops the history
+    void setDepth(size_t depth);
     // void updateJonBMaps();
 
     // I would like to use these two to track state frame time and the char index
@@ -124,7 +156,7 @@ public:
     void clear();
 
 private:
-    StatePairQueue queue;
+    StatePairRing queue;
     bool is_old = false;
 
     // to check if characters changed
@@ -140,11 +172,11 @@ private:
     unsigned int p1_frames = 0;
     unsigned int p2_frames = 0;
 
-    scrState* p1_State = NULL;
-    scrState* p2_State = NULL;
-
-    std::map<std::string, scrState*> p1_StateMap = {};
-    std::map<std::string, scrState*> p2_StateMap = {};
+    // actions of the loaded characters, looked up only when the state changes
+    ActionTable p1_actions;
+    ActionTable p2_actions;
+    uint16_t p1_action = ACTION_ID_NONE;
+    uint16_t p2_action = ACTION_ID_NONE;
 
     BackedUpCharData p1_old_data;
     BackedUpCharData p2_old_data;
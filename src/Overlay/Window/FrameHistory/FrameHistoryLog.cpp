@@ -0,0 +1,311 @@
+#include "FrameHistoryLog.h"
+
+#include "Core/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#define FRAME_LOG_FOLDER_PATH "BBCF_IM\\framelogs"
+
+namespace {
+    const uint16_t KIND_MASK = 0x00FF;
+    const uint16_t IS_NEW_BIT = 0x4000;
+    const uint16_t EXTENSION_BIT = 0x8000;
+
+    // invul bits that fit in the record, in record bit order starting at bit 8
+    const Attribute packedInvul[] = { Attribute::H, Attribute::B, Attribute::F, Attribute::T, Attribute::P, Attribute::GP };
+    const int PACKED_INVUL_SHIFT = 8;
+
+    uint16_t pack_invul(Attribute invul, bool& fits) {
+        uint16_t bits = 0;
+        int remaining = static_cast<int>(invul);
+        for (int i = 0; i < 6; i++) {
+            if (bool(invul & packedInvul[i])) {
+                bits |= 1 << (PACKED_INVUL_SHIFT + i);
+                remaining &= ~static_cast<int>(packedInvul[i]);
+            }
+        }
+        fits = remaining == 0;
+        return bits;
+    }
+}
+
+uint16_t frame_log_pack(const PlayerFrameState& state, bool& needsExtension) {
+    bool invulFits;
+    uint16_t record = static_cast<uint16_t>(static_cast<int>(state.kind) & KIND_MASK);
+    record |= pack_invul(state.invul, invulFits);
+    if (state.is_new) {
+        record |= IS_NEW_BIT;
+    }
+    needsExtension = !invulFits || (static_cast<int>(state.kind) & ~KIND_MASK) != 0
+        || state.guardp != Attribute::N || state.attack != Attribute::N;
+    if (needsExtension) {
+        record |= EXTENSION_BIT;
+    }
+    return record;
+}
+
+PlayerFrameState frame_log_unpack(uint16_t record, const FrameLogExtension* extension) {
+    PlayerFrameState state;
+    state.kind = static_cast<FrameKind>(record & KIND_MASK);
+    state.is_new = (record & IS_NEW_BIT) != 0;
+    if ((record & EXTENSION_BIT) && extension) {
+        state.kind = static_cast<FrameKind>(extension->kind);
+        state.invul = static_cast<Attribute>(extension->invul);
+        state.guardp = static_cast<Attribute>(extension->guardp);
+        state.attack = static_cast<Attribute>(extension->attack);
+        return state;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (record & (1 << (PACKED_INVUL_SHIFT + i))) {
+            state.invul = state.invul | packedInvul[i];
+        }
+    }
+    return state;
+}
+
+FrameHistoryLogWriter::~FrameHistoryLogWriter() {
+    Stop();
+}
+
+bool FrameHistoryLogWriter::Start() {
+    if (m_file) {
+        return true;
+    }
+
+    CreateDirectoryA(FRAME_LOG_FOLDER_PATH, NULL);
+    char fileName[64];
+    time_t now = time(nullptr);
+    strftime(fileName, sizeof(fileName), "framehistory_%Y%m%d_%H%M%S.bbfh", localtime(&now));
+    m_path = std::string(FRAME_LOG_FOLDER_PATH) + "\\" + fileName;
+
+    m_file = fopen(m_path.c_str(), "wb");
+    if (!m_file) {
+        LOG(2, "FrameHistoryLogWriter::Start couldn't create %s\n", m_path.c_str());
+        return false;
+    }
+
+    FrameLogFileHeader header = {};
+    memcpy(header.magic, "BBFH", 4);
+    header.version = FRAME_LOG_VERSION;
+    header.block_records = FRAME_LOG_BLOCK_RECORDS;
+    fwrite(&header, sizeof(header), 1, m_file);
+
+    m_bytesWritten = sizeof(header);
+    m_recordCount = 0;
+    m_block = {};
+    m_records.reserve(FRAME_LOG_BLOCK_RECORDS * 2);
+    m_records.clear();
+    m_extensions.clear();
+    LOG(2, "FrameHistoryLogWriter::Start %s\n", m_path.c_str());
+    return true;
+}
+
+void FrameHistoryLogWriter::Stop() {
+    if (!m_file) {
+        return;
+    }
+    FlushBlock();
+    fclose(m_file);
+    m_file = nullptr;
+    LOG(2, "FrameHistoryLogWriter::Stop %u frames\n", m_recordCount);
+}
+
+void FrameHistoryLogWriter::Append(const StatePair& states, unsigned int gameFrame, int32_t p1CharIndex, int32_t p2CharIndex) {
+    if (!m_file) {
+        return;
+    }
+    if (m_block.record_count && (m_block.char_index[0] != p1CharIndex || m_block.char_index[1] != p2CharIndex)) {
+        FlushBlock();
+    }
+    if (!m_block.record_count) {
+        m_block.first_record = m_recordCount;
+        m_block.first_game_frame = gameFrame;
+        m_block.char_index[0] = (int16_t)p1CharIndex;
+        m_block.char_index[1] = (int16_t)p2CharIndex;
+    }
+
+    for (uint8_t player = 0; player < 2; player++) {
+        bool needsExtension;
+        m_records.push_back(frame_log_pack(states[player], needsExtension));
+        if (needsExtension) {
+            FrameLogExtension extension = {};
+            extension.record = m_block.record_count;
+            extension.player = player;
+            extension.invul = static_cast<uint16_t>(states[player].invul);
+            extension.guardp = static_cast<uint16_t>(states[player].guardp);
+            extension.attack = static_cast<uint16_t>(states[player].attack);
+            extension.kind = static_cast<int32_t>(states[player].kind);
+            m_extensions.push_back(extension);
+        }
+    }
+    m_block.last_game_frame = gameFrame;
+    m_block.record_count++;
+    m_recordCount++;
+
+    if (m_block.record_count == FRAME_LOG_BLOCK_RECORDS) {
+        FlushBlock();
+    }
+}
+
+void FrameHistoryLogWriter::FlushBlock() {
+    if (!m_block.record_count) {
+        return;
+    }
+    memcpy(m_block.magic, "FHLB", 4);
+    m_block.ext_count = (uint16_t)m_extensions.size();
+    fwrite(&m_block, sizeof(m_block), 1, m_file);
+    fwrite(m_records.data(), sizeof(uint16_t), m_records.size(), m_file);
+    if (!m_extensions.empty()) {
+        fwrite(m_extensions.data(), sizeof(FrameLogExtension), m_extensions.size(), m_file);
+    }
+    fflush(m_file);
+
+    m_bytesWritten += sizeof(m_block) + m_records.size() * sizeof(uint16_t) + m_extensions.size() * sizeof(FrameLogExtension);
+    m_block = {};
+    m_records.clear();
+    m_extensions.clear();
+}
+
+bool FrameHistoryLogReader::Open(const std::string& path) {
+    Close();
+    m_path = path;
+    m_file.open(path, std::ios::binary);
+    if (!m_file) {
+        return FailOpen("can't open the file");
+    }
+
+    FrameLogFileHeader header;
+    if (!m_file.read((char*)&header, sizeof(header)) || memcmp(header.magic, "BBFH", 4) != 0) {
+        return FailOpen("not a frame history log");
+    }
+    if (header.version != FRAME_LOG_VERSION) {
+        return FailOpen("unsupported frame history log version");
+    }
+
+    m_file.seekg(0, std::ios::end);
+    const uint64_t fileSize = (uint64_t)m_file.tellg();
+    uint64_t offset = sizeof(header);
+    while (offset + sizeof(FrameLogBlockHeader) <= fileSize) {
+        Block block;
+        m_file.seekg(offset);
+        if (!m_file.read((char*)&block.header, sizeof(block.header)) || memcmp(block.header.magic, "FHLB", 4) != 0) {
+            break;
+        }
+        block.offset = offset + sizeof(block.header);
+        const uint64_t blockEnd = block.offset + block.header.record_count * 2 * sizeof(uint16_t)
+            + block.header.ext_count * sizeof(FrameLogExtension);
+        // Cut short while writing, everything before it is still good
+        if (blockEnd > fileSize || block.header.first_record != m_recordCount) {
+            break;
+        }
+        m_blocks.push_back(block);
+        m_recordCount += block.header.record_count;
+        offset = blockEnd;
+    }
+    m_file.clear();
+    return true;
+}
+
+void FrameHistoryLogReader::Close() {
+    if (m_file.is_open()) {
+        m_file.close();
+    }
+    m_file.clear();
+    m_error.clear();
+    m_blocks.clear();
+    m_recordCount = 0;
+    m_loadedBlock = -1;
+}
+
+bool FrameHistoryLogReader::Read(uint32_t record, StatePair& out) {
+    const int blockIndex = FindBlock(record);
+    if (blockIndex < 0 || !LoadBlock(blockIndex)) {
+        return false;
+    }
+
+    const uint32_t inBlock = record - m_blocks[blockIndex].header.first_record;
+    for (uint8_t player = 0; player < 2; player++) {
+        const uint16_t packed = m_records[inBlock * 2 + player];
+        const FrameLogExtension* extension = nullptr;
+        if (packed & 0x8000) {
+            // sorted by record, then player
+            auto it = std::lower_bound(m_extensions.begin(), m_extensions.end(), std::make_pair(inBlock, player),
+                [](const FrameLogExtension& ext, const std::pair<uint32_t, uint8_t>& key) {
+                    return ext.record < key.first || (ext.record == key.first && ext.player < key.second);
+                });
+            if (it != m_extensions.end() && it->record == inBlock && it->player == player) {
+                extension = &*it;
+            }
+        }
+        out[player] = frame_log_unpack(packed, extension);
+    }
+    return true;
+}
+
+bool FrameHistoryLogReader::ReadInto(uint32_t last, size_t count, StatePairRing& ring) {
+    ring.clear();
+    if (last >= m_recordCount) {
+        return false;
+    }
+    const uint32_t first = count > last ? 0 : last + 1 - (uint32_t)count;
+    StatePair states;
+    for (uint32_t record = first; record <= last; record++) {
+        if (!Read(record, states)) {
+            return false;
+        }
+        ring.push(states);
+    }
+    return true;
+}
+
+bool FrameHistoryLogReader::GetGameFrames(uint32_t record, uint32_t& first, uint32_t& last) const {
+    const int blockIndex = FindBlock(record);
+    if (blockIndex < 0) {
+        return false;
+    }
+    first = m_blocks[blockIndex].header.first_game_frame;
+    last = m_blocks[blockIndex].header.last_game_frame;
+    return true;
+}
+
+int FrameHistoryLogReader::FindBlock(uint32_t record) const {
+    if (record >= m_recordCount) {
+        return -1;
+    }
+    auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), record,
+        [](uint32_t value, const Block& block) { return value < block.header.first_record; });
+    return (int)(it - m_blocks.begin()) - 1;
+}
+
+bool FrameHistoryLogReader::LoadBlock(int index) {
+    if (index == m_loadedBlock) {
+        return true;
+    }
+    const Block& block = m_blocks[index];
+    m_records.resize(block.header.record_count * 2);
+    m_extensions.resize(block.header.ext_count);
+    m_file.seekg(block.offset);
+    m_file.read((char*)m_records.data(), m_records.size() * sizeof(uint16_t));
+    if (!m_extensions.empty()) {
+        m_file.read((char*)m_extensions.data(), m_extensions.size() * sizeof(FrameLogExtension));
+    }
+    if (!m_file) {
+        m_file.clear();
+        m_loadedBlock = -1;
+        return Fail("can't read a block");
+    }
+    m_loadedBlock = index;
+    return true;
+}
+
+bool FrameHistoryLogReader::FailOpen(const char* error) {
+    Close();
+    return Fail(error);
+}
+
+bool FrameHistoryLogReader::Fail(const char* error) {
+    m_error = error;
+    return false;
+}
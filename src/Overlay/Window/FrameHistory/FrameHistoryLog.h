@@ -0,0 +1,142 @@
+#pragma once
+
+#include "FrameHistory.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+.bbfh frame history log, every frame the FrameHistory computes for both players.
+
+    FrameLogFileHeader
+    blocks: FrameLogBlockHeader
+            uint16_t records[record_count][2]   one per player, see frame_log_pack
+            FrameLogExtension[ext_count]
+
+A record is bit-packed into 16 bits, 2 bytes per player-frame:
+    bits 0-7   FrameKind
+    bits 8-13  invul H, B, F, T, P, GP
+    bit  14    is_new
+    bit  15    the player has a FrameLogExtension in this block (guardp, attack, kind or invul bits not above)
+Records have a fixed size so the Nth frame of a block is found without decoding the ones before it, the block headers
+give the random access into the file. A block is written when it's full or the characters change, a log cut short
+only loses the block that was being filled.
+*/
+
+const uint16_t FRAME_LOG_VERSION = 2; //2 added the full kind to FrameLogExtension
+const uint16_t FRAME_LOG_BLOCK_RECORDS = 1024; //~17 seconds per block
+
+#pragma pack(push, 1)
+struct FrameLogFileHeader
+{
+    char magic[4]; //"BBFH"
+    uint16_t version;
+    uint16_t block_records;
+    uint32_t reserved[2];
+};
+
+struct FrameLogBlockHeader
+{
+    char magic[4]; //"FHLB"
+    uint32_t first_record; //index of the first frame of the block in the whole log
+    uint32_t first_game_frame;
+    uint32_t last_game_frame;
+    uint16_t record_count;
+    uint16_t ext_count;
+    int16_t char_index[2];
+};
+
+struct FrameLogExtension
+{
+    uint16_t record; //in the block
+    uint8_t player;
+    uint8_t reserved;
+    uint16_t invul;
+    uint16_t guardp;
+    uint16_t attack;
+    int32_t kind; //the whole FrameKind, the record only keeps the low byte
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FrameLogFileHeader) == 16, "FrameLogFileHeader layout changed");
+static_assert(sizeof(FrameLogBlockHeader) == 24, "FrameLogBlockHeader layout changed");
+static_assert(sizeof(FrameLogExtension) == 14, "FrameLogExtension layout changed");
+
+// Sets needsExtension when the state doesn't fit in the 16 bits
+uint16_t frame_log_pack(const PlayerFrameState& state, bool& needsExtension);
+PlayerFrameState frame_log_unpack(uint16_t record, const FrameLogExtension* extension);
+
+// Appends to BBCF_IM/framelogs while the frame history runs, everything is written from the game thread
+class FrameHistoryLogWriter
+{
+public:
+    ~FrameHistoryLogWriter();
+
+    bool Start();
+    void Stop();
+    bool IsRecording() const { return m_file != nullptr; }
+
+    void Append(const StatePair& states, unsigned int gameFrame, int32_t p1CharIndex, int32_t p2CharIndex);
+
+    const std::string& GetPath() const { return m_path; }
+    uint32_t GetRecordCount() const { return m_recordCount; }
+    uint64_t GetBytesWritten() const { return m_bytesWritten; }
+
+private:
+    void FlushBlock();
+
+    FILE* m_file = nullptr;
+    std::string m_path;
+    FrameLogBlockHeader m_block = {};
+    std::vector<uint16_t> m_records;
+    std::vector<FrameLogExtension> m_extensions;
+    uint32_t m_recordCount = 0;
+    uint64_t m_bytesWritten = 0;
+};
+
+// Reads a log back for the frame history review, the whole file is indexed on Open and blocks are loaded as they're needed
+class FrameHistoryLogReader
+{
+public:
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return m_file.is_open(); }
+    const std::string& GetPath() const { return m_path; }
+    const std::string& GetError() const { return m_error; }
+
+    uint32_t GetRecordCount() const { return m_recordCount; }
+    size_t GetBlockCount() const { return m_blocks.size(); }
+    const FrameLogBlockHeader& GetBlock(size_t index) const { return m_blocks[index].header; }
+
+    // Frame index in the log, 0 is the first frame recorded
+    bool Read(uint32_t record, StatePair& out);
+    // Pushes the count frames ending at last into the ring, oldest first, so the newest is last
+    bool ReadInto(uint32_t last, size_t count, StatePairRing& ring);
+    // The game frame the record was recorded on is only known per block, this is the block's range
+    bool GetGameFrames(uint32_t record, uint32_t& first, uint32_t& last) const;
+
+private:
+    struct Block
+    {
+        FrameLogBlockHeader header;
+        uint64_t offset; //of the records
+    };
+
+    int FindBlock(uint32_t record) const;
+    bool LoadBlock(int index);
+    bool Fail(const char* error);
+    bool FailOpen(const char* error);
+
+    std::ifstream m_file;
+    std::string m_path;
+    std::string m_error;
+    std::vector<Block> m_blocks;
+    uint32_t m_recordCount = 0;
+
+    int m_loadedBlock = -1;
+    std::vector<uint16_t> m_records;
+    std::vector<FrameLogExtension> m_extensions;
+};
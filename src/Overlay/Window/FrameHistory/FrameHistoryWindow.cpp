@@ -4,6 +4,7 @@
 
 #include "Core/interfaces.h"
 #include "Core/Localization.h"
+#include "Game/FrameSnapshot.h"
 #include "Game/gamestates.h"
 #include "imgui_internal.h"
 #include "Core/utils.h"
@@ -89,8 +90,9 @@ ImVec2 MakeBall(ImColor color, float radius_proportion, ImVec2 offset, float wid
 }
 
 bool FrameHistoryWindow::hasWorldTimeMoved() {
-	bool res = *g_gameVals.pFrameCount > last_frame;
-	last_frame = *g_gameVals.pFrameCount;
+	const FrameSnapshot& snapshot = FrameSnapshotCache::GetInstance().Get();
+	bool res = snapshot.frame > last_frame;
+	last_frame = snapshot.frame;
 	return res;
 }
 
@@ -105,10 +107,9 @@ void FrameHistoryWindow::Update()
 
 	// May want to come up with our own function to check if time moved.
 	// The current implementation doesn't check if we missed frames.
-	if (!g_interfaces.player1.IsCharDataNullPtr() &&
-		!g_interfaces.player2.IsCharDataNullPtr() && hasWorldTimeMoved()) {
+	if (FrameSnapshotCache::GetInstance().Get().HasPlayers() && hasWorldTimeMoved()) {
 
-		history.updateHistory(resetting);
+		history.updateHistory(resetting, &log);
 	}
 
 	BeforeDraw();
@@ -123,11 +124,37 @@ void FrameHistoryWindow::Update()
 	AfterDraw();
 }
 
+void FrameHistoryWindow::SetReviewPosition(int position) {
+	if (!review.IsOpen() || review.GetRecordCount() == 0) {
+		reviewing = false;
+		return;
+	}
+	reviewPosition = MAX(0, MIN(position, (int)review.GetRecordCount() - 1));
+	if (reviewRing.depth() != history.read().depth()) {
+		reviewRing.setDepth(history.read().depth());
+	}
+	reviewing = review.ReadInto(reviewPosition, reviewRing.depth(), reviewRing);
+}
+
 // Use this to push styles and such
 void FrameHistoryWindow::BeforeDraw() {}
 // pop styles, clean up drawing state
 void FrameHistoryWindow::AfterDraw() {}
 
+// Next to the player label, whether the player's active hitboxes would hit on the latest frame
+void DrawHitboxGap(float gap) {
+	if (gap < 0) {
+		return;
+	}
+	ImGui::SameLine();
+	if (gap == 0) {
+		ImGui::TextColored(ImVec4(1, 0.25f, 0.25f, 1), Messages.FrameHistory_hit_label());
+	}
+	else {
+		ImGui::TextDisabled(Messages.FrameHistory_miss_gap(), gap);
+	}
+}
+
 void FrameHistoryWindow::Draw() {
 		// CharData* p1 = g_interfaces.player1.GetData();
 		// CharData* p2 = g_interfaces.player2.GetData();
@@ -142,11 +169,12 @@ void FrameHistoryWindow::Draw() {
 		// Define the colors for invul types
 		ImColor color_inv = ImColor(255, 255, 255);
 		ImColor color_gp = ImColor(122, 85, 61);
-		// borrow the history queue
-		StatePairQueue& queue = history.read();
+		// borrow the history ring
+		const StatePairRing& queue = reviewing ? reviewRing : history.read();
 		int frame_idx = 0;
 
 ImGui::Text(Messages.Player_1());
+		DrawHitboxGap(queue.empty() ? -1.0f : queue.newest(0)[0].hitbox_gap);
 		// Rows starting point. Be careful where you place this
 		ImVec2 cursor_p = ImGui::GetCursorScreenPos();
 
@@ -160,9 +188,11 @@ ImGui::Text(Messages.Player_1());
 		// Reclaim space after player 1 rows so Player 2 appears below
 		ImGui::Dummy(ImVec2(0, (height + spacing) * ((rows >> 1) - 1) + height));
 ImGui::Text(Messages.Player_2());
-		for (StatePairQueue::reverse_iterator elem = queue.rbegin(); elem != queue.rend(); ++elem) {
-			PlayerFrameState p1state = elem->front();
-			PlayerFrameState p2state = elem->back();
+		DrawHitboxGap(queue.empty() ? -1.0f : queue.newest(0)[1].hitbox_gap);
+		for (size_t age = 0; age < queue.size(); ++age) {
+			const StatePair& elem = queue.newest(age);
+			const PlayerFrameState& p1state = elem[0];
+			const PlayerFrameState& p2state = elem[1];
 
 			// determine colors
 			// Need to make it more rubust later, format of the colors:
@@ -4,6 +4,7 @@
 #include "Core/interfaces.h"
 #include "Game/CharData.h"
 #include "FrameHistory.h"
+#include "FrameHistoryLog.h"
 
 #include <imgui.h>
 
@@ -12,10 +13,18 @@ public:
 	float width = 12.;
 	float height = 20.;
 	float spacing = 6.;
+	int depth = (int)HISTORY_DEFAULT_DEPTH;
 	int last_frame = 0;
 
 	bool resetting = true;
 	FrameHistory history;
+	FrameHistoryLogWriter log;
+
+	// A log loaded from BBCF_IM/framelogs is drawn instead of the live history while reviewing
+	FrameHistoryLogReader review;
+	bool reviewing = false;
+	int reviewPosition = 0; //newest frame drawn, index in the log
+	void SetReviewPosition(int position);
 
 	FrameHistoryWindow(const std::string& windowTitle, bool windowClosable,
 		ImGuiWindowFlags windowFlags = ImGuiWindowFlags_NoTitleBar)
@@ -23,6 +32,8 @@ public:
 			width = g_modVals.frame_history_width;
 			height = g_modVals.frame_history_height;
 			spacing = g_modVals.frame_history_spacing;
+			depth = g_modVals.frame_history_depth;
+			history.setDepth(depth);
 		}
 
 	void Update() override;
@@ -31,4 +42,6 @@ protected:
 	void Draw() override;
 	void AfterDraw() override;
 	bool hasWorldTimeMoved();
+
+	StatePairRing reviewRing;
 };
@@ -1,10 +1,15 @@
 #include "HitboxOverlay.h"
 
 #include "Core/interfaces.h"
+#include "Core/Localization.h"
 #include "Game/gamestates.h"
-#include "Game/Jonb/JonbReader.h"
+#include "Game/Jonb/JonbCollision.h"
 #include "imgui_internal.h"
 #include "Core/utils.h"
+#include "Overlay/WindowManager.h"
+#include "Overlay/imgui_utils.h"
+
+#include <emmintrin.h>
 
 void HitboxOverlay::Update()
 {
@@ -38,48 +43,114 @@ void HitboxOverlay::BeforeDraw()
 
 	this->io = ImGui::GetIO();
 	displayRatio = io.DisplaySize.x / io.DisplaySize.y;
-	aspectRatioAddress = GetBbcfBaseAdress() + 0x65A5E4;
 	ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x, io.DisplaySize.y));
 }
 
 void HitboxOverlay::Draw()
 {
-	for (int i = 0; i < g_gameVals.entityCount; i++)
+	LARGE_INTEGER start, end, frequency;
+	QueryPerformanceCounter(&start);
+
+	const FrameSnapshot& snapshot = FrameSnapshotCache::GetInstance().Get();
+	if (!snapshot.camera.valid)
+	{
+		return;
+	}
+	PrepareProjection(snapshot.camera);
+
+	// Sized for the worst case first so the arrays can be taken from the arena in one go
+	FrameArena& arena = WindowManager::GetInstance().GetFrameArena();
+	const int entityCount = snapshot.entity_count;
+	JonbEntrySpan* entitySpans = arena.AllocateArray<JonbEntrySpan>(entityCount);
+	m_entityTransforms = arena.AllocateArray<EntityTransform>(entityCount + 1); //+1 for the trail, already in world space
+	m_batchEntities = arena.AllocateArray<BatchEntity>(entityCount);
+	m_entityCount = 0;
+	m_boxCount = 0;
+	m_boxCapacity = 0;
+	if (!entitySpans || !m_entityTransforms || !m_batchEntities)
 	{
-		CharData* pEntity = (CharData*)g_gameVals.pEntityList[i];
-		const bool isCharacter = i < 2;
-		const bool isEntityActive = pEntity->unknownStatus1 == 1 && pEntity->pJonbEntryBegin;
+		return;
+	}
 
-		if (isCharacter || isEntityActive)
+	for (int i = 0; i < entityCount; i++)
+	{
+		const EntitySnapshot& entity = snapshot.entities[i];
+		entitySpans[i] = JonbEntrySpan();
+		if (entity.side != -1 && drawCharacterHitbox[entity.side])
 		{
-			if (!IsOwnerEnabled(pEntity->ownerEntity))
-			{
-				continue;
-			}
-
-			const ImVec2 entityWorldPos = CalculateObjWorldPosition(pEntity);
-			DrawCollisionAreas(pEntity, entityWorldPos);
+			entitySpans[i] = entity.boxes;
+			m_boxCapacity += (uint32_t)entitySpans[i].Size();
 		}
 	}
-}
 
-void HitboxOverlay::AfterDraw()
-{
-ImGui::PopStyleColor();
-ImGui::PopStyleVar(2);
-}
+	// Capturing the current frame only replaces older boxes, so what is stored now is enough room for the trail
+	m_trail.SetDepth(this->drawTrail ? this->trailDepth : 0);
+	const unsigned int currentFrame = snapshot.frame;
+	m_boxCapacity += m_trail.GetBoxCount();
+
+	m_cornerX = arena.AllocateArray<float>(m_boxCapacity * 4);
+	m_cornerY = arena.AllocateArray<float>(m_boxCapacity * 4);
+	m_boxEntity = arena.AllocateArray<uint32_t>(m_boxCapacity);
+	m_boxIsHitbox = arena.AllocateArray<bool>(m_boxCapacity);
+	m_boxFade = arena.AllocateArray<uint8_t>(m_boxCapacity);
+	if (!m_cornerX || !m_cornerY || !m_boxEntity || !m_boxIsHitbox || !m_boxFade)
+	{
+		m_boxCapacity = 0;
+	}
 
-bool HitboxOverlay::IsOwnerEnabled(CharData* ownerCharInfo)
-{
-	for (int i = 0; i < 2; i++)
+	if (m_trail.GetFrameCount())
+	{
+		m_entityTransforms[entityCount] = MakeEntityTransform(ImVec2(0.0f, 0.0f), 1.0f, 0.0f);
+		AddTrailBoxes(entityCount, currentFrame);
+	}
+	m_trailCapturing = snapshot.has_frame && m_trail.BeginFrame(currentFrame);
+
+	for (int i = 0; i < entityCount; i++)
 	{
-		if (ownerCharInfo == (CharData*)g_gameVals.pEntityList[i])
+		if (!entitySpans[i].Empty())
 		{
-			return drawCharacterHitbox[i];
+			const EntitySnapshot& entity = snapshot.entities[i];
+			AddCollisionAreas(entity, CalculateObjWorldPosition(entity), entitySpans[i]);
 		}
 	}
 
-	return false;
+	if (m_trailCapturing)
+	{
+		m_trail.EndFrame();
+		m_trailCapturing = false;
+	}
+
+	TransformBoxBatch();
+	DrawBoxBatch();
+	if (this->drawHitPrediction)
+	{
+		DrawHitPrediction();
+	}
+
+	for (uint32_t i = 0; i < m_entityCount; i++)
+	{
+		const BatchEntity& entity = m_batchEntities[i];
+		if (this->drawCollisionBoxes) {
+			DrawCollisionBoxes(entity.worldPos, entity.rotationRad, entity.charObj);
+		}
+		if (this->drawRangeCheckBoxes) {
+			DrawRangeCheckBoxes(entity.worldPos, entity.rotationRad, entity.charObj);
+		}
+		if (this->drawOriginLine) {
+			DrawOriginLine(entity.worldPos, entity.rotationRad);
+		}
+	}
+
+	QueryPerformanceCounter(&end);
+	QueryPerformanceFrequency(&frequency);
+	m_drawTimeMs = (double)(end.QuadPart - start.QuadPart) * 1000.0 / (double)frequency.QuadPart;
+	m_drawTimeAvgMs += (m_drawTimeMs - m_drawTimeAvgMs) * 0.05;
+}
+
+void HitboxOverlay::AfterDraw()
+{
+ImGui::PopStyleColor();
+ImGui::PopStyleVar(2);
 }
 
 bool HitboxOverlay::HasNullptrInData()
@@ -87,10 +158,10 @@ bool HitboxOverlay::HasNullptrInData()
 	return !g_gameVals.pEntityList;
 }
 
-ImVec2 HitboxOverlay::CalculateObjWorldPosition(const CharData* charObj)
+ImVec2 HitboxOverlay::CalculateObjWorldPosition(const EntitySnapshot& entity)
 {
-	float posX = charObj->position_x_dupe - charObj->offsetX_1 + charObj->offsetX_2;
-	float posY = charObj->position_y_dupe + charObj->offsetY_2;
+	float posX = (float)entity.pos_x;
+	float posY = (float)entity.pos_y;
 
 	return ImVec2(
 		floor(posX / 1000 * m_scale),
@@ -102,7 +173,7 @@ ImVec2 HitboxOverlay::CalculateScreenPosition(ImVec2 worldPos)
 {
 	D3DXVECTOR3 result;
 	D3DXVECTOR3 vec3WorldPos(worldPos.x, worldPos.y, 0.0f);
-	WorldToScreen(g_interfaces.pD3D9ExWrapper, g_gameVals.viewMatrix, g_gameVals.projMatrix, &vec3WorldPos, &result);
+	WorldToScreen(g_interfaces.pD3D9ExWrapper, &m_view, &m_proj, &vec3WorldPos, &result);
 
 	return ImVec2(floor(result.x), floor(result.y));
 }
@@ -133,7 +204,7 @@ ImVec2 HitboxOverlay::RotatePoint(ImVec2 center, float angleInRad, ImVec2 point)
 
 void HitboxOverlay::fixAspectRatio(ImVec2& point)
 {	
-	if (*this->aspectRatioAddress == 1) {
+	if (m_letterboxed) {
 		if (displayRatio > aspectRatio) {
 			float scaling = (io.DisplaySize.x / (io.DisplaySize.y * aspectRatio));
 			float offset = (io.DisplaySize.x - io.DisplaySize.y * aspectRatio) / 2;
@@ -296,96 +367,235 @@ void HitboxOverlay::DrawRangeCheckBoxes(ImVec2 worldPos, float rotationRad, cons
 		int a = 0;
 	}
 }
-void HitboxOverlay::DrawCollisionAreas(const CharData* charObj, const ImVec2 playerWorldPos)
+// Same math as CalculateScreenPosition + fixAspectRatio, taken out of the per point calls since it only changes once a frame
+void HitboxOverlay::PrepareProjection(const CameraSnapshot& camera)
 {
-	std::vector<JonbEntry> entries = JonbReader::getJonbEntries(charObj);
+	D3DVIEWPORT9 viewPort;
+	g_interfaces.pD3D9ExWrapper->GetViewport(&viewPort);
+	m_view = camera.view;
+	m_proj = camera.proj;
+	D3DXMatrixMultiply(&m_viewProj, &m_view, &m_proj);
+	m_letterboxed = camera.letterboxed;
+
+	m_screenScaleX = viewPort.Width / 2.0f;
+	m_screenOffsetX = viewPort.X + viewPort.Width / 2.0f;
+	m_screenScaleY = -(viewPort.Height / 2.0f);
+	m_screenOffsetY = viewPort.Y + viewPort.Height / 2.0f;
+
+	m_aspectScaleX = 1.0f;
+	m_aspectOffsetX = 0.0f;
+	m_aspectScaleY = 1.0f;
+	m_aspectOffsetY = 0.0f;
+	if (m_letterboxed) {
+		if (displayRatio > aspectRatio) {
+			m_aspectScaleX = (io.DisplaySize.y * aspectRatio) / io.DisplaySize.x;
+			m_aspectOffsetX = (io.DisplaySize.x - io.DisplaySize.y * aspectRatio) / 2;
+		}
+		else if (displayRatio < aspectRatio) {
+			m_aspectScaleY = (io.DisplaySize.x / aspectRatio) / io.DisplaySize.y;
+			m_aspectOffsetY = (io.DisplaySize.y - io.DisplaySize.x / aspectRatio) / 2;
+		}
+	}
+}
+
+// Gathers the boxes of the entity into the batch, the corners stay relative to the entity until TransformBoxBatch
+void HitboxOverlay::AddCollisionAreas(const EntitySnapshot& entity, const ImVec2 playerWorldPos, const JonbEntrySpan& entries)
+{
+	const bool facingLeft = (entity.flags & FrameSnapshotEntityFlags_FacingLeft) != 0;
+	float scaleX = entity.scale_x / 1000.0f;
+	float scaleY = entity.scale_y / 1000.0f;
+	float rotationDeg = entity.rotation / 1000.0f;
+	if (!facingLeft && rotationDeg)
+	{
+		rotationDeg = 360.0f - rotationDeg;
+	}
+	float rotationRad = D3DXToRadian(rotationDeg);
+	float s = rotationRad ? sin(rotationRad) : 0.0f;
+	float c = rotationRad ? cos(rotationRad) : 1.0f;
+
+	const uint32_t entityIndex = m_entityCount++;
+	m_entityTransforms[entityIndex] = MakeEntityTransform(playerWorldPos, c, s);
+	m_batchEntities[entityIndex] = { entity.data, playerWorldPos, rotationRad };
+
+	//this will skip the drawing of an inactive hitbox due to multihit/NoAttackDuringSprite(ID 2002) and AttackOff(ID 23027) bbscript commands.
+	const bool hitboxesDisabled = (entity.flags & FrameSnapshotEntityFlags_HitboxesDisabled) != 0;
 
 	for (const JonbEntry& entry : entries)
 	{
-		//this will skip the drawing of an inactive hitbox due to multihit/NoAttackDuringSprite(ID 2002) and AttackOff(ID 23027) bbscript commands.
-
-		if (entry.type == JonbChunkType_Hitbox
-			&&
-			(
-				(charObj->bitflags_for_curr_state_properties_or_smth & 0xF00) == 0x400
-				||
-				(charObj->bitflags_for_curr_state_properties_or_smth & 0xF00) == 0x200
-			)
-		)
-{
+		if ((entry.type == JonbChunkType_Hitbox && hitboxesDisabled) || m_boxCount >= m_boxCapacity)
+		{
 			continue;
 		}
 
-		float scaleX = charObj->scaleX / 1000.0f;
-		float scaleY = charObj->scaleY / 1000.0f;
 		float offsetX =  floor(entry.offsetX * m_scale * scaleX);
 		float offsetY = -floor(entry.offsetY * m_scale * scaleY);
 		float width =    floor(entry.width * m_scale * scaleX);
 		float height =  -floor(entry.height * m_scale * scaleY);
-
-		float rotationDeg = charObj->rotationDegrees / 1000.0f;
-
-		if (!charObj->facingLeft)
+		if (!facingLeft)
 		{
 			offsetX = -offsetX;
 			width = -width;
-			if (rotationDeg)
+		}
+
+		float* cornersX = &m_cornerX[m_boxCount * 4];
+		float* cornersY = &m_cornerY[m_boxCount * 4];
+		cornersX[0] = offsetX;         cornersY[0] = offsetY;
+		cornersX[1] = offsetX + width; cornersY[1] = offsetY;
+		cornersX[2] = offsetX + width; cornersY[2] = offsetY + height;
+		cornersX[3] = offsetX;         cornersY[3] = offsetY + height;
+		m_boxEntity[m_boxCount] = entityIndex;
+		m_boxIsHitbox[m_boxCount] = entry.type == JonbChunkType_Hitbox;
+		m_boxFade[m_boxCount] = 0xFF;
+		m_boxCount++;
+
+		if (m_trailCapturing)
+		{
+			float worldX[4], worldY[4];
+			for (int i = 0; i < 4; i++)
 			{
-				rotationDeg = 360.0f - rotationDeg;
+				worldX[i] = playerWorldPos.x + cornersX[i] * c - cornersY[i] * s;
+				worldY[i] = playerWorldPos.y + cornersX[i] * s + cornersY[i] * c;
 			}
+			m_trail.AddBox(worldX, worldY, entry.type == JonbChunkType_Hitbox);
 		}
+	}
+}
 
-		ImVec2 pointA(playerWorldPos.x + offsetX, playerWorldPos.y + offsetY);
-		ImVec2 pointB(playerWorldPos.x + offsetX + width, playerWorldPos.y + offsetY);
-		ImVec2 pointC(playerWorldPos.x + offsetX + width, playerWorldPos.y + offsetY + height);
-		ImVec2 pointD(playerWorldPos.x + offsetX, playerWorldPos.y + offsetY + height);
-
-		float rotationRad = D3DXToRadian(rotationDeg);
-
-		pointA = RotatePoint(playerWorldPos, rotationRad, pointA);
-		pointB = RotatePoint(playerWorldPos, rotationRad, pointB);
-		pointC = RotatePoint(playerWorldPos, rotationRad, pointC);
-		pointD = RotatePoint(playerWorldPos, rotationRad, pointD);
-		
-		pointA = CalculateScreenPosition(pointA);
-		pointB = CalculateScreenPosition(pointB);
-		pointC = CalculateScreenPosition(pointC);
-		pointD = CalculateScreenPosition(pointD);
-
-		//Fixes aspect ratio when the game is in fullscreen/borderless
-		fixAspectRatio(pointA);
-		fixAspectRatio(pointB);
-		fixAspectRatio(pointC);
-		fixAspectRatio(pointD);
-
-		const unsigned int colorBlue = 0xFF0033CC;
-		const unsigned int colorRed = 0xFFFF0000;
-		const unsigned int rectBorderColor = entry.type == JonbChunkType_Hurtbox ? colorBlue : colorRed;
-		if (this->drawHitboxHurtbox) {
-			RenderRect(pointA, pointB, pointC, pointD, rectBorderColor, m_rectThickness);
-		}
-		const unsigned char transparency = 0xFF * m_rectFillTransparency;
-		unsigned int clearedTransparencyBits = (rectBorderColor & ~0xFF000000);
-		unsigned int transparencyPercentage = ((int)transparency << 24) & 0xFF000000;
-		const unsigned int rectFillColor = clearedTransparencyBits | transparencyPercentage;
-		if (this->drawHitboxHurtbox) {
-			RenderRectFilled(pointA, pointB, pointC, pointD, rectFillColor);
-		}
-		
-		if (this->drawCollisionBoxes) {
-			DrawCollisionBoxes(playerWorldPos, rotationRad, charObj);
-		}
-		
-		if (this->drawRangeCheckBoxes) {
-			DrawRangeCheckBoxes(playerWorldPos, rotationRad, charObj);
+// world = worldPos + R * local, then clip = (world.x, world.y, 0, 1) * viewProj
+HitboxOverlay::EntityTransform HitboxOverlay::MakeEntityTransform(const ImVec2& worldPos, float cosRotation, float sinRotation) const
+{
+	const D3DXMATRIX& m = m_viewProj;
+	EntityTransform transform;
+	float* columns[3] = { transform.clipX, transform.clipY, transform.clipW };
+	const int columnIndex[3] = { 0, 1, 3 };
+	for (int i = 0; i < 3; i++)
+	{
+		float* column = columns[i];
+		float m1 = m.m[0][columnIndex[i]];
+		float m2 = m.m[1][columnIndex[i]];
+		float m4 = m.m[3][columnIndex[i]];
+		column[0] = cosRotation * m1 + sinRotation * m2;
+		column[1] = -sinRotation * m1 + cosRotation * m2;
+		column[2] = worldPos.x * m1 + worldPos.y * m2 + m4;
+	}
+	return transform;
+}
 
+// Boxes of the previous frames go in the batch before the live ones so they are drawn under them, older ones more transparent
+void HitboxOverlay::AddTrailBoxes(uint32_t worldTransformIndex, unsigned int currentFrame)
+{
+	const uint32_t frameCount = m_trail.GetFrameCount();
+	for (uint32_t i = 0; i < frameCount; i++)
+	{
+		const HitboxTrail::Frame& frame = m_trail.GetFrame(i);
+		if (frame.frame == currentFrame)
+		{
+			continue;
 		}
-		if (this->drawOriginLine)
+
+		const uint8_t fade = (uint8_t)(0x99 * (i + 1) / (frameCount + 1));
+		for (uint32_t j = 0; j < frame.boxCount && m_boxCount < m_boxCapacity; j++)
 		{
-			DrawOriginLine(playerWorldPos, rotationRad);
+			const HitboxTrailBox& box = m_trail.GetBox(frame.firstBox + j);
+			float* cornersX = &m_cornerX[m_boxCount * 4];
+			float* cornersY = &m_cornerY[m_boxCount * 4];
+			for (int k = 0; k < 4; k++)
+			{
+				cornersX[k] = box.x[k] / HITBOX_TRAIL_QUANT;
+				cornersY[k] = box.y[k] / HITBOX_TRAIL_QUANT;
+			}
+			m_boxEntity[m_boxCount] = worldTransformIndex;
+			m_boxIsHitbox[m_boxCount] = box.isHitbox;
+			m_boxFade[m_boxCount] = fade;
+			m_boxCount++;
+		}
+	}
+}
+
+// Turns the box local corners into screen positions in place, the 4 corners of a box share a matrix so they go in one SSE register.
+// The corner arrays come from the arena 16 byte aligned, so every box is an aligned load.
+void HitboxOverlay::TransformBoxBatch()
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 screenScaleX = _mm_set1_ps(m_screenScaleX);
+	const __m128 screenOffsetX = _mm_set1_ps(m_screenOffsetX);
+	const __m128 screenScaleY = _mm_set1_ps(m_screenScaleY);
+	const __m128 screenOffsetY = _mm_set1_ps(m_screenOffsetY);
+	const __m128 aspectScaleX = _mm_set1_ps(m_aspectScaleX);
+	const __m128 aspectOffsetX = _mm_set1_ps(m_aspectOffsetX);
+	const __m128 aspectScaleY = _mm_set1_ps(m_aspectScaleY);
+	const __m128 aspectOffsetY = _mm_set1_ps(m_aspectOffsetY);
+
+	for (uint32_t box = 0; box < m_boxCount; box++)
+	{
+		const EntityTransform& t = m_entityTransforms[m_boxEntity[box]];
+		const __m128 localX = _mm_load_ps(&m_cornerX[box * 4]);
+		const __m128 localY = _mm_load_ps(&m_cornerY[box * 4]);
+
+		__m128 clipX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(localX, _mm_set1_ps(t.clipX[0])), _mm_mul_ps(localY, _mm_set1_ps(t.clipX[1]))), _mm_set1_ps(t.clipX[2]));
+		__m128 clipY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(localX, _mm_set1_ps(t.clipY[0])), _mm_mul_ps(localY, _mm_set1_ps(t.clipY[1]))), _mm_set1_ps(t.clipY[2]));
+		__m128 clipW = _mm_add_ps(_mm_add_ps(_mm_mul_ps(localX, _mm_set1_ps(t.clipW[0])), _mm_mul_ps(localY, _mm_set1_ps(t.clipW[1]))), _mm_set1_ps(t.clipW[2]));
+		const __m128 invW = _mm_div_ps(one, clipW);
+
+		__m128 screenX = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(clipX, invW), screenScaleX), screenOffsetX);
+		__m128 screenY = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(clipY, invW), screenScaleY), screenOffsetY);
+
+		// floor, SSE2 only has truncation so the values that got rounded up are corrected
+		__m128 truncX = _mm_cvtepi32_ps(_mm_cvttps_epi32(screenX));
+		__m128 truncY = _mm_cvtepi32_ps(_mm_cvttps_epi32(screenY));
+		screenX = _mm_sub_ps(truncX, _mm_and_ps(_mm_cmpgt_ps(truncX, screenX), one));
+		screenY = _mm_sub_ps(truncY, _mm_and_ps(_mm_cmpgt_ps(truncY, screenY), one));
+
+		_mm_store_ps(&m_cornerX[box * 4], _mm_add_ps(_mm_mul_ps(screenX, aspectScaleX), aspectOffsetX));
+		_mm_store_ps(&m_cornerY[box * 4], _mm_add_ps(_mm_mul_ps(screenY, aspectScaleY), aspectOffsetY));
+	}
+}
+
+void HitboxOverlay::DrawBoxBatch()
+{
+	if (!this->drawHitboxHurtbox || m_boxCount == 0)
+	{
+		return;
+	}
+
+	const unsigned int colorBlue = 0xFF0033CC;
+	const unsigned int colorRed = 0xFFFF0000;
+	const unsigned char transparency = 0xFF * m_rectFillTransparency;
+	const unsigned int colors[2] = { colorBlue, colorRed };
+	ImU32 borderColors[2];
+	ImU32 fillColors[2];
+	for (int i = 0; i < 2; i++)
+	{
+		float r = (colors[i] >> 16) & 0xFF;
+		float g = (colors[i] >> 8) & 0xFF;
+		float b = (colors[i]) & 0xFF;
+		borderColors[i] = ImGui::GetColorU32({ r / 255.0f, g / 255.0f, b / 255.0f, 1.0f });
+		fillColors[i] = ImGui::GetColorU32({ r / 255.0f, g / 255.0f, b / 255.0f, transparency / 255.0f });
+	}
 
+	auto fadeAlpha = [](ImU32 color, uint8_t fade) {
+		return (((color & IM_COL32_A_MASK) >> IM_COL32_A_SHIFT) * fade) / 0xFF;
+	};
+
+	ImDrawList* drawList = ImGui::GetCurrentWindow()->DrawList;
+	for (uint32_t box = 0; box < m_boxCount; box++)
+	{
+		const float* x = &m_cornerX[box * 4];
+		const float* y = &m_cornerY[box * 4];
+		const ImVec2 pointA(x[0], y[0]);
+		const ImVec2 pointB(x[1], y[1]);
+		const ImVec2 pointC(x[2], y[2]);
+		const ImVec2 pointD(x[3], y[3]);
+		const int colorIndex = m_boxIsHitbox[box] ? 1 : 0;
+		ImU32 borderColor = borderColors[colorIndex];
+		ImU32 fillColor = fillColors[colorIndex];
+		if (m_boxFade[box] != 0xFF)
+		{
+			borderColor = (borderColor & ~IM_COL32_A_MASK) | (fadeAlpha(borderColor, m_boxFade[box]) << IM_COL32_A_SHIFT);
+			fillColor = (fillColor & ~IM_COL32_A_MASK) | (fadeAlpha(fillColor, m_boxFade[box]) << IM_COL32_A_SHIFT);
 		}
-	
+		drawList->AddQuad(pointA, pointB, pointC, pointD, borderColor, m_rectThickness);
+		drawList->AddQuadFilled(pointA, pointB, pointC, pointD, fillColor);
 	}
 }
 
@@ -404,6 +614,58 @@ void HitboxOverlay::DrawRectFillTransparencySlider()
 	ImGui::SliderFloat("Fill transparency", &m_rectFillTransparency, 0.0f, 1.0f, "%.2f");
 }
 
+// Labels the entity owning each side's closest hitbox with whether it hits, or by how much it misses
+void HitboxOverlay::DrawHitPrediction()
+{
+	const HitboxCollisionResult& collision = HitboxCollision::GetInstance().Update();
+	ImDrawList* drawList = ImGui::GetCurrentWindow()->DrawList;
+	for (int side = 0; side < 2; side++)
+	{
+		const HitboxCollisionSide& result = collision.sides[side];
+		if (result.attacker_entity < 0 || !drawCharacterHitbox[side])
+		{
+			continue;
+		}
+
+		const EntitySnapshot* attacker = FrameSnapshotCache::GetInstance().Get().FindEntity(result.attacker_entity);
+		if (!attacker)
+		{
+			continue;
+		}
+		ImVec2 labelPos = CalculateScreenPosition(CalculateObjWorldPosition(*attacker));
+		fixAspectRatio(labelPos);
+		char label[32];
+		if (result.hits)
+		{
+			snprintf(label, sizeof(label), "HIT");
+		}
+		else
+		{
+			snprintf(label, sizeof(label), "miss %.1fpx", result.gap);
+		}
+		const ImU32 color = result.hits ? IM_COL32(255, 60, 60, 255) : IM_COL32(255, 255, 255, 255);
+		drawList->AddText(ImVec2(labelPos.x + 1, labelPos.y + 1), IM_COL32(0, 0, 0, 255), label);
+		drawList->AddText(labelPos, color, label);
+	}
+}
+
+void HitboxOverlay::DrawTrailDepthSlider()
+{
+	ImGui::SliderInt(Messages.Trail_frames(), &trailDepth, 1, HITBOX_TRAIL_MAX_DEPTH);
+}
+
+void HitboxOverlay::DrawFrameTimeCounter()
+{
+	const FrameArena& arena = WindowManager::GetInstance().GetFrameArena();
+	ImGui::TextDisabled("Overlay: %.3f ms (avg %.3f ms), %d boxes", m_drawTimeMs, m_drawTimeAvgMs, (int)m_boxCount);
+	ImGui::HorizontalSpacing();
+	ImGui::TextDisabled("Frame scratch: peak %d / %d KB", (int)(arena.GetPeak() / 1024), (int)(arena.GetCapacity() / 1024));
+	const HitboxCollisionResult& collision = HitboxCollision::GetInstance().GetResult();
+	ImGui::HorizontalSpacing();
+	ImGui::TextDisabled("Hit prediction: %.3f ms, %d hitboxes against %d hurtboxes", collision.time_ms,
+		collision.sides[0].hitbox_count + collision.sides[1].hitbox_count, collision.hurtbox_count);
+}
+
 void HitboxOverlay::RenderLine(const ImVec2& from, const ImVec2& to, uint32_t color, float thickness)
 {
 	ImGuiWindow* window = ImGui::GetCurrentWindow();
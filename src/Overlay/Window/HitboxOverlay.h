@@ -2,6 +2,9 @@
 #include "IWindow.h"
 
 #include "Game/CharData.h"
+#include "Game/FrameSnapshot.h"
+#include "Game/Jonb/JonbReader.h"
+#include "HitboxTrail.h"
 
 #include <imgui.h>
 #include <d3dx9.h>
@@ -16,6 +19,9 @@ public:
 	bool drawBoundingBoxes = false;
 	bool drawCollisionBoxes = false;
 	bool drawRangeCheckBoxes = false;
+	bool drawHitPrediction = false;
+	bool drawTrail = false;
+	int trailDepth = 10;
 	bool drawCharacterHitbox[2] = {true, true};
 
 	HitboxOverlay(const std::string& windowTitle, bool windowClosable,
@@ -25,6 +31,8 @@ public:
 	float& GetScale();
 	void DrawRectThicknessSlider();
 	void DrawRectFillTransparencySlider();
+	void DrawTrailDepthSlider();
+	void DrawFrameTimeCounter();
 	bool HasNullptrInData();
 
 protected:
@@ -37,11 +45,15 @@ private:
 	void DrawOriginLine(ImVec2 worldPos, float rotationRad);
 	void DrawRangeCheckBoxes(ImVec2 worldPos, float rotationRad, const CharData* charObj);
 	void DrawCollisionBoxes(ImVec2 worldPos, float rotationRad, const CharData* charObj);
-	void DrawCollisionAreas(const CharData* charObj, const ImVec2 playerWorldPos);
+	void PrepareProjection(const CameraSnapshot& camera);
+	void AddCollisionAreas(const EntitySnapshot& entity, const ImVec2 playerWorldPos, const JonbEntrySpan& entries);
+	void AddTrailBoxes(uint32_t worldTransformIndex, unsigned int currentFrame);
+	void TransformBoxBatch();
+	void DrawBoxBatch();
+	void DrawHitPrediction();
 
-	bool IsOwnerEnabled(CharData* ownerCharInfo);
 	bool WorldToScreen(LPDIRECT3DDEVICE9 pDevice, D3DXMATRIX* view, D3DXMATRIX* proj, D3DXVECTOR3* pos, D3DXVECTOR3* out);
-	ImVec2 CalculateObjWorldPosition(const CharData* charObj);
+	ImVec2 CalculateObjWorldPosition(const EntitySnapshot& entity);
 	ImVec2 CalculateScreenPosition(ImVec2 worldPos);
 	ImVec2 RotatePoint(ImVec2 center, float angleInRad, ImVec2 point);
 
@@ -58,11 +70,51 @@ private:
 	float m_rectThickness = 2.5f;
 	float m_rectFillTransparency = 0.5f;
 
+	// Every box of every entity is gathered here each frame, then transformed and drawn in one go.
+	// The arrays live in the WindowManager's frame arena, so they are only valid during Draw.
+	struct EntityTransform
+	{
+		// Box local position (x, y, 1) to clip space x, y and w, rotation, world position and view/projection in one matrix
+		float clipX[3];
+		float clipY[3];
+		float clipW[3];
+	};
+	EntityTransform MakeEntityTransform(const ImVec2& worldPos, float cosRotation, float sinRotation) const;
+	struct BatchEntity
+	{
+		const CharData* charObj;
+		ImVec2 worldPos;
+		float rotationRad;
+	};
+	EntityTransform* m_entityTransforms = nullptr;
+	BatchEntity* m_batchEntities = nullptr;
+	uint32_t m_entityCount = 0;
+	float* m_cornerX = nullptr; //4 corners per box, box local then screen position after TransformBoxBatch
+	float* m_cornerY = nullptr;
+	uint32_t* m_boxEntity = nullptr;
+	bool* m_boxIsHitbox = nullptr;
+	uint8_t* m_boxFade = nullptr; //alpha multiplier, 0xFF for the live boxes
+	uint32_t m_boxCount = 0;
+	uint32_t m_boxCapacity = 0;
+
+	// Projection of the current frame, world position to screen position
+	D3DXMATRIX m_view;
+	D3DXMATRIX m_proj;
+	D3DXMATRIX m_viewProj;
+	float m_screenScaleX, m_screenOffsetX, m_screenScaleY, m_screenOffsetY;
+	float m_aspectScaleX, m_aspectOffsetX, m_aspectScaleY, m_aspectOffsetY;
+
+	HitboxTrail m_trail;
+	bool m_trailCapturing = false;
+
+	double m_drawTimeMs = 0.0;
+	double m_drawTimeAvgMs = 0.0;
+
 	// Aspect ratio fixes
 	ImGuiIO io;
 	const float aspectRatio = 5.0f / 3.0f;
 	float displayRatio;
-	const char* aspectRatioAddress;
+	bool m_letterboxed = false;
 
 	ImGuiWindowFlags m_overlayWindowFlags = ImGuiWindowFlags_NoTitleBar
 		| ImGuiWindowFlags_NoInputs
@@ -0,0 +1,106 @@
+#include "HitboxTrail.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	int16_t quantize(float value)
+	{
+		float quantized = std::round(value * HITBOX_TRAIL_QUANT);
+		return (int16_t)std::max(-32768.0f, std::min(32767.0f, quantized));
+	}
+}
+
+void HitboxTrail::SetDepth(int depth)
+{
+	depth = std::max(0, std::min(HITBOX_TRAIL_MAX_DEPTH, depth));
+	if (depth != m_depth)
+	{
+		m_depth = depth;
+		Clear();
+	}
+}
+
+void HitboxTrail::Clear()
+{
+	m_boxBegin = 0;
+	m_boxUsed = 0;
+	m_frameBegin = 0;
+	m_frameCount = 0;
+	m_capturing = false;
+	m_hasLastFrame = false;
+}
+
+void HitboxTrail::DropOldestFrame()
+{
+	const Frame& oldest = GetFrame(0);
+	m_boxBegin = (m_boxBegin + oldest.boxCount) % HITBOX_TRAIL_BOX_CAPACITY;
+	m_boxUsed -= oldest.boxCount;
+	m_frameBegin = (m_frameBegin + 1) % (HITBOX_TRAIL_MAX_DEPTH + 1);
+	m_frameCount--;
+}
+
+bool HitboxTrail::BeginFrame(unsigned int frame)
+{
+	if (m_depth == 0 || (m_hasLastFrame && frame == m_lastFrame))
+	{
+		return false;
+	}
+	if (m_hasLastFrame && frame < m_lastFrame)
+	{
+		//the frame counter went back(round reset, rewind), the old boxes don't belong to this timeline
+		Clear();
+	}
+	if (!m_boxes)
+	{
+		m_boxes.reset(new HitboxTrailBox[HITBOX_TRAIL_BOX_CAPACITY]);
+	}
+
+	while (m_frameCount >= (uint32_t)m_depth)
+	{
+		DropOldestFrame();
+	}
+	Frame& newFrame = m_frames[(m_frameBegin + m_frameCount) % (HITBOX_TRAIL_MAX_DEPTH + 1)];
+	newFrame.frame = frame;
+	newFrame.firstBox = (m_boxBegin + m_boxUsed) % HITBOX_TRAIL_BOX_CAPACITY;
+	newFrame.boxCount = 0;
+	m_frameCount++;
+
+	m_capturing = true;
+	m_hasLastFrame = true;
+	m_lastFrame = frame;
+	return true;
+}
+
+void HitboxTrail::AddBox(const float x[4], const float y[4], bool isHitbox)
+{
+	if (!m_capturing)
+	{
+		return;
+	}
+	if (m_boxUsed == HITBOX_TRAIL_BOX_CAPACITY)
+	{
+		//the frame being captured is the newest one, it is never dropped for its own boxes
+		if (m_frameCount == 1)
+		{
+			return;
+		}
+		DropOldestFrame();
+	}
+
+	HitboxTrailBox& box = m_boxes[(m_boxBegin + m_boxUsed) % HITBOX_TRAIL_BOX_CAPACITY];
+	for (int i = 0; i < 4; i++)
+	{
+		box.x[i] = quantize(x[i]);
+		box.y[i] = quantize(y[i]);
+	}
+	box.isHitbox = isHitbox;
+	m_boxUsed++;
+	m_frames[(m_frameBegin + m_frameCount - 1) % (HITBOX_TRAIL_MAX_DEPTH + 1)].boxCount++;
+}
+
+void HitboxTrail::EndFrame()
+{
+	m_capturing = false;
+}
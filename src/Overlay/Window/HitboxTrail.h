@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+
+// One box of a past frame, corners in the overlay's world space stored in 1/HITBOX_TRAIL_QUANT units
+struct HitboxTrailBox
+{
+	int16_t x[4];
+	int16_t y[4];
+	bool isHitbox;
+};
+
+const float HITBOX_TRAIL_QUANT = 8.0f;
+const int HITBOX_TRAIL_MAX_DEPTH = 60;
+const uint32_t HITBOX_TRAIL_BOX_CAPACITY = 32768; //~540 boxes per frame at max depth, 576KB
+
+/*Boxes of the last frames for the HitboxOverlay's trail. Every captured frame appends its boxes to a fixed ring of boxes, the
+oldest frames are dropped when the ring is full or there are more frames than the depth. The ring is allocated once, the first
+time a frame is captured, so capturing never allocates after that and the memory doesn't grow with the entity count.*/
+class HitboxTrail
+{
+public:
+	struct Frame
+	{
+		unsigned int frame;
+		uint32_t firstBox;
+		uint32_t boxCount;
+	};
+
+	// 0 turns the trail off, changing it drops what was captured
+	void SetDepth(int depth);
+	int GetDepth() const { return m_depth; }
+	void Clear();
+
+	// Returns false if the game frame was already captured, so a frozen frame isn't captured again
+	bool BeginFrame(unsigned int frame);
+	void AddBox(const float x[4], const float y[4], bool isHitbox);
+	void EndFrame();
+
+	// Oldest frame first
+	uint32_t GetFrameCount() const { return m_frameCount; }
+	const Frame& GetFrame(uint32_t index) const { return m_frames[(m_frameBegin + index) % (HITBOX_TRAIL_MAX_DEPTH + 1)]; }
+	const HitboxTrailBox& GetBox(uint32_t index) const { return m_boxes[index % HITBOX_TRAIL_BOX_CAPACITY]; }
+	uint32_t GetBoxCount() const { return m_boxUsed; }
+
+private:
+	void DropOldestFrame();
+
+	std::unique_ptr<HitboxTrailBox[]> m_boxes;
+	uint32_t m_boxBegin = 0;
+	uint32_t m_boxUsed = 0;
+	Frame m_frames[HITBOX_TRAIL_MAX_DEPTH + 1];
+	uint32_t m_frameBegin = 0;
+	uint32_t m_frameCount = 0;
+
+	int m_depth = 0;
+	bool m_capturing = false;
+	bool m_hasLastFrame = false;
+	unsigned int m_lastFrame = 0;
+};
@@ -49,6 +49,59 @@ void InputBufferWindow::draw_active_buffers(CharData* player_data) {
     return;
 }
 
+void InputBufferWindow::update_input_history() {
+	const size_t MAX_HISTORY = 20;
+	const uint32_t player_index = player_number == 1 ? 0 : 1;
+	BattleInputRecord record;
+	while (PollBattleInput(history_cursor, record)) {
+		// the hook can write more than once a frame, the motions are stepped once per game frame
+		if (record.player != player_index || (has_history_frame && record.frame == last_history_frame && record.frame != 0)) {
+			continue;
+		}
+		has_history_frame = true;
+		last_history_frame = record.frame;
+
+		const uint32_t motions = motion_recognizer.Step(record.applied, record.facingLeft);
+		if (!input_history.empty() && input_history.back().packed == record.applied && !motions) {
+			input_history.back().frames++;
+			continue;
+		}
+		if (input_history.size() == MAX_HISTORY) {
+			input_history.pop_back();
+		}
+		InputHistoryEntry entry = { record.applied, 1, motions };
+		for (int i = 0; i < Motion_Count; i++) {
+			entry.durations[i] = motion_recognizer.GetDuration((Motion)i) + 1;
+		}
+		input_history.push_front(entry);
+	}
+}
+
+void InputBufferWindow::draw_input_history() {
+	if (!ImGui::CollapsingHeader("Input history")) {
+		return;
+	}
+	static const char* buttons[] = { "A", "B", "C", "D", "P", "S" }; //from bit 4, see InputState::ToPackedValue
+	for (const InputHistoryEntry& entry : input_history) {
+		char line[64];
+		int length = sprintf_s(line, "%3u  %u", entry.frames, entry.packed & 0xF);
+		for (int i = 0; i < 6; i++) {
+			if (entry.packed & (16 << i)) {
+				length += sprintf_s(line + length, sizeof(line) - length, "%s", buttons[i]);
+			}
+		}
+		ImGui::TextUnformatted(line);
+		for (int i = 0; i < Motion_Count; i++) {
+			if (entry.motions & (1u << i)) {
+				const Motion motion = (Motion)i;
+				ImGui::SameLine();
+				ImGui::TextColored(GREEN, "%s %uf/%uf", MotionRecognizer::GetName(motion), entry.durations[i],
+					MotionRecognizer::GetTable(motion).totalWindow);
+			}
+		}
+	}
+}
+
 void InputBufferWindow::Draw()
 {
 	//ImGuiIO& io = ImGui::GetIO();
@@ -79,6 +132,8 @@ void InputBufferWindow::Draw()
 		initialize_buffer_maps(player);
 	}
 	draw_active_buffers(player);
+	update_input_history();
+	draw_input_history();
 	if (ImGui::Button(" + ")) {
 		ImGui::SetWindowFontScale(1.5f);
 	}
@@ -7,6 +7,17 @@
 #include <map>
 #include <string>
 #include "Game/CharData.h"
+#include "Game/MotionInput/MotionRecognizer.h"
+#include "Hooks/hooks_battle_input.h"
+#include <deque>
+
+struct InputHistoryEntry {
+	uint16_t packed;
+	uint32_t frames; //held for
+	uint32_t motions; //bit per Motion completed when it was pressed
+	uint16_t durations[Motion_Count]; //frames each of those took
+};
+
 class InputBufferWindow : public IWindow
 {
 public:
@@ -19,6 +30,8 @@ public:
 	void draw_right_side_buffers(CharData* player_data);
 	void draw_left_side_buffers(CharData* player_data);
 	void draw_active_buffers(CharData* player_data);
+	void update_input_history();
+	void draw_input_history();
 
 
 
@@ -28,4 +41,10 @@ public:
 protected:
 	void Draw() override;
 	int player_number;
+
+	BattleInputCursor history_cursor;
+	MotionRecognizer motion_recognizer;
+	std::deque<InputHistoryEntry> input_history;
+	bool has_history_frame = false;
+	uint32_t last_history_frame = 0;
 };
\ No newline at end of file
@@ -13,7 +13,9 @@
 #include "Core/utils.h"
 #include "Core/Localization.h"
 #include "Game/gamestates.h"
+#include "Game/Trace/TraceRecorder.h"
 #include "Overlay/imgui_utils.h"
+#include "Overlay/NotificationBar/NotificationBar.h"
 #include "Overlay/Window/ControllerSettings/ControllerSettingsSection.h"
 #include "Overlay/Widget/ActiveGameModeWidget.h"
 #include "Overlay/Widget/GameModeSelectWidget.h"
@@ -23,7 +25,10 @@
 
 #include "imgui_internal.h"
 
+#include <algorithm>
 #include <array>
+#include <experimental/filesystem>
+#include <functional>
 #include <sstream>
 #include <utility>
 #include <cstring>
@@ -290,6 +295,105 @@ void MainWindow::DrawFrameHistorySection() const
 	if (ImGui::SliderFloat(Messages.spacing(), &frameHistWin->spacing, 1., 100.)) {
 		Settings::changeSetting("FrameHistorySpacing", std::to_string(frameHistWin->spacing));
 	};
+	ImGui::HorizontalSpacing();
+	if (ImGui::SliderInt(Messages.FrameHistory_depth_label(), &frameHistWin->depth, 1, (int)HISTORY_MAX_DEPTH)) {
+		frameHistWin->history.setDepth(frameHistWin->depth);
+		Settings::changeSetting("FrameHistoryDepth", std::to_string(frameHistWin->depth));
+		frameHistWin->SetReviewPosition(frameHistWin->reviewPosition);
+	}
+
+	ImGui::VerticalSpacing();
+	FrameHistoryLogWriter& log = frameHistWin->log;
+	ImGui::HorizontalSpacing();
+	if (ImGui::Button(log.IsRecording() ? Messages.FrameHistory_log_stop() : Messages.FrameHistory_log_start()))
+	{
+		if (log.IsRecording())
+		{
+			log.Stop();
+		}
+		else if (!log.Start())
+		{
+			g_notificationBar->AddNotification(Messages.FrameHistory_log_create_error());
+		}
+	}
+	ImGui::SameLine();
+	ImGui::ShowHelpMarker(Messages.FrameHistory_log_help());
+	if (log.IsRecording() || log.GetRecordCount())
+	{
+		ImGui::SameLine();
+		ImGui::Text(Messages.FrameHistory_log_size(), log.GetRecordCount(), log.GetBytesWritten() / 1024.0);
+	}
+
+	static std::vector<std::string> logFiles;
+	static int selectedLog = 0;
+	static bool logFilesListed = false;
+	ImGui::HorizontalSpacing();
+	if (ImGui::Button(Messages.FrameHistory_refresh_logs()) || !logFilesListed)
+	{
+		logFilesListed = true;
+		logFiles.clear();
+		std::error_code error;
+		for (const auto& entry : std::experimental::filesystem::directory_iterator("BBCF_IM\\framelogs", error))
+		{
+			if (entry.path().extension() == ".bbfh")
+			{
+				logFiles.push_back(entry.path().filename().string());
+			}
+		}
+		std::sort(logFiles.begin(), logFiles.end(), std::greater<std::string>()); //newest first
+		selectedLog = 0;
+	}
+	if (logFiles.empty())
+	{
+		return;
+	}
+	ImGui::SameLine();
+	ImGui::PushItemWidth(220);
+	if (ImGui::BeginCombo("##framelogs", logFiles[selectedLog].c_str()))
+	{
+		for (int i = 0; i < (int)logFiles.size(); i++)
+		{
+			if (ImGui::Selectable(logFiles[i].c_str(), i == selectedLog))
+			{
+				selectedLog = i;
+			}
+		}
+		ImGui::EndCombo();
+	}
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	if (ImGui::Button(Messages.FrameHistory_review_log()))
+	{
+		if (frameHistWin->review.Open("BBCF_IM\\framelogs\\" + logFiles[selectedLog]))
+		{
+			frameHistWin->SetReviewPosition(frameHistWin->review.GetRecordCount() - 1);
+		}
+		else
+		{
+			g_notificationBar->AddNotification(Messages.FrameHistory_log_load_error(), logFiles[selectedLog].c_str(), frameHistWin->review.GetError().c_str());
+		}
+	}
+
+	if (frameHistWin->reviewing)
+	{
+		FrameHistoryLogReader& review = frameHistWin->review;
+		int position = frameHistWin->reviewPosition;
+		ImGui::HorizontalSpacing();
+		if (ImGui::SliderInt(Messages.FrameHistory_log_frame_label(), &position, 0, (int)review.GetRecordCount() - 1))
+		{
+			frameHistWin->SetReviewPosition(position);
+		}
+		uint32_t firstGameFrame = 0, lastGameFrame = 0;
+		review.GetGameFrames(frameHistWin->reviewPosition, firstGameFrame, lastGameFrame);
+		ImGui::HorizontalSpacing();
+		ImGui::Text(Messages.FrameHistory_log_game_frames(), firstGameFrame, lastGameFrame);
+		ImGui::SameLine();
+		if (ImGui::Button(Messages.FrameHistory_back_to_live()))
+		{
+			frameHistWin->reviewing = false;
+			review.Close();
+		}
+	}
 
 
 }
@@ -420,6 +524,9 @@ void MainWindow::DrawHitboxOverlaySection() const
 		ImGui::HorizontalSpacing();
 		m_pWindowContainer->GetWindow<HitboxOverlay>(WindowType_HitboxOverlay)->DrawRectFillTransparencySlider();
 
+		ImGui::HorizontalSpacing();
+		m_pWindowContainer->GetWindow<HitboxOverlay>(WindowType_HitboxOverlay)->DrawFrameTimeCounter();
+
 		ImGui::HorizontalSpacing();
 		ImGui::Checkbox(Messages.Draw_hitbox_hurtbox(),
 			&m_pWindowContainer->GetWindow<HitboxOverlay>(WindowType_HitboxOverlay)->drawHitboxHurtbox);
@@ -438,6 +545,44 @@ ImGui::ShowHelpMarker(Messages.Collision_box_note());
 			&m_pWindowContainer->GetWindow<HitboxOverlay>(WindowType_HitboxOverlay)->drawRangeCheckBoxes);
 		ImGui::SameLine();
 		ImGui::ShowHelpMarker(Messages.Throw_range_help());
+		ImGui::HorizontalSpacing();
+		ImGui::Checkbox(Messages.Draw_hit_prediction(),
+			&m_pWindowContainer->GetWindow<HitboxOverlay>(WindowType_HitboxOverlay)->drawHitPrediction);
+		ImGui::SameLine();
+		ImGui::ShowHelpMarker(Messages.Hit_prediction_help());
+		ImGui::HorizontalSpacing();
+		ImGui::Checkbox(Messages.Draw_hitbox_trail(),
+			&m_pWindowContainer->GetWindow<HitboxOverlay>(WindowType_HitboxOverlay)->drawTrail);
+		ImGui::SameLine();
+		ImGui::ShowHelpMarker(Messages.Hitbox_trail_help());
+		if (m_pWindowContainer->GetWindow<HitboxOverlay>(WindowType_HitboxOverlay)->drawTrail)
+		{
+			ImGui::HorizontalSpacing();
+			m_pWindowContainer->GetWindow<HitboxOverlay>(WindowType_HitboxOverlay)->DrawTrailDepthSlider();
+		}
+		ImGui::VerticalSpacing();
+
+		TraceRecorder& traceRecorder = TraceRecorder::GetInstance();
+		ImGui::HorizontalSpacing();
+		if (ImGui::Button(traceRecorder.IsRecording() ? Messages.Stop_trace() : Messages.Record_trace()))
+		{
+			if (traceRecorder.IsRecording())
+			{
+				traceRecorder.Stop();
+			}
+			else if (!traceRecorder.Start())
+			{
+				g_notificationBar->AddNotification(Messages.Trace_create_error());
+			}
+		}
+		ImGui::SameLine();
+		ImGui::ShowHelpMarker(Messages.Trace_help());
+		if (traceRecorder.IsRecording() || traceRecorder.GetFrameCount())
+		{
+			ImGui::SameLine();
+			ImGui::Text(Messages.Trace_size(), traceRecorder.GetFrameCount(),
+				traceRecorder.GetBytesWritten() / 1024.0, traceRecorder.GetDroppedCount());
+		}
 		ImGui::VerticalSpacing();
 
 		ImGui::HorizontalSpacing();
@@ -3,7 +3,7 @@
 #include "Core/Localization.h"
 
 void PlaybackEditorWindow::Draw() {
-	static std::vector<std::vector<char>> playback_slot_buffers = { PlaybackSlot(1).get_slot_buffer(),
+	static std::vector<std::vector<uint16_t>> playback_slot_buffers = { PlaybackSlot(1).get_slot_buffer(),
 																	PlaybackSlot(2).get_slot_buffer(),
 																	PlaybackSlot(3).get_slot_buffer(),
 																	PlaybackSlot(4).get_slot_buffer()
@@ -46,7 +46,7 @@ void PlaybackEditorWindow::Draw() {
 		apply_scroll_pos = false;
 	}
 	initialScrollPosition = ImGui::GetScrollY();
-	for (std::vector<char>::iterator it = selected_slot_buffer->begin(); it != selected_slot_buffer->end(); it++)
+	for (std::vector<uint16_t>::iterator it = selected_slot_buffer->begin(); it != selected_slot_buffer->end(); it++)
 	{
 
 		ImGui::PushID((int)"playback_editor" + counter);
@@ -117,7 +117,7 @@ void PlaybackEditorWindow::Draw() {
 	}
 	return;
 }
-void PlaybackEditorWindow::DrawEditLinePopup(char* line) {
+void PlaybackEditorWindow::DrawEditLinePopup(uint16_t* line) {
 	//void PlaybackEditorWindow::DrawEditLinePopup() {
 	ImGui::SetNextWindowPos(ImGui::GetMousePos());
 	ImGui::PushID("draw_edit_line_popup");
@@ -166,7 +166,7 @@ void PlaybackEditorWindow::DrawEditLinePopup(char* line) {
 
 
 	if (ImGui::Button(Messages.OK(), ImVec2(120, 0))) {
-		char input = 0;
+		uint16_t input = 0;
 		input = selected_dir + 1;
 		if (selected_button[0]) {
 			//A is selected
@@ -184,7 +184,7 @@ void PlaybackEditorWindow::DrawEditLinePopup(char* line) {
 			//D is selected
 			input += 0x80;
 		}
-		*line = input;
+		*line = input | (*line & 0xFF00); //keeps the taunt and special bits the popup doesn't edit
 		//selected_dir = { false,false ,false ,false ,false ,false ,false ,false ,false };
 		ImGui::CloseCurrentPopup();
 	}
@@ -199,7 +199,7 @@ void PlaybackEditorWindow::DrawEditLinePopup(char* line) {
 
 
 }
-std::string PlaybackEditorWindow::interpret_move_absolute(char move) {
+std::string PlaybackEditorWindow::interpret_move_absolute(uint16_t move) {
 	auto button_bits = move & 0xf0;
 	auto direction_bits = move & 0x0f;
 	std::string move_t{ "" };
@@ -280,11 +280,17 @@ std::string PlaybackEditorWindow::interpret_move_absolute(char move) {
 		move_t += "+A+B+C+D";
 		break;
 	}
+	if (move & 0x100) {
+		move_t += "+Taunt";
+	}
+	if (move & 0x200) {
+		move_t += "+Special";
+	}
 
 	return move_t;
 }
 
-std::string PlaybackEditorWindow::interpret_move_L_R(char move, int side) {
+std::string PlaybackEditorWindow::interpret_move_L_R(uint16_t move, int side) {
 	auto button_bits = move & 0xf0;
 	auto direction_bits = move & 0x0f;
 	std::string move_t{ "" };
@@ -365,6 +371,12 @@ std::string PlaybackEditorWindow::interpret_move_L_R(char move, int side) {
 		move_t += "+A+B+C+D";
 		break;
 	}
+	if (move & 0x100) {
+		move_t += "+Taunt";
+	}
+	if (move & 0x200) {
+		move_t += "+Special";
+	}
 
 	return move_t;
 }
\ No newline at end of file
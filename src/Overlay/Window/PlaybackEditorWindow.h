@@ -14,16 +14,16 @@ public:
 	}
 
 	~PlaybackEditorWindow() override = default;
-	std::string interpret_move_absolute(char move);
-	std::string interpret_move_L_R(char move, int side);
+	std::string interpret_move_absolute(uint16_t move);
+	std::string interpret_move_L_R(uint16_t move, int side);
 
 	PlaybackManager playback_manager;
 	//std::vector<char>::iterator line_edit_ptr;
-	char* line_edit_ptr=nullptr;
+	uint16_t* line_edit_ptr=nullptr;
 
 protected:
 	void Draw() override;
-	void DrawEditLinePopup(char* line);
+	void DrawEditLinePopup(uint16_t* line);
 	//void DrawEditLinePopup();
 
 private:
@@ -3,36 +3,15 @@
 
 #include "Core/Localization.h"
 #include "Core/interfaces.h"
+#include "Game/EntityTracker.h"
 #include "Game/SnapshotApparatus/SnapshotApparatus.h"
 #include "Game/gamestates.h"
 #include "Overlay/imgui_utils.h"
 
 unsigned int ReplayRewindWindow::count_entities(bool unk_status2) {
     if (!g_interfaces.player1.IsCharDataNullPtr() && !g_interfaces.player2.IsCharDataNullPtr()) {
-        std::vector<int*> entities{};
-        std::vector<CharData**> entities_char_data{};
-        for (int i = 0; i < 252; i++) {
-            entities.push_back((g_gameVals.pEntityList + i));
-            //entities_char_data.push_back((CharData*)(g_gameVals.pEntityList + i));
-        }
-        for (auto entity_ptr : entities) {
-            entities_char_data.push_back((CharData**)entity_ptr);
-        }
-        auto tst = entities_char_data[0];
-        auto r = 0;
-        for (auto entity : entities_char_data) {
-            if ((*entity)->unknownStatus1 != NULL) {
-                if (unk_status2) {
-                    if ((*entity)->unknown_status2 != NULL && (*entity)->unknown_status2 == 2) {
-                        r++;
-                    }
-                }
-                else {
-                    r++;
-                }
-            }
-        }
-        return r;
+        const EntityTracker& tracker = EntityTracker::GetInstance();
+        return unk_status2 ? tracker.CountAnchored() : (unsigned int)tracker.GetLiveCount();
     }
     return 0;
 }
@@ -3,6 +3,8 @@
 #include "Core/interfaces.h"
 #include "Core/Settings.h"
 #include "Core/utils.h"
+#include "Game/EntityTracker.h"
+#include "Game/characters.h"
 #include "Game/gamestates.h"
 #include "Game/ReplayStates/FrameState.h"
 #include "Game/ReplayFiles/ReplayFile.h"
@@ -22,7 +24,9 @@
 #include <array>
 #include "Core/info.h"
 #include <windows.h>
+#include "Game/Playbacks/PlaybackLibrary.h"
 #include "Game/Playbacks/PlaybackManager.h"
+#include "Game/ReplayTakeover/ReplayTakeoverStream.h"
 #include "Overlay/imgui_utils.h"
 #include <cstdlib>
 #include <ctime>
@@ -251,6 +255,102 @@ bool find_substring_in_vector(std::vector<std::string> string_vector, std::strin
     };
     return false;
 }
+void ScrWindow::DrawStateFrameData(const char* char_abbr, const scrState* state)
+{
+    // The database record when there is one, the parsed state otherwise
+    FrameDataDB* db = g_interfaces.pFrameDataDB;
+    const FrameDataRecord* record = db && db->IsOpen() ? db->Find(char_abbr, state->name.c_str()) : nullptr;
+    if (record) {
+        const char* suffix = (record->flags & FrameDataRecordFlags_NonDeterministic) ? "+n" : "";
+        ImGui::Text("Frames: %d", record->frames);
+        ImGui::Text("Startup: %d, active %d, recovery %d%s, invuln %d-%d", record->startup, record->active,
+            record->recovery, suffix, record->invuln_start, record->invuln_end);
+        ImGui::Text("Damage: %d", record->damage);
+        ImGui::Text("Atk_level: %d", record->atk_level);
+        ImGui::Text("Hitstun: %d", record->hitstun);
+        ImGui::Text("Blockstun: %d", record->blockstun);
+        ImGui::Text("Hitstop: %d", record->hitstop);
+        ImGui::Text("Starter_rating: %d", record->starter_rating);
+        ImGui::Text("Atk_P1: %d", record->attack_p1);
+        ImGui::Text("Atk_P2: %d", record->attack_p2);
+        ImGui::Text("Hit_overhead: %d", (record->flags & FrameDataRecordFlags_Overhead) != 0);
+        ImGui::Text("Hit_low: %d", (record->flags & FrameDataRecordFlags_Low) != 0);
+        ImGui::Text("Hit_air_ublockable: %d", (record->flags & FrameDataRecordFlags_AirUnblockable) != 0);
+        ImGui::Text("fatal_counter: %d", (record->flags & FrameDataRecordFlags_FatalCounter) != 0);
+        ImGui::TextDisabled("From the frame data DB");
+        return;
+    }
+    ScrFrameData data = summarize_frame_data(state);
+    const char* suffix = data.non_deterministic ? "+n" : "";
+    ImGui::Text("Frames: %d", state->frames);
+    ImGui::Text("Startup: %d, active %d, recovery %d%s, invuln %d-%d", data.startup, data.active, data.recovery,
+        suffix, data.invuln_start, data.invuln_end);
+    ImGui::Text("Damage: %d", state->damage);
+    ImGui::Text("Atk_level: %d", state->atk_level);
+    ImGui::Text("Hitstun: %d", state->hitstun);
+    ImGui::Text("Blockstun: %d", state->blockstun);
+    ImGui::Text("Hitstop: %d", state->hitstop);
+    ImGui::Text("Starter_rating: %d", state->starter_rating);
+    ImGui::Text("Atk_P1: %d", state->attack_p1);
+    ImGui::Text("Atk_P2: %d", state->attack_p2);
+    ImGui::Text("Hit_overhead: %d", state->hit_overhead);
+    ImGui::Text("Hit_low: %d", state->hit_low);
+    ImGui::Text("Hit_air_ublockable: %d", state->hit_air_unblockable);
+    ImGui::Text("fatal_counter: %d", state->fatal_counter);
+    if (db && db->IsOpen())
+        ImGui::TextDisabled("Frame data DB: no entry, parsed from the script");
+}
+
+void ScrWindow::SaveP2FrameDataDB()
+{
+    FrameDataDB* db = g_interfaces.pFrameDataDB;
+    if (!db || g_interfaces.player2.IsCharDataNullPtr() || g_interfaces.player2.states.empty())
+        return;
+    char abbr[5] = {};
+    memcpy(abbr, g_interfaces.player2.GetData()->char_abbr, 4);
+
+    // The file can't be replaced while it is mapped, so everything that is kept gets copied out first
+    FrameDataDBBuilder builder;
+    for (uint32_t i = 0; i < db->GetCharacterCount(); i++) {
+        const FrameDataDBCharacter* character = db->GetCharacter(i);
+        std::string character_abbr(character->abbr, strnlen(character->abbr, sizeof(character->abbr)));
+        if (character_abbr != abbr)
+            builder.AddCharacter(character_abbr, db->GetRecords(character), character->record_count);
+    }
+    builder.AddCharacter(abbr, g_interfaces.player2.states);
+    db->Close();
+    bool written = builder.Write(FRAME_DATA_DB_PATH);
+    db->Open(FRAME_DATA_DB_PATH);
+    if (written)
+        g_notificationBar->AddNotification("Frame data of %s saved to %s", abbr, FRAME_DATA_DB_PATH);
+    else
+        g_notificationBar->AddNotification("Couldn't write %s", FRAME_DATA_DB_PATH);
+}
+
+void ScrWindow::DrawSimulatedPaths(const scrState* state)
+{
+    if (!ImGui::TreeNode("Simulated paths"))
+        return;
+    ImGui::ShowHelpMarker("The state stepped frame by frame like the game runs it. Each if block splits it in two paths, loops are followed once and show the frame they go back to.");
+    size_t path_count = p2_simulator.Simulate(state->addr);
+    for (size_t i = 0; i < path_count; i++) {
+        const ScrTimeline& timeline = p2_simulator.GetTimeline(i);
+        ScrFrameData data = summarize_frame_data(timeline.frame_activity_status, timeline.frame_invuln_status);
+        const char* suffix = timeline.open_ended ? "+n" : "";
+        ImGui::Text("Path %d: %d frames%s, startup %d, active %d, recovery %d%s", (int)i, data.total, suffix,
+            data.startup, data.active, data.recovery, suffix);
+        if (timeline.loop_start != -1) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("loops from %d", timeline.loop_start + 1);
+        }
+        if (timeline.next_state) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("-> %.32s", timeline.next_state);
+        }
+    }
+    ImGui::TreePop();
+}
+
 void ScrWindow::DrawStatesSection()
 {
     if (*g_gameVals.pGameMode == GameMode_Training) {
@@ -286,6 +386,7 @@ void ScrWindow::DrawStatesSection()
         g_interfaces.player2.SetScrStates(states);
         g_interfaces.player2.states = states;
         p2_old_char_data = (void*)g_interfaces.player2.GetData();
+        p2_simulator.SetJonbIndex(&JonbIndex::Get(bbcf_base_adress, 2));
         for (auto& state : states) {
             if (state->name == "CmnActBurstBegin") {
                 burst_action = state;
@@ -307,10 +408,17 @@ void ScrWindow::DrawStatesSection()
         std::vector<scrState*> states = parse_scr(bbcf_base_adress, 2);
         g_interfaces.player2.SetScrStates(states);
         g_interfaces.player2.states = states;
+        p2_simulator.SetJonbIndex(&JonbIndex::Get(bbcf_base_adress, 2));
         gap_register = {};
         wakeup_register = {};
         selected = 0;
     }
+    ImGui::SameLine();
+    if (ImGui::Button("Save P2 to frame data DB")) {
+        ScrWindow::SaveP2FrameDataDB();
+    }
+    ImGui::SameLine();
+    ImGui::ShowHelpMarker("Adds the frame data of the loaded P2 script to BBCF_IM/framedata.bin, replacing the character if it was saved before. The other characters in the file are kept.\n\nThe database is read without parsing any scripts, it can also be generated for every character at once with tools/scr_dump.");
     auto states = g_interfaces.player2.states;
     {
         ImGui::BeginChild("left pane", ImVec2(200, 0), true);
@@ -347,19 +455,7 @@ void ScrWindow::DrawStatesSection()
             ImGui::Text("%s", selected_state->name.c_str());
             ImGui::Separator();
             ImGui::Text("Addr: 0x%x", selected_state->addr);
-            ImGui::Text("Frames: %d", selected_state->frames);
-            ImGui::Text("Damage: %d", selected_state->damage);
-            ImGui::Text("Atk_level: %d", selected_state->atk_level);
-            ImGui::Text("Hitstun: %d", selected_state->hitstun);
-            ImGui::Text("Blockstun: %d", selected_state->blockstun);
-            ImGui::Text("Hitstop: %d", selected_state->hitstop);
-            ImGui::Text("Starter_rating: %d", selected_state->starter_rating);
-            ImGui::Text("Atk_P1: %d", selected_state->attack_p1);
-            ImGui::Text("Atk_P2: %d", selected_state->attack_p2);
-            ImGui::Text("Hit_overhead: %d", selected_state->hit_overhead);
-            ImGui::Text("Hit_low: %d", selected_state->hit_low);
-            ImGui::Text("Hit_air_ublockable: %d", selected_state->hit_air_unblockable);
-            ImGui::Text("fatal_counter: %d", selected_state->fatal_counter);
+            DrawStateFrameData(g_interfaces.player2.GetData()->char_abbr, selected_state);
             if (ImGui::TreeNode("Frame Breakdown")) {
                 ImGui::ShowHelpMarker("Red numbers are active frames, blue numbers are startup/recovery, black numbers are inactive. \n\nWhite borders are full invul/GP, green borders are partial invul/GP(hover for details). Projectile invul not yet being displayed.\n\n\"Non-deterministic\" frame length means that it is not fixed, landing recovery for example. After a non-deterministic state all values will be +\"n\", representing that would be n frames after the frames in question. They are not wrong, they just can't be statically computed.  \n\nSome are still incorrect, however they should be for the most part pretty obvious, around ~85% are done so far.");
                 auto iter_scr_frames = 1;
@@ -471,6 +567,7 @@ void ScrWindow::DrawStatesSection()
                 }
                 ImGui::TreePop();
             }
+            DrawSimulatedPaths(selected_state);
             ImGui::Text("%s", " ");
             ImGui::Text("%s", " ");
             ImGui::Text("Whiff_cancels:", selected_state->fatal_counter);
@@ -987,9 +1084,10 @@ void ScrWindow::draw_playback_slot_section(int slot) {
 
 
 
-    std::vector<char> slot_recording_frames = selected_slot.get_slot_buffer();
+    std::vector<uint16_t> slot_recording_frames = selected_slot.get_slot_buffer();
     if (ImGui::Button("Save")) {
-        playback_manager.save_to_file(slot_recording_frames, facing_direction, fpath);
+        int char_index = g_interfaces.player2.IsCharDataNullPtr() ? -1 : g_interfaces.player2.GetData()->charIndex;
+        playback_manager.save_to_file(slot_recording_frames, facing_direction, fpath, char_index);
     }
     ImGui::SameLine();
     if (ImGui::Button("Load")) {
@@ -1046,6 +1144,63 @@ void ScrWindow::draw_playback_slot_section(int slot) {
     }
     ImGui::PopID();
 };
+void ScrWindow::rotate_library_playback(int slot) {
+    int char_index = -1;
+    if (library_current_char_only && !g_interfaces.player2.IsCharDataNullPtr()) {
+        char_index = g_interfaces.player2.GetData()->charIndex;
+    }
+    std::string name = PlaybackLibrary::GetInstance().load_random_into_slot(slot, char_index, library_tag_filter);
+    if (!name.empty()) {
+        library_last_rotated = name;
+    }
+}
+void ScrWindow::draw_playback_library_section() {
+    PlaybackLibrary& library = PlaybackLibrary::GetInstance();
+    std::shared_ptr<const PlaybackLibraryEntries> entries = library.get_entries();
+
+    ImGui::Text("%d playbacks in ./slots%s", (int)entries->size(), library.is_loading() ? " (loading...)" : "");
+    ImGui::SameLine();
+    if (ImGui::Button("Reload##playback_library")) {
+        library.start_loading();
+    }
+    ImGui::InputText("Tag##playback_library", library_tag_filter, IM_ARRAYSIZE(library_tag_filter));
+    ImGui::SameLine();
+    ImGui::ShowHelpMarker("Tags are the words of the file name split on '_', '-' and spaces, so \"ragna_wakeup_dp.playback\" has the tags ragna, wakeup and dp.");
+    ImGui::Checkbox("Current P2 character only##playback_library", &library_current_char_only);
+    const char* slots[] = { "1", "2", "3", "4" };
+    ImGui::Combo("Slot##playback_library", &library_target_slot, slots, IM_ARRAYSIZE(slots));
+    ImGui::Checkbox("Rotate into the gap slot##playback_library", &library_rotate_gap);
+    ImGui::SameLine();
+    ImGui::Checkbox("Rotate into the wakeup slot##playback_library", &library_rotate_wakeup);
+    ImGui::SameLine();
+    ImGui::ShowHelpMarker("Every time the gap or wakeup action triggers, a random playback matching the tag and character replaces the slot it's about to play.");
+    if (!library_last_rotated.empty()) {
+        ImGui::Text("Last rotated in: %s", library_last_rotated.c_str());
+    }
+
+    int char_index = -1;
+    if (library_current_char_only && !g_interfaces.player2.IsCharDataNullPtr()) {
+        char_index = g_interfaces.player2.GetData()->charIndex;
+    }
+    const std::string tag = library_tag_filter;
+    ImGui::BeginChild("playback_library_list", ImVec2(0, 200), true);
+    for (size_t i = 0; i < entries->size(); i++) {
+        const PlaybackLibraryEntry& entry = (*entries)[i];
+        if (!PlaybackLibrary::matches(entry, char_index, tag)) {
+            continue;
+        }
+        ImGui::PushID((int)i);
+        if (ImGui::SmallButton("Load")) {
+            library.load_into_slot(entry, library_target_slot + 1);
+        }
+        ImGui::SameLine();
+        const int16_t entry_char = entry.playback.char_index;
+        const char* char_name = entry_char < 0 || entry_char >= getCharactersCount() ? "?" : getCharacterNameByIndexA(entry_char).c_str();
+        ImGui::Text("%s  [%s, %d frames]", entry.name.c_str(), char_name, (int)entry.playback.frames.size());
+        ImGui::PopID();
+    }
+    ImGui::EndChild();
+}
 void ScrWindow::DrawPlaybackEditor() {
     if (ImGui::Button("Open Playback Editor")) {
         ScrWindow::m_pWindowContainer->GetWindow(WindowType_PlaybackEditor)->ToggleOpen();
@@ -1077,6 +1232,10 @@ void ScrWindow::DrawPlaybackSection() {
         if (ImGui::CollapsingHeader("SLOT_4")) {
             draw_playback_slot_section(4);
         }
+
+        if (ImGui::CollapsingHeader("Playback library")) {
+            draw_playback_library_section();
+        }
         
 
         //setup for randomized slots
@@ -1160,6 +1319,9 @@ void ScrWindow::DrawPlaybackSection() {
                 int rand = std::rand();
                 int random_pos = rand % random_gap.size();
                 slot = random_gap[random_pos] - 1;
+                if (library_rotate_gap) {
+                    rotate_library_playback(slot + 1);
+                }
                 memcpy(active_slot, &slot, 4);
                 memcpy(playback_control_ptr, &val_set, 2);
 
@@ -1170,6 +1332,9 @@ void ScrWindow::DrawPlaybackSection() {
                     gap_action_trigger_find != std::string::npos) {
                 //does pre-defined
                 slot = slot_gap - 1;
+                if (library_rotate_gap) {
+                    rotate_library_playback(slot_gap);
+                }
                 memcpy(active_slot, &slot, 4);
                 memcpy(playback_control_ptr, &val_set, 2);
             }
@@ -1280,6 +1445,9 @@ void ScrWindow::DrawPlaybackSection() {
                           
                                 slot = slot_to_run + 1; //slot_to_run has the value already adjusted for 0 start, need to add 1 so that it becomes 1,2,3,4 as set_active_slot expects.
                                 if (*playback_control_ptr != 3) {
+                                    if (library_rotate_wakeup) {
+                                        rotate_library_playback(slot);
+                                    }
                                     PlaybackManager().set_active_slot(slot);
                                     PlaybackManager().set_playback_control(val_set);
                                     //memcpy(active_slot, &slot, 4);
@@ -1303,6 +1471,9 @@ void ScrWindow::DrawPlaybackSection() {
 
               
                     if (*playback_control_ptr != 3) {
+                        if (library_rotate_wakeup) {
+                            rotate_library_playback(slot);
+                        }
                         PlaybackManager().set_active_slot(slot);
                         PlaybackManager().set_playback_control(val_set);
                         //memcpy(active_slot, &slot, 4);
@@ -1790,34 +1961,11 @@ void ScrWindow::DrawReplayTheaterSection() {
 
 }
 
-
+// Same as ReplayRewind::count_entities, the tracker's count as of the last capture, for display only
 unsigned int count_entities(bool unk_status2) {
     if (!g_interfaces.player1.IsCharDataNullPtr() && !g_interfaces.player2.IsCharDataNullPtr()) {
-        std::vector<int*> entities{};
-        std::vector<CharData**> entities_char_data{};
-        for (int i = 0; i < 252; i++) {
-            entities.push_back((g_gameVals.pEntityList + i));
-            //entities_char_data.push_back((CharData*)(g_gameVals.pEntityList + i));
-        }
-        for (auto entity_ptr : entities) {
-            entities_char_data.push_back((CharData**)entity_ptr);
-        }
-        auto tst = entities_char_data[0];
-        auto r = 0;
-        for (auto entity : entities_char_data) {
-            if ((*entity)->unknownStatus1 != NULL) {
-                if (unk_status2) {
-                    if ((*entity)->unknown_status2 != NULL && (*entity)->unknown_status2 == 2) {
-                        r++;
-                    }
-                }
-                else {
-                    r++;
-                }
-            }
-        }
-        return r;
-        //auto tst = &entities_char_data[0]->frame_count_minus_1;
+        const EntityTracker& tracker = EntityTracker::GetInstance();
+        return unk_status2 ? tracker.CountAnchored() : (unsigned int)tracker.GetLiveCount();
     }
     return 0;
 }
@@ -1829,17 +1977,9 @@ void ScrWindow::DrawReplayTakeover() {
     
 
     char* bbcf_base = GetBbcfBaseAdress();
-    static std::vector<char> replay_action_load{};
+    ReplayTakeoverStream& takeover_stream = ReplayTakeoverStream::GetInstance();
     static SnapshotApparatus* snap_apparatus_takeover = nullptr;
-    static int facing_left_replay_takeover = 0;
     char current_round = *(bbcf_base + 0x11C034C);
-    //these are merely demonstrative, the formula to get the start of a players inputs in a round is: bbcf_base + 0x115B470 + 0x8d4 + (0x7080 * player_to_playback) + (0xE100 * current_round);
-    char* r1p1_start = bbcf_base + 0x115B470 + 0x8d4;
-    char* r1p2_start = bbcf_base + 0x115B470 + 0x8d4 + 0x7080;
-    char* r2p1_start = bbcf_base + 0x115B470 + 0x8d4 + 0x7080 + 0x7080;
-    char* r2p2_start = bbcf_base + 0x115B470 + 0x8d4 + 0x7080 + 0x7080 + 0x7080;
-    char* r3p1_start = bbcf_base + 0x115B470 + 0x8d4 + 0x7080 + 0x7080 + 0x7080 + 0x7080;
-    char* r3p2_start = bbcf_base + 0x115B470 + 0x8d4 + 0x7080 + 0x7080 + 0x7080 + 0x7080 + 0x7080;
     static float wait_before_exec_s2 = 0; //for the little load delay bar
 
     if (!ImGui::CollapsingHeader("Replay Takeover"))
@@ -1868,16 +2008,7 @@ void ScrWindow::DrawReplayTakeover() {
                     snap_apparatus_takeover->save_snapshot(0);
 
                     int player_to_playback = 1;
-                    char* rpstart = r1p1_start + (0x7080 * player_to_playback) + (0xE100 * current_round);
-                    replay_action_load = {};
-
-
-
-                    for (int i = 0; i < 0x400; i++) {
-                        char* recorded_input = rpstart + (*g_gameVals.pFrameCount + i) * 2;
-                        replay_action_load.push_back(*recorded_input);
-                    }
-                    facing_left_replay_takeover = g_interfaces.player2.GetData()->facingLeft2;
+                    takeover_stream.Capture(player_to_playback, current_round, *g_gameVals.pFrameCount);
                     *(bbcf_base + 0x891A38) = 0; // sets training mode to be "p1" sided
                     *(bbcf_base + 0x8929A8) = 1; //p1 control related
                     *(bbcf_base + 0x8929A4) = 0; //p1 control related
@@ -1892,17 +2023,7 @@ void ScrWindow::DrawReplayTakeover() {
 
 
                     int player_to_playback = 0;
-                    char* rpstart = r1p1_start + (0x7080 * player_to_playback) + (0xE100 * current_round);
-                    replay_action_load = {};
-
-
-                    for (int i = 0; i < 0x400; i++) {
-
-                        char* recorded_input = rpstart + (*g_gameVals.pFrameCount + i) * 2;
-                        replay_action_load.push_back(*recorded_input);
-                    }
-                    auto len_replay = replay_action_load.size();
-                    facing_left_replay_takeover = g_interfaces.player1.GetData()->facingLeft2;
+                    takeover_stream.Capture(player_to_playback, current_round, *g_gameVals.pFrameCount);
                     //bypasses necessary to make p2 control 
                     *(bbcf_base + 0x891A38) = 1; // sets training mode to be "p2" sided
                     *(bbcf_base + 0x8929A8) = 0; //p2 control related
@@ -1919,11 +2040,9 @@ void ScrWindow::DrawReplayTakeover() {
 
                     //snap_apparatus_takeover->load_snapshot(snap_apparatus_takeover->p_snapshot_reseve);
 
-                    playback_manager.load_into_slot(replay_action_load, facing_left_replay_takeover, 1);
-                    playback_manager.set_active_slot(1);
-                    playback_manager.set_playback_type(0); //forces playback type to be "normal" instead of "random"
-                    playback_manager.set_playback_position(0); //makes sure the playback is in frame zero
-                    playback_manager.set_playback_control(3); //activates the playback
+                    //the dummy is put on controller so its inputs go through the battle input hook, the stream replaces them from the next frame on
+                    playback_manager.set_playback_control(4);
+                    takeover_stream.Start();
                     if (wait_before_exec_s2 > 0) {
                         g_gameVals.isFrameFrozen = true;
 
@@ -1961,17 +2080,14 @@ void ScrWindow::DrawReplayTakeover() {
         }
         if (*g_gameVals.pGameMode == GameMode_Training) {
             if (ImGui::Button("Return to replay")) {
+                takeover_stream.Stop();
                 playback_manager.set_playback_control(0); //makes sure the playback is stopped before going back to the replay
                 *g_gameVals.pGameMode = GameMode_ReplayTheater;
                 snap_apparatus_takeover->load_snapshot(0);
             }
 
-            if (ImGui::Button("FIX PLAYBACK")) {
-                facing_left_replay_takeover = !facing_left_replay_takeover;
-            }
-            ImGui::SameLine();
-            ImGui::ShowHelpMarker("Use this if the takeover appears to be faulty before reporting an issue, it should correct it most of the time. \n\nIf you use it when it is already working it will make it appear faulty, clicking again should return it to the previous state.");
-            
+            ImGui::Text("Replay inputs: %u / %u frames%s", takeover_stream.GetPosition(), takeover_stream.GetLength(),
+                takeover_stream.IsActive() ? "" : " (stopped)");
         }
 
         if (*g_gameVals.pGameMode == GameMode_Training) {
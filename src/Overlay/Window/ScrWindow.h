@@ -3,6 +3,7 @@
 #include <vector>
 #include <chrono>
 #include "Game/Scr/ScrStateReader.h"
+#include "Game/Scr/ScrTimeline.h"
 #include "Game/Playbacks/PlaybackManager.h"
 #include "Core/utils.h"
 #include "Overlay/WindowContainer/WindowContainer.h"
@@ -25,6 +26,8 @@ private:
 	void DrawGenericOptionsSection();
 	void DrawStatesSection();
 	void draw_playback_slot_section(int slot);
+	void draw_playback_library_section();
+	void rotate_library_playback(int slot); /*puts a random library playback matching the filter into the slot*/
 	void DrawPlaybackSection();
 	void DrawReplayTheaterSection();
 	void DrawReplayRewind();
@@ -36,9 +39,13 @@ private:
 	void DrawInputBufferButton();
 	void DrawPlaybackEditor();
 	void DrawComboDataButton();
+	void DrawStateFrameData(const char* char_abbr, const scrState* state);
+	void SaveP2FrameDataDB();
+	void DrawSimulatedPaths(const scrState* state);
 	PlaybackManager playback_manager;
 	bool m_showDemoWindow = false;
 	void* p2_old_char_data = NULL;
+	ScrTimelineSimulator p2_simulator{ nullptr };
 	std::vector<scrState*> gap_register{};
 	std::vector<int> gap_register_delays{};
 	std::vector<scrState*> wakeup_register{};
@@ -87,6 +94,13 @@ private:
 	std::vector<int> random_gap{}; //holds the slots to be random for gap
 	std::vector<int> random_wakeup{}; //holds the slots to be random for wakeup
 
+	char library_tag_filter[64] = "";
+	bool library_current_char_only = true;
+	bool library_rotate_gap = false; //swaps a library playback into the slot every time the gap action triggers
+	bool library_rotate_wakeup = false; //same for the wakeup action
+	int library_target_slot = 0;
+	std::string library_last_rotated;
+
 	std::string prev_action;
 
 
@@ -6,6 +6,7 @@
 #include "Window/LogWindow.h"
 #include "Window/WinePopupWindow.h"
 
+#include "Core/ControllerOverrideManager.h"
 #include "Core/info.h"
 #include "Core/interfaces.h"
 #include "Core/Localization.h"
@@ -13,6 +14,10 @@
 #include "Core/Settings.h"
 #include "Core/WineCheck.h"
 #include "Core/utils.h"
+#include "Game/FrameSnapshot.h"
+#include "Game/GameEventBus.h"
+#include "Game/Playbacks/PlaybackLibrary.h"
+#include "Game/Trace/TraceRecorder.h"
 #include "Web/update_check.h"
 
 #include <imgui.h>
@@ -157,6 +162,7 @@ bool WindowManager::Initialize(void* hwnd, IDirect3DDevice9* device)
 	srand(time(NULL));
 
 	StartAsyncUpdateCheck();
+	PlaybackLibrary::GetInstance().start_loading();
 	//StartAsyncReplayUpload();
 
 	if (g_modVals.uploadReplayData == -1)
@@ -203,6 +209,10 @@ void WindowManager::Shutdown()
 
 	LOG(2, "WindowManager::Shutdown\n");
 
+	TraceRecorder::GetInstance().Stop(false);
+	// Under the loader lock, the workers were joined on WM_DESTROY unless the game went away without closing its window
+	PlaybackLibrary::GetInstance().stop_loading(false);
+
 	SAFE_DELETE(m_windowContainer);
 	delete m_instance;
 
@@ -274,6 +284,13 @@ void WindowManager::Render()
 		ImGui::GetIO().DisplaySize = ImVec2(1280, 768);
 	}
 
+	m_frameArena.Reset();
+	// Device changes enumerated in the background are applied between frames
+	ControllerOverrideManager::GetInstance().TickAutoRefresh();
+	FrameSnapshotCache::GetInstance().Capture();
+	// In battle the input hook already published this frame's events, this only finds the ones outside of it
+	GameEventBus::GetInstance().Update(FrameSnapshotCache::GetInstance().Get());
+	TraceRecorder::GetInstance().Update();
 	DrawAllWindows();
 
 	g_notificationBar->DrawNotifications();
@@ -1,4 +1,5 @@
 #pragma once
+#include "Core/FrameArena.h"
 #include "Logger/Logger.h"
 #include "WindowContainer/WindowContainer.h"
 
@@ -15,6 +16,8 @@ public:
 	void InvalidateDeviceObjects();
 	void CreateDeviceObjects();
 	bool IsInitialized() const { return m_initialized; }
+	// Scratch memory for the windows, reset at the start of every Render
+	FrameArena& GetFrameArena() { return m_frameArena; }
 
 private:
 	WindowManager() = default;
@@ -25,4 +28,5 @@ private:
 	bool m_initialized = false;
 	WindowContainer* m_windowContainer = nullptr;
 	Logger* m_pLogger = nullptr;
+	FrameArena m_frameArena{ 256 * 1024 };
 };
@@ -0,0 +1,219 @@
+/*
+input_sequencer_test: runs input programs of the InputSequencer against a simulated battle input hook and checks the
+packed input written on every frame.
+
+Build (Linux):
+	g++ -std=c++14 -O2 -I../../src input_sequencer_test.cpp ../../src/Game/InputSequencer/InputProgram.cpp -o input_sequencer_test
+
+Prints the failed checks and the per-frame cost of a looping program, exits with the number of failures.
+*/
+#include "Game/InputSequencer/InputProgram.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+	int failures = 0;
+
+#define CHECK(expr) do { if (!(expr)) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #expr); failures++; } } while (0)
+
+	// The hook calls Advance once per game frame and writes the packed value while it returns true, 0 stands for the
+	// frames where the program doesn't write anything
+	std::vector<uint16_t> run(const InputProgram& program, int frames,
+		const std::vector<InputSequencerContext>& contexts = std::vector<InputSequencerContext>(), uint32_t seed = 1)
+	{
+		InputProgramRunner runner;
+		runner.Start(&program, seed);
+		std::vector<uint16_t> written;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			InputSequencerContext context;
+			if (frame < (int)contexts.size())
+			{
+				context = contexts[frame];
+			}
+			uint16_t packed = 0;
+			if (!runner.Advance(context, packed))
+			{
+				packed = 0;
+			}
+			written.push_back(packed);
+		}
+		return written;
+	}
+
+	bool build(InputProgramBuilder& builder, InputProgram& program)
+	{
+		std::string error;
+		if (!builder.Build(program, error))
+		{
+			printf("build failed: %s\n", error.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	bool rejects(InputProgramBuilder& builder)
+	{
+		InputProgram program;
+		std::string error;
+		if (builder.Build(program, error))
+		{
+			return false;
+		}
+		printf("rejected: %s\n", error.c_str());
+		return true;
+	}
+
+	void test_hold()
+	{
+		InputProgramBuilder builder;
+		builder.Hold(2, 3).Hold(21, 1);
+		InputProgram program;
+		CHECK(build(builder, program));
+		CHECK(run(program, 6) == std::vector<uint16_t>({ 2, 2, 2, 21, 0, 0 }));
+	}
+
+	void test_loops()
+	{
+		InputProgramBuilder builder;
+		const int again = builder.Bind(builder.NewLabel());
+		builder.Hold(21, 1).Hold(5, 2).Loop(again, 3);
+		InputProgram program;
+		CHECK(build(builder, program));
+		CHECK(run(program, 10) == std::vector<uint16_t>({ 21, 5, 5, 21, 5, 5, 21, 5, 5, 0 }));
+
+		InputProgramBuilder nested;
+		const int outer = nested.Bind(nested.NewLabel());
+		const int inner = nested.Bind(nested.NewLabel());
+		nested.Hold(1, 1).Loop(inner, 2).Hold(9, 1).Loop(outer, 2);
+		CHECK(build(nested, program));
+		CHECK(run(program, 7) == std::vector<uint16_t>({ 1, 1, 9, 1, 1, 9, 0 }));
+
+		// 0 loops forever
+		InputProgramBuilder forever;
+		const int top = forever.Bind(forever.NewLabel());
+		forever.Hold(5, 1).Loop(top, 0);
+		CHECK(build(forever, program));
+		for (uint16_t packed : run(program, 1000))
+		{
+			CHECK(packed == 5);
+		}
+	}
+
+	void test_wait()
+	{
+		// The wait holds its input until the condition is met, the next instruction runs on that same frame
+		InputProgramBuilder builder;
+		builder.WaitFor(InputCondition_OpponentBlockstun, 5).Hold(21, 1);
+		InputProgram program;
+		CHECK(build(builder, program));
+		std::vector<InputSequencerContext> contexts(8);
+		for (int frame = 4; frame < 8; frame++)
+		{
+			contexts[frame].opponentBlockstun = 10;
+		}
+		CHECK(run(program, 6, contexts) == std::vector<uint16_t>({ 5, 5, 5, 5, 21, 0 }));
+
+		// Gives up after the timeout
+		InputProgramBuilder timeout;
+		timeout.WaitFor(InputCondition_AdvantageAtLeast, 5, 3, 2).Hold(6, 1);
+		CHECK(build(timeout, program));
+		CHECK(run(program, 5) == std::vector<uint16_t>({ 5, 5, 5, 6, 0 }));
+
+		std::vector<InputSequencerContext> plus(5);
+		plus[0].frameAdvantage = 2;
+		CHECK(run(program, 3, plus) == std::vector<uint16_t>({ 6, 0, 0 }));
+	}
+
+	void test_branch()
+	{
+		InputProgramBuilder builder;
+		const int top = builder.Bind(builder.NewLabel());
+		const int other = builder.NewLabel();
+		builder.Branch(other, 30).Hold(1, 1).Jump(top);
+		builder.Bind(other);
+		builder.Hold(2, 1).Jump(top);
+		InputProgram program;
+		CHECK(build(builder, program));
+
+		const int frames = 100000;
+		const std::vector<uint16_t> written = run(program, frames, std::vector<InputSequencerContext>(), 1234);
+		int taken = 0;
+		for (uint16_t packed : written)
+		{
+			CHECK(packed == 1 || packed == 2);
+			taken += packed == 2;
+		}
+		printf("branch 30%%: taken %.3f\n", taken / (double)frames);
+		CHECK(taken > frames * 28 / 100 && taken < frames * 32 / 100);
+
+		// Same seed, same inputs
+		const std::vector<uint16_t> again = run(program, 100, std::vector<InputSequencerContext>(), 1234);
+		CHECK(std::vector<uint16_t>(written.begin(), written.begin() + 100) == again);
+
+		// A label bound after the last instruction ends the program
+		InputProgramBuilder end;
+		const int last = end.NewLabel();
+		end.Branch(last, 100).Hold(7, 5);
+		end.Bind(last);
+		CHECK(build(end, program));
+		CHECK(run(program, 2)[0] == 0);
+	}
+
+	void test_rejects()
+	{
+		InputProgramBuilder noHold;
+		const int top = noHold.Bind(noHold.NewLabel());
+		noHold.WaitFor(InputCondition_OpponentFree, 5).Jump(top);
+		CHECK(rejects(noHold));
+
+		InputProgramBuilder unbound;
+		unbound.Jump(unbound.NewLabel());
+		CHECK(rejects(unbound));
+
+		InputProgramBuilder empty;
+		empty.Hold(5, 0);
+		CHECK(rejects(empty));
+	}
+
+	void bench()
+	{
+		InputProgramBuilder builder;
+		const int top = builder.Bind(builder.NewLabel());
+		builder.Hold(21, 1).Hold(5, 2).Loop(top, 0);
+		InputProgram program;
+		CHECK(build(builder, program));
+
+		InputProgramRunner runner;
+		runner.Start(&program, 1);
+		InputSequencerContext context;
+		const int frames = 10000000;
+		unsigned sum = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < frames; i++)
+		{
+			uint16_t packed = 0;
+			runner.Advance(context, packed);
+			sum += packed;
+		}
+		const auto end = std::chrono::steady_clock::now();
+		printf("%.2f ns per frame (%u), longest chain %d\n",
+			std::chrono::duration<double, std::nano>(end - start).count() / frames, sum, program.maxChain);
+	}
+}
+
+int main()
+{
+	test_hold();
+	test_loops();
+	test_wait();
+	test_branch();
+	test_rejects();
+	bench();
+	printf("%d failures\n", failures);
+	return failures;
+}
@@ -0,0 +1,198 @@
+/*
+keyboard_bench: checks the compiled keyboard binding tables of the ControllerOverrideManager against
+walking the KeyboardMapping the way the P2 keyboard override used to, then times both.
+
+Build (Linux):
+	g++ -std=c++14 -O2 -I../../src keyboard_bench.cpp ../../src/Core/KeyboardBindings.cpp -o keyboard_bench
+
+Usage:
+	keyboard_bench [mappings]
+
+Compares the two on that many random mappings and key states (20000 by default), exits with 1 on the
+first one that differs. The timings are for one keyboard with the default-like bindings and 3 keys held.
+*/
+#include "Core/KeyboardBindings.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const int MENU_ACTION_COUNT = static_cast<int>(MenuAction::ReplayControls2) + 1;
+	const int BATTLE_ACTION_COUNT = static_cast<int>(BattleAction::MacroResetPositions) + 1;
+
+	struct KeyState
+	{
+		bool pressed[256] = {};
+		uint32_t bits[8] = {};
+
+		void press(uint32_t vk)
+		{
+			pressed[vk] = true;
+			bits[vk >> 5] |= 1u << (vk & 31);
+		}
+	};
+
+	void merge_actions(const std::vector<InputAction>& actions, uint16_t& mask)
+	{
+		mask |= InputActionsToMask(actions);
+	}
+
+	bool any_pressed(const KeyState& keys, const std::vector<uint32_t>& bindings)
+	{
+		for (uint32_t vk : bindings)
+		{
+			if (vk < 256 && keys.pressed[vk])
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// What the override did before the tables: every action, every binding, every frame
+	void walk_mapping(const KeyState& keys, const KeyboardMapping& mapping, InputState& battle, InputState& menu)
+	{
+		uint16_t battleActions = 0;
+		for (const auto& kvp : mapping.battleBindings)
+		{
+			if (any_pressed(keys, kvp.second))
+			{
+				merge_actions(BattleActionToInputActions(kvp.first), battleActions);
+			}
+		}
+
+		uint16_t menuActions = 0;
+		for (const auto& kvp : mapping.menuBindings)
+		{
+			if (any_pressed(keys, kvp.second))
+			{
+				merge_actions(MenuActionToInputActions(kvp.first), menuActions);
+			}
+		}
+
+		battle = ActionMaskToState(battleActions);
+		menu = ActionMaskToState(menuActions);
+	}
+
+	void resolve_tables(const KeyState& keys, const KeyboardBindingTable& table, InputState& battle, InputState& menu)
+	{
+		uint16_t battleActions = 0;
+		uint16_t menuActions = 0;
+		ResolveKeyBindings(keys.bits, table, battleActions, menuActions);
+		battle = ActionMaskToState(battleActions);
+		menu = ActionMaskToState(menuActions);
+	}
+
+	bool same_state(const InputState& a, const InputState& b)
+	{
+		return a.up == b.up && a.down == b.down && a.left == b.left && a.right == b.right
+			&& a.A == b.A && a.B == b.B && a.C == b.C && a.D == b.D
+			&& a.taunt == b.taunt && a.special == b.special && a.fn1 == b.fn1 && a.fn2 == b.fn2
+			&& a.start == b.start && a.select == b.select && a.resetPositions == b.resetPositions;
+	}
+
+	KeyboardMapping random_mapping(std::mt19937& rng)
+	{
+		// Up to 300 so the keys the tables drop (256 and above) are covered too
+		std::uniform_int_distribution<uint32_t> key(0, 299);
+		KeyboardMapping mapping;
+		for (int action = 0; action < BATTLE_ACTION_COUNT; action++)
+		{
+			std::vector<uint32_t>& bindings = mapping.battleBindings[static_cast<BattleAction>(action)];
+			for (int i = rng() % 3; i > 0; i--)
+			{
+				bindings.push_back(key(rng));
+			}
+		}
+		for (int action = 0; action < MENU_ACTION_COUNT; action++)
+		{
+			std::vector<uint32_t>& bindings = mapping.menuBindings[static_cast<MenuAction>(action)];
+			for (int i = rng() % 3; i > 0; i--)
+			{
+				bindings.push_back(key(rng));
+			}
+		}
+		return mapping;
+	}
+
+	template <typename Fn>
+	double ns_per_call(int iterations, Fn fn)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			fn(i);
+		}
+		const auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int mappings = argc > 1 ? atoi(argv[1]) : 20000;
+
+	std::mt19937 rng(7);
+	for (int i = 0; i < mappings; i++)
+	{
+		const KeyboardMapping mapping = random_mapping(rng);
+		KeyboardBindingTable table;
+		CompileKeyboardMapping(mapping, table);
+
+		KeyState keys;
+		for (int pressed = rng() % 8; pressed > 0; pressed--)
+		{
+			keys.press(rng() % 256);
+		}
+
+		InputState walkedBattle, walkedMenu, tableBattle, tableMenu;
+		walk_mapping(keys, mapping, walkedBattle, walkedMenu);
+		resolve_tables(keys, table, tableBattle, tableMenu);
+		if (!same_state(walkedBattle, tableBattle) || !same_state(walkedMenu, tableMenu))
+		{
+			printf("mapping %d: the tables and the mapping disagree\n", i);
+			return 1;
+		}
+	}
+	printf("%d mappings, tables match the mapping walk\n", mappings);
+
+	// One key per action, 'A' onwards, like the default WASD/UIOJ layout
+	KeyboardMapping mapping;
+	uint32_t vk = 'A';
+	for (int action = 0; action < BATTLE_ACTION_COUNT; action++)
+	{
+		mapping.battleBindings[static_cast<BattleAction>(action)].push_back(vk++);
+	}
+	for (int action = 0; action < MENU_ACTION_COUNT; action++)
+	{
+		mapping.menuBindings[static_cast<MenuAction>(action)].push_back(vk++);
+	}
+	KeyboardBindingTable table;
+	CompileKeyboardMapping(mapping, table);
+
+	KeyState keys[2];
+	keys[0].press('A');
+	keys[0].press('D');
+	keys[0].press('H');
+	keys[1] = keys[0];
+	keys[1].press('K');
+
+	const int iterations = 2000000;
+	volatile int sink = 0;
+	const double walked = ns_per_call(iterations / 10, [&](int i) {
+		InputState battle, menu;
+		walk_mapping(keys[i & 1], mapping, battle, menu);
+		sink += battle.A + menu.up;
+	});
+	const double tables = ns_per_call(iterations, [&](int i) {
+		InputState battle, menu;
+		resolve_tables(keys[i & 1], table, battle, menu);
+		sink += battle.A + menu.up;
+	});
+	printf("mapping walk %.1f ns, tables %.1f ns per keyboard\n", walked, tables);
+	return 0;
+}
@@ -0,0 +1,165 @@
+/*
+motion_test: feeds input streams to the MotionRecognizer and checks the motions it reports and on which frame.
+
+Build (Linux):
+	g++ -std=c++14 -O2 -I../../src motion_test.cpp ../../src/Game/MotionInput/MotionRecognizer.cpp -o motion_test
+
+Prints the failed streams and the cost of a step, exits with the number of failures.
+*/
+#include "Game/MotionInput/MotionRecognizer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	int failures = 0;
+
+	struct Frame
+	{
+		uint16_t packed;
+		bool facingLeft;
+	};
+
+	// "frame:motion/duration " for every motion recognized, in frame order
+	std::string recognize(const std::vector<Frame>& frames)
+	{
+		MotionRecognizer recognizer;
+		std::string res;
+		for (size_t frame = 0; frame < frames.size(); frame++)
+		{
+			const uint32_t motions = recognizer.Step(frames[frame].packed, frames[frame].facingLeft);
+			for (int i = 0; i < Motion_Count; i++)
+			{
+				if (motions & (1u << i))
+				{
+					res += std::to_string(frame) + ":" + MotionRecognizer::GetName((Motion)i) + "/" +
+						std::to_string(recognizer.GetDuration((Motion)i)) + " ";
+				}
+			}
+		}
+		return res;
+	}
+
+	// One numpad direction per character, one frame each
+	std::vector<Frame> directions(const char* stream, bool facingLeft = false)
+	{
+		std::vector<Frame> frames;
+		for (const char* c = stream; *c; c++)
+		{
+			frames.push_back({ (uint16_t)(*c - '0'), facingLeft });
+		}
+		return frames;
+	}
+
+	void expect(const std::vector<Frame>& frames, const char* expected, const char* name)
+	{
+		const std::string res = recognize(frames);
+		if (res != expected)
+		{
+			printf("FAIL %s -> '%s', expected '%s'\n", name, res.c_str(), expected);
+			failures++;
+		}
+	}
+
+	void expect(const char* stream, const char* expected, bool facingLeft = false)
+	{
+		expect(directions(stream, facingLeft), expected, facingLeft ? (std::string(stream) + " facing left").c_str() : stream);
+	}
+
+	void test_directions()
+	{
+		expect("555236555", "5:236/2 ");
+		expect("22223336", "7:236/7 ");
+		expect("214", "2:214/2 ");
+		expect("623", "2:623/2 ");
+		expect("6323", "3:623/3 "); //rolled through 3
+		expect("62223", "4:623/4 ");
+		expect("41236", "4:236/2 4:41236/4 "); //236 is inside 41236
+		expect("2555536", ""); //neutral breaks 236
+		expect("233333333333336", ""); //longer than the step window
+		expect("6566", "2:66/2 ");
+		expect("6666655555556", "12:66/12 "); //6 held then 7 frames of neutral
+		expect("65555555555556", ""); //12 frames of neutral
+		expect("45444", "2:44/2 ");
+		expect("26874", "4:360/4 ");
+		expect("632147896", "4:214/2 6:360/6 "); //full roll, done on 8
+		expect("1397", ""); //diagonals only
+		expect("19", "");
+		expect("37", "");
+		expect("13971397", "");
+		expect("2139", ""); //2 and diagonals, never 4, 6 or 8
+		expect("2555555555555555555555555555555555555555555558", ""); //360 too slow
+		expect("236236", "2:236/2 4:623/2 5:236/2 ");
+		expect("2366", "2:236/2 ");
+	}
+
+	void test_facing()
+	{
+		expect("236", "2:214/2 ", true);
+		expect("214", "2:236/2 ", true);
+
+		// Each frame is read with the side it was written on: 2, 3 then 4 once crossed up is still forward
+		std::vector<Frame> crossup = directions("23");
+		crossup.push_back({ 4, true });
+		expect(crossup, "2:236/2 ", "23 then 4 facing left");
+	}
+
+	void test_recorded()
+	{
+		// Applied values of the battle input queue, buttons included: 2, 3, 6C
+		const uint16_t fireball[] = { 5, 5, 2, 3, 6 + 64, 5 };
+		std::vector<Frame> frames;
+		for (uint16_t packed : fireball)
+		{
+			frames.push_back({ packed, false });
+		}
+		expect(frames, "4:236/2 ", "2 3 6C");
+
+		// 6, 2, 3D with the opponent switching sides after the 6, the 3 is back now
+		const uint16_t dragonPunch[] = { 5, 6, 2 + 128, 3 + 128, 5 };
+		const bool sides[] = { false, false, true, true, true };
+		frames.clear();
+		for (int i = 0; i < 5; i++)
+		{
+			frames.push_back({ dragonPunch[i], sides[i] });
+		}
+		expect(frames, "", "6 then 2 3D facing left");
+	}
+
+	void bench()
+	{
+		std::mt19937 rng(1);
+		std::vector<uint16_t> stream(1 << 20);
+		for (uint16_t& packed : stream)
+		{
+			packed = (uint16_t)(1 + rng() % 9);
+		}
+
+		MotionRecognizer recognizer;
+		uint32_t sum = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < 10; pass++)
+		{
+			for (uint16_t packed : stream)
+			{
+				sum += recognizer.Step(packed, (pass & 1) != 0);
+			}
+		}
+		const auto end = std::chrono::steady_clock::now();
+		printf("%.1f ns per step (%u)\n", std::chrono::duration<double, std::nano>(end - start).count() / (10.0 * stream.size()), sum);
+	}
+}
+
+int main()
+{
+	test_directions();
+	test_facing();
+	test_recorded();
+	bench();
+	printf("%d failures\n", failures);
+	return failures;
+}
@@ -0,0 +1,491 @@
+/*
+scr_dump: dumps the frame data of every character script extracted to a folder, without the game running.
+
+Build (Linux):
+	g++ -std=c++14 -O2 -pthread -I../../src scr_dump.cpp ../../src/Game/Scr/ScrStateParser.cpp ../../src/Game/Jonb/JonbDBReader.cpp \
+		../../src/Game/Scr/FrameDataDB.cpp ../../src/Game/Scr/ScrTimeline.cpp \
+		../../src/Game/Jonb/JonbBoxDB.cpp -o scr_dump
+
+See docs/scr_dump.md for the expected file names and the output columns.
+*/
+#include "Game/Scr/FrameDataDB.h"
+#include "Game/Scr/ScrStateParser.h"
+#include "Game/Scr/ScrTimeline.h"
+#include "Game/Jonb/JonbBoxDB.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+
+namespace
+{
+	enum class OutputFormat { Csv, Json };
+
+	struct CharacterFiles
+	{
+		std::string abbr;
+		std::string scr_path;
+		std::string ea_path;
+		std::string col_path;
+	};
+
+	struct CharacterDump
+	{
+		std::string text;
+		std::vector<scrState*> states; //only kept when building a frame data database
+		size_t state_count = 0;
+		bool ok = false;
+	};
+
+	bool read_file(const std::string& path, std::vector<char>& out)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+		std::streamsize size = file.tellg();
+		file.seekg(0, std::ios::beg);
+		out.resize(size);
+		return size == 0 || (bool)file.read(out.data(), size);
+	}
+
+	bool file_exists(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return (bool)file;
+	}
+
+	// scr_<abbr>.bin is the character script, scr_<abbr>ea.bin its effects and char_<abbr>_col.pac the jonbin FPAC
+	std::vector<CharacterFiles> find_characters(const std::string& dir, const std::vector<std::string>& only)
+	{
+		std::vector<CharacterFiles> characters;
+		DIR* handle = opendir(dir.c_str());
+		if (handle == nullptr)
+		{
+			return characters;
+		}
+		while (dirent* entry = readdir(handle))
+		{
+			std::string name = entry->d_name;
+			if (name.size() <= 8 || name.compare(0, 4, "scr_") != 0 || name.compare(name.size() - 4, 4, ".bin") != 0)
+			{
+				continue;
+			}
+			std::string abbr = name.substr(4, name.size() - 8);
+			if (abbr.size() > 2 && abbr.compare(abbr.size() - 2, 2, "ea") == 0)
+			{
+				continue;
+			}
+			if (!only.empty() && std::find(only.begin(), only.end(), abbr) == only.end())
+			{
+				continue;
+			}
+			CharacterFiles files;
+			files.abbr = abbr;
+			files.scr_path = dir + "/" + name;
+			files.ea_path = dir + "/scr_" + abbr + "ea.bin";
+			files.col_path = dir + "/char_" + abbr + "_col.pac";
+			characters.push_back(files);
+		}
+		closedir(handle);
+		std::sort(characters.begin(), characters.end(),
+			[](const CharacterFiles& a, const CharacterFiles& b) { return a.abbr < b.abbr; });
+		return characters;
+	}
+
+	std::string join(const std::vector<std::string>& values, const char* separator)
+	{
+		std::string res;
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			if (i)
+			{
+				res += separator;
+			}
+			res += values[i];
+		}
+		return res;
+	}
+
+	std::string json_string(const std::string& value)
+	{
+		std::string res = "\"";
+		for (char c : value)
+		{
+			if (c == '"' || c == '\\')
+			{
+				res += '\\';
+			}
+			if ((unsigned char)c < 0x20)
+			{
+				char buf[8];
+				snprintf(buf, sizeof(buf), "\\u%04x", c);
+				res += buf;
+				continue;
+			}
+			res += c;
+		}
+		return res + "\"";
+	}
+
+	std::string json_string_array(const std::vector<std::string>& values)
+	{
+		std::vector<std::string> quoted;
+		for (auto& value : values)
+		{
+			quoted.push_back(json_string(value));
+		}
+		return "[" + join(quoted, ",") + "]";
+	}
+
+	// Extra columns of the simulated paths, path is -1 when the state was only parsed
+	struct PathInfo
+	{
+		int path = -1;
+		uint32_t branch_mask = 0;
+		int loop_start = -1;
+		std::string next_state;
+	};
+
+	void write_state(std::ostringstream& out, OutputFormat format, const std::string& abbr, const scrState* state,
+		const ScrFrameData& data, const PathInfo& path, bool first)
+	{
+		if (format == OutputFormat::Csv)
+		{
+			out << abbr << ',' << state->name;
+			if (path.path != -1)
+			{
+				out << ',' << path.path << ',' << path.branch_mask << ',' << path.loop_start << ',' << path.next_state;
+			}
+			out << ',' << data.total << ',' << data.startup << ',' << data.active << ','
+				<< data.recovery << ',' << data.invuln_start << ',' << data.invuln_end << ',' << data.non_deterministic << ','
+				<< state->damage << ',' << state->atk_level << ',' << state->hitstun << ',' << state->blockstun << ','
+				<< state->hitstop << ',' << join(state->whiff_cancel, "|") << ',' << join(state->hit_or_block_cancel, "|") << '\n';
+			return;
+		}
+		out << (first ? "\n" : ",\n") << "    {\"name\":" << json_string(state->name);
+		if (path.path != -1)
+		{
+			out << ",\"path\":" << path.path << ",\"branch_mask\":" << path.branch_mask << ",\"loop_start\":" << path.loop_start
+				<< ",\"next_state\":" << json_string(path.next_state);
+		}
+		out << ",\"frames\":" << data.total << ",\"startup\":" << data.startup << ",\"active\":" << data.active
+			<< ",\"recovery\":" << data.recovery << ",\"invuln_start\":" << data.invuln_start << ",\"invuln_end\":" << data.invuln_end
+			<< ",\"non_deterministic\":" << (data.non_deterministic ? "true" : "false")
+			<< ",\"damage\":" << state->damage << ",\"atk_level\":" << state->atk_level << ",\"hitstun\":" << state->hitstun
+			<< ",\"blockstun\":" << state->blockstun << ",\"hitstop\":" << state->hitstop
+			<< ",\"whiff_cancel\":" << json_string_array(state->whiff_cancel)
+			<< ",\"hit_or_block_cancel\":" << json_string_array(state->hit_or_block_cancel) << "}";
+	}
+
+	// Writes every decoded box instead of the states
+	CharacterDump dump_boxes(const CharacterFiles& files, OutputFormat format)
+	{
+		CharacterDump dump;
+		std::vector<char> col_data;
+		if (!read_file(files.col_path, col_data))
+		{
+			std::cerr << files.abbr << ": can't read " << files.col_path << std::endl;
+			return dump;
+		}
+		JonbBoxDB boxes;
+		boxes.AddFpac(col_data.data(), files.abbr == "jb", col_data.data() + col_data.size());
+
+		std::ostringstream out;
+		if (format == OutputFormat::Json)
+		{
+			out << "  {\"character\":" << json_string(files.abbr) << ",\"sprites\":[";
+		}
+		for (uint32_t sprite = 0; sprite < boxes.GetSpriteCount(); sprite++)
+		{
+			const JonbBoxRange& range = boxes.GetBoxes(sprite);
+			if (format == OutputFormat::Json)
+			{
+				out << (sprite ? ",\n" : "\n") << "    {\"name\":" << json_string(boxes.GetSpriteName(sprite)) << ",\"boxes\":[";
+			}
+			for (uint32_t i = range.begin; i < range.end; i++)
+			{
+				const char* type = boxes.GetTypes()[i] == BoxEntryType_Hitbox ? "hitbox" : "hurtbox";
+				if (format == OutputFormat::Csv)
+				{
+					out << files.abbr << ',' << boxes.GetSpriteName(sprite) << ',' << type << ',' << boxes.GetOffsetX()[i] << ','
+						<< boxes.GetOffsetY()[i] << ',' << boxes.GetWidth()[i] << ',' << boxes.GetHeight()[i] << '\n';
+					continue;
+				}
+				out << (i == range.begin ? "" : ",") << "{\"type\":\"" << type << "\",\"x\":" << boxes.GetOffsetX()[i]
+					<< ",\"y\":" << boxes.GetOffsetY()[i] << ",\"w\":" << boxes.GetWidth()[i] << ",\"h\":" << boxes.GetHeight()[i] << "}";
+			}
+			if (format == OutputFormat::Json)
+			{
+				out << "]}";
+			}
+		}
+		if (format == OutputFormat::Json)
+		{
+			out << "\n  ]}";
+		}
+		dump.state_count = boxes.GetBoxCount();
+		dump.text = out.str();
+		dump.ok = true;
+		return dump;
+	}
+
+	CharacterDump dump_character(const CharacterFiles& files, OutputFormat format, bool keep_states, bool simulate)
+	{
+		CharacterDump dump;
+		std::vector<char> scr_data;
+		std::vector<char> ea_data;
+		std::vector<char> col_data;
+		if (!read_file(files.scr_path, scr_data))
+		{
+			std::cerr << files.abbr << ": can't read " << files.scr_path << std::endl;
+			return dump;
+		}
+		ScrScriptView scr = make_scr_script_view(scr_data.data(), scr_data.size());
+		if (scr.index == nullptr)
+		{
+			std::cerr << files.abbr << ": " << files.scr_path << " is not a bbscript file" << std::endl;
+			return dump;
+		}
+		ScrScriptView ea{};
+		if (file_exists(files.ea_path) && read_file(files.ea_path, ea_data))
+		{
+			ea = make_scr_script_view(ea_data.data(), ea_data.size());
+		}
+		JonbBoxDB jonb_index;
+		if (file_exists(files.col_path) && read_file(files.col_path, col_data))
+		{
+			jonb_index.AddFpac(col_data.data(), files.abbr == "jb", col_data.data() + col_data.size());
+		}
+		else
+		{
+			std::cerr << files.abbr << ": no " << files.col_path << ", every frame will be reported as inactive" << std::endl;
+		}
+
+		std::vector<scrState*> states = parse_scr_script(scr, ea, &jonb_index);
+		std::ostringstream out;
+		if (format == OutputFormat::Json)
+		{
+			out << "  {\"character\":" << json_string(files.abbr) << ",\"states\":[";
+		}
+		ScrTimelineSimulator simulator(&jonb_index);
+		bool first = true;
+		for (auto state : states)
+		{
+			if (!simulate)
+			{
+				write_state(out, format, files.abbr, state, summarize_frame_data(state), PathInfo(), first);
+				first = false;
+				continue;
+			}
+			size_t path_count = simulator.Simulate(state->addr, scr.end);
+			for (size_t p = 0; p < path_count; p++)
+			{
+				const ScrTimeline& timeline = simulator.GetTimeline(p);
+				PathInfo path;
+				path.path = (int)p;
+				path.branch_mask = timeline.branch_mask;
+				path.loop_start = timeline.loop_start;
+				if (timeline.next_state)
+				{
+					path.next_state.assign(timeline.next_state, strnlen(timeline.next_state, 32));
+				}
+				ScrFrameData data = summarize_frame_data(timeline.frame_activity_status, timeline.frame_invuln_status);
+				write_state(out, format, files.abbr, state, data, path, first);
+				first = false;
+			}
+		}
+		if (format == OutputFormat::Json)
+		{
+			out << "\n  ]}";
+		}
+		dump.state_count = states.size();
+		dump.text = out.str();
+		dump.ok = true;
+		if (keep_states)
+		{
+			dump.states = states;
+		}
+		else
+		{
+			free_scr_states(states);
+		}
+		return dump;
+	}
+
+	void print_usage()
+	{
+		std::cerr << "usage: scr_dump [-f csv|json] [-j threads] [-o output] [-d framedata.bin] [-s] [-b] <folder> [abbr...]" << std::endl;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	OutputFormat format = OutputFormat::Csv;
+	unsigned int thread_count = std::max(1u, std::thread::hardware_concurrency());
+	std::string output_path;
+	std::string db_path;
+	bool simulate = false;
+	bool boxes = false;
+	std::string folder;
+	std::vector<std::string> only;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "-f" && i + 1 < argc)
+		{
+			std::string value = argv[++i];
+			if (value == "json")
+			{
+				format = OutputFormat::Json;
+			}
+			else if (value != "csv")
+			{
+				print_usage();
+				return 1;
+			}
+		}
+		else if (arg == "-j" && i + 1 < argc)
+		{
+			thread_count = std::max(1, atoi(argv[++i]));
+		}
+		else if (arg == "-o" && i + 1 < argc)
+		{
+			output_path = argv[++i];
+		}
+		else if (arg == "-s")
+		{
+			simulate = true;
+		}
+		else if (arg == "-b")
+		{
+			boxes = true;
+		}
+		else if (arg == "-d" && i + 1 < argc)
+		{
+			db_path = argv[++i];
+		}
+		else if (folder.empty())
+		{
+			folder = arg;
+		}
+		else
+		{
+			only.push_back(arg);
+		}
+	}
+	if (folder.empty())
+	{
+		print_usage();
+		return 1;
+	}
+
+	std::vector<CharacterFiles> characters = find_characters(folder, only);
+	if (characters.empty())
+	{
+		std::cerr << "no scr_<abbr>.bin files found in " << folder << std::endl;
+		return 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<CharacterDump> dumps(characters.size());
+	std::atomic<size_t> next_character(0);
+	std::vector<std::thread> workers;
+	thread_count = std::min<unsigned int>(thread_count, characters.size());
+	for (unsigned int t = 0; t < thread_count; t++)
+	{
+		workers.emplace_back([&]() {
+			for (size_t i = next_character++; i < characters.size(); i = next_character++)
+			{
+				dumps[i] = boxes ? dump_boxes(characters[i], format)
+					: dump_character(characters[i], format, !db_path.empty(), simulate);
+			}
+		});
+	}
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	std::ofstream output_file;
+	if (!output_path.empty())
+	{
+		output_file.open(output_path, std::ios::binary);
+		if (!output_file)
+		{
+			std::cerr << "can't open " << output_path << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& out = output_path.empty() ? std::cout : output_file;
+
+	size_t state_count = 0;
+	size_t failed = 0;
+	bool first = true;
+	if (format == OutputFormat::Csv && boxes)
+	{
+		out << "character,sprite,type,x,y,w,h\n";
+	}
+	else if (format == OutputFormat::Csv)
+	{
+		out << (simulate ? "character,state,path,branch_mask,loop_start,next_state," : "character,state,") << "frames,startup,active,recovery,invuln_start,invuln_end,non_deterministic,"
+			"damage,atk_level,hitstun,blockstun,hitstop,whiff_cancel,hit_or_block_cancel\n";
+	}
+	else
+	{
+		out << "[\n";
+	}
+	for (auto& dump : dumps)
+	{
+		if (!dump.ok)
+		{
+			failed++;
+			continue;
+		}
+		if (format == OutputFormat::Json && !first)
+		{
+			out << ",\n";
+		}
+		out << dump.text;
+		state_count += dump.state_count;
+		first = false;
+	}
+	if (format == OutputFormat::Json)
+	{
+		out << "\n]\n";
+	}
+
+	if (!db_path.empty() && !boxes)
+	{
+		FrameDataDBBuilder builder;
+		for (size_t i = 0; i < dumps.size(); i++)
+		{
+			if (dumps[i].ok)
+			{
+				builder.AddCharacter(characters[i].abbr, dumps[i].states);
+				free_scr_states(dumps[i].states);
+			}
+		}
+		if (!builder.Write(db_path.c_str()))
+		{
+			std::cerr << "can't write " << db_path << std::endl;
+			return 1;
+		}
+	}
+
+	std::cerr << "parsed " << state_count << (boxes ? " boxes of " : " states of ") << characters.size() - failed << " characters in "
+		<< elapsed.count() / 1000.0 << "ms using " << thread_count << " threads" << std::endl;
+	return failed ? 2 : 0;
+}
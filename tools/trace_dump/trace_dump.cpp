@@ -0,0 +1,215 @@
+/*
+trace_dump: prints the frames of a hitbox trace recorded from the main window, the .bbtr files in BBCF_IM/traces.
+
+Build (Linux):
+	g++ -std=c++14 -O2 -I../../src trace_dump.cpp ../../src/Game/Trace/TraceFormat.cpp ../../src/Game/Trace/TraceReader.cpp -o trace_dump
+
+See docs/trace_dump.md for the options and the output columns.
+*/
+#include "Game/Trace/TraceReader.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+	enum class OutputFormat { Csv, Json };
+
+	std::string json_string(const char* value)
+	{
+		std::string res = "\"";
+		for (const char* c = value; *c; c++)
+		{
+			if (*c == '"' || *c == '\\')
+			{
+				res += '\\';
+			}
+			res += *c;
+		}
+		return res + "\"";
+	}
+
+	void write_index(std::ostream& out, const TraceReader& reader)
+	{
+		out << "block,min_frame,max_frame,frames,offset,size\n";
+		for (size_t i = 0; i < reader.GetBlockCount(); i++)
+		{
+			const TraceIndexEntry& entry = reader.GetBlock(i);
+			out << i << ',' << entry.min_frame << ',' << entry.max_frame << ',' << entry.frame_count << ','
+				<< entry.offset << ',' << entry.size << '\n';
+		}
+	}
+
+	// One row per box, entities without boxes get a single row with an empty box
+	void write_csv(std::ostream& out, const std::vector<TraceFrame>& frames)
+	{
+		out << "frame,slot,flags,pos_x,pos_y,scale_x,scale_y,rotation,action,box,type,x,y,w,h\n";
+		for (auto& frame : frames)
+		{
+			for (auto& entity : frame.entities)
+			{
+				for (uint32_t i = 0; i == 0 || i < entity.box_count; i++)
+				{
+					out << frame.frame << ',' << entity.slot << ',' << (int)entity.flags << ',' << entity.pos_x << ','
+						<< entity.pos_y << ',' << entity.scale_x << ',' << entity.scale_y << ',' << entity.rotation << ','
+						<< entity.action << ',';
+					if (i < entity.box_count)
+					{
+						const TraceBox& box = frame.boxes[entity.first_box + i];
+						out << i << ',' << (box.type ? "hitbox" : "hurtbox") << ',' << box.x << ',' << box.y << ','
+							<< box.w << ',' << box.h << '\n';
+					}
+					else
+					{
+						out << ",,,,,\n";
+					}
+				}
+			}
+		}
+	}
+
+	void write_json(std::ostream& out, const std::vector<TraceFrame>& frames)
+	{
+		out << "[";
+		for (size_t f = 0; f < frames.size(); f++)
+		{
+			const TraceFrame& frame = frames[f];
+			out << (f ? ",\n" : "\n") << "  {\"frame\":" << frame.frame << ",\"entities\":[";
+			for (size_t e = 0; e < frame.entities.size(); e++)
+			{
+				const TraceEntity& entity = frame.entities[e];
+				out << (e ? "," : "") << "\n    {\"slot\":" << entity.slot << ",\"flags\":" << (int)entity.flags
+					<< ",\"pos_x\":" << entity.pos_x << ",\"pos_y\":" << entity.pos_y
+					<< ",\"scale_x\":" << entity.scale_x << ",\"scale_y\":" << entity.scale_y
+					<< ",\"rotation\":" << entity.rotation << ",\"action\":" << json_string(entity.action) << ",\"boxes\":[";
+				for (uint32_t i = 0; i < entity.box_count; i++)
+				{
+					const TraceBox& box = frame.boxes[entity.first_box + i];
+					out << (i ? "," : "") << "{\"type\":\"" << (box.type ? "hitbox" : "hurtbox") << "\",\"x\":" << box.x
+						<< ",\"y\":" << box.y << ",\"w\":" << box.w << ",\"h\":" << box.h << "}";
+				}
+				out << "]}";
+			}
+			out << "]}";
+		}
+		out << "\n]\n";
+	}
+
+	void print_usage()
+	{
+		std::cerr << "usage: trace_dump [-f csv|json] [-o output] [--from frame] [--to frame] [-i] <trace.bbtr>" << std::endl;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	OutputFormat format = OutputFormat::Csv;
+	std::string output_path;
+	std::string trace_path;
+	uint32_t first = 0;
+	uint32_t last = std::numeric_limits<uint32_t>::max();
+	bool index_only = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "-f" && i + 1 < argc)
+		{
+			std::string value = argv[++i];
+			if (value == "json")
+			{
+				format = OutputFormat::Json;
+			}
+			else if (value != "csv")
+			{
+				print_usage();
+				return 1;
+			}
+		}
+		else if (arg == "-o" && i + 1 < argc)
+		{
+			output_path = argv[++i];
+		}
+		else if (arg == "--from" && i + 1 < argc)
+		{
+			first = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (arg == "--to" && i + 1 < argc)
+		{
+			last = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (arg == "-i")
+		{
+			index_only = true;
+		}
+		else if (trace_path.empty())
+		{
+			trace_path = arg;
+		}
+		else
+		{
+			print_usage();
+			return 1;
+		}
+	}
+	if (trace_path.empty())
+	{
+		print_usage();
+		return 1;
+	}
+
+	TraceReader reader;
+	if (!reader.Open(trace_path))
+	{
+		std::cerr << trace_path << ": " << reader.GetError() << std::endl;
+		return 1;
+	}
+	if (!reader.HasFooter())
+	{
+		std::cerr << "the trace has no index (recording wasn't stopped), action names are missing" << std::endl;
+	}
+
+	std::ofstream output_file;
+	if (!output_path.empty())
+	{
+		output_file.open(output_path, std::ios::binary);
+		if (!output_file)
+		{
+			std::cerr << "can't open " << output_path << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& out = output_path.empty() ? std::cout : output_file;
+
+	if (index_only)
+	{
+		write_index(out, reader);
+		return 0;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<TraceFrame> frames;
+	bool ok = reader.ReadFrames(first, last, frames);
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	if (!ok)
+	{
+		std::cerr << trace_path << ": " << reader.GetError() << std::endl;
+	}
+
+	if (format == OutputFormat::Csv)
+	{
+		write_csv(out, frames);
+	}
+	else
+	{
+		write_json(out, frames);
+	}
+	std::cerr << "decoded " << frames.size() << " of " << reader.GetFrameCount() << " frames in "
+		<< elapsed.count() / 1000.0 << " ms" << std::endl;
+	return ok ? 0 : 1;
+}